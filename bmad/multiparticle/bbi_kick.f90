@@ -8,6 +8,9 @@
 !
 ! Note: This routine can be used to compute the beam-ion kick as well.
 !
+! Note: Most of the time here is spent evaluating the Faddeeva function. If a relative error
+! of ~1e-10 is acceptable, faddeeva_table_setup can be used to switch to a faster table lookup.
+!
 ! Input:
 !   x         -- real(rp): X coordinate.
 !   y         -- real(rp): Y coordinate.
@@ -18,7 +21,7 @@
 !                In terms of the the actual kick:
 !                nk = [kick_x / (xi_x * sigma_x / beta_x), kick_y / (xi_y * sigma_y / beta_y)
 !                nk = -4 * pi * [x/sigma_x, y/sigma_y] in the linear region
-!   dnk(2,2)  -- real(rp): derivatives of nk. EG: dnk(2,1) = dnk(2)/dy
+!   dnk(2,2)  -- real(rp): derivatives of nk. EG: dnk(2,1) = dnk(2)/dx
 !
 ! Note:
 !   xi_x = beta_x * bbi_const / sig_x     ! Horizontal tune shift parameter
@@ -63,7 +66,7 @@ use sign_of_mod
 implicit none
 
 real(rp) x, y, x_norm, y_norm, r, nk(2), dnk(2,2), u, v, amp, denom, f(2), arg
-real(rp) w1(2), w2(2), dw1(2,2), dw2(2,2), expon, scale, sigma(2), sx, sy, sig(2)
+real(rp) w1(2), w2(2), dw1(2,2), dw2(2,2), expon, scale, sigma(2), sx, sy, sig(2), d_scale
 real(rp) :: emax = 30
 logical flipped
 
@@ -74,18 +77,22 @@ x_norm = x / sigma(1)
 y_norm = y / sigma(2)
 
 if (r > 0.999 .and. r < 1.001) then ! round beam
+  ! nk = -[x_norm, y_norm] * scale(amp). d_scale = d(scale)/d(amp).
   amp = (x_norm**2 + y_norm**2) / 2
   if (amp > emax) then
     scale = 4 * pi / amp
+    d_scale = -scale / amp
   else if (amp < 1d-4) then
     scale = 4 * pi
+    d_scale = -2 * pi
   else
     scale = 4 * pi * ((1 - exp(-amp)) / amp) 
+    d_scale = (4 * pi * exp(-amp) - scale) / amp
   endif
 
   nk = -[x_norm, y_norm] * scale
-  dnk(1,:) = [-scale, 0.0_rp]
-  dnk(2,:) = [0.0_rp, -scale]
+  dnk(1,:) = -[scale + x_norm**2 * d_scale, x_norm * y_norm * d_scale] / sigma
+  dnk(2,:) = -[x_norm * y_norm * d_scale, scale + y_norm**2 * d_scale] / sigma
   return
 endif
 
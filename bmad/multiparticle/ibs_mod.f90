@@ -1,7 +1,7 @@
 module ibs_mod
 
 use mode3_mod
-use ibs_rates_mod, only: ibs_struct, bane1, mpxx1, mpzt1, cimp1, bjmt1
+use ibs_rates_mod, only: ibs_struct, bane1, mpxx1, mpzt1, cimp1, bjmt1, ibs_rates_calc, ibs_optics_calc, ibs_n_optics$
 use twiss_and_track_mod
 use longitudinal_profile_mod
 use fgsl
@@ -17,6 +17,7 @@ type ibs_sim_param_struct
                            ! bunch length is proportional to energy spread.
   real(rp) :: inductance = 0.0d0      ! Inductive part of impedance for pwd calc.  
   character(4) :: formula = 'bjmt'     ! Which IBS formulation to use.  See subroutine ibs1 for a list.
+  logical :: fixed_quadrature = .false. ! True: use ibs_rates_calc (C++ fixed quadrature) instead of the GSL integration.
   !real(rp) :: fake_3HC = -1   ! If greater than zero, divide growth rates by this factor.
 end type
 
@@ -581,6 +582,9 @@ end subroutine ibs_blowup1turn
 !    mpxx - Modified Piwinski with a constant Coulomb log.
 !    kubo - Kubo and Oide's sigma matrix-based
 !
+! If ibs_sim_params%fixed_quadrature is set, the rates are computed by ibs_rates_calc instead of the
+! GSL routines bjmt1, bane1, etc.
+!
 ! Either i or s, but not both, must be specified.
 !
 ! Input:
@@ -609,8 +613,9 @@ real(rp), intent(in), OPTIONAL :: s
 
 type(ele_struct), pointer :: ele
 type(ele_struct), target :: stubele
+type(ibs_struct) rates1(1)
 real(rp) coulomb_log
-real(rp) n_part
+real(rp) n_part, optics(ibs_n_optics$,1)
 
 n_part = lat%param%n_part
 
@@ -638,7 +643,11 @@ endif
 
 call multi_coulomb_log(ibs_sim_params, ele, coulomb_log, n_part)
 
-if(ibs_sim_params%formula == 'cimp') then
+if(ibs_sim_params%fixed_quadrature) then
+  call ibs_optics_calc(ele, optics(:,1))
+  call ibs_rates_calc(ibs_sim_params%formula, optics, [coulomb_log], n_part, rates1)
+  rates = rates1(1)
+elseif(ibs_sim_params%formula == 'cimp') then
   call cimp1(ele, coulomb_log, rates, n_part)
 elseif(ibs_sim_params%formula == 'bjmt') then
   call bjmt1(ele, coulomb_log, rates, n_part)
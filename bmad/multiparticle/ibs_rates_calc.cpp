@@ -0,0 +1,322 @@
+//+
+// IBS rate calc. See ibs_rates_calc.h.
+//-
+
+#include <cmath>
+#include <iostream>
+#include "ibs_rates_calc.h"
+
+#ifdef _OPENMP
+#define OMP_PRAGMA(directive) _Pragma(#directive)
+#else
+#define OMP_PRAGMA(directive)
+#endif
+
+using namespace std;
+
+static_assert(sizeof(Ibs_optics) == 15 * sizeof(double), "Ibs_optics must match the Fortran optics array");
+
+//--------------------------------------------------------------------
+// Composite 15 point Gauss-Kronrod rule on n_panel equal panels spanning [t0, t1].
+
+Ibs_rates_calc::Quadrature::Quadrature(double t0, double t1, int n_panel) {
+  static const double xgk[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000};
+  static const double wgk[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+
+  double h = (t1 - t0) / n_panel;
+  for (int ip = 0; ip < n_panel; ip++) {
+    double tc = t0 + (ip + 0.5) * h;
+    for (int k = 0; k < 15; k++) {
+      int j = (k < 8) ? k : 14 - k;
+      double s = (k < 7) ? -1 : 1;
+      t.push_back(tc + s * xgk[j] * h / 2);
+      w.push_back(wgk[j] * h / 2);
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+// Integration ranges:
+//   bjmt:  lambda = exp(t), t in [0, 100]. Same as bjmt1.
+//   bane:  x = exp(t) over [0, Infinity) -> t in [-40, 40].
+//   mpxx, mpzt: The integrands have features at both ends of [0, 1] so [0, 1/2] is done with x = exp(t)
+//               and [1/2, 1] with 1 - x = exp(t), t in [-40, log(1/2)].
+
+Ibs_rates_calc::Ibs_rates_calc() :
+  quad_bjmt(0, 100, 50),
+  quad_inf(-40, 40, 80),
+  quad_unit(-40, log(0.5), 40)
+  {}
+
+//--------------------------------------------------------------------
+
+Ibs_rates Ibs_rates_calc::rates1(int formula, const Ibs_optics& op, double coulomb_log, double n_part) const {
+  const double pi = 3.14159265358979323846264338327950288419716939937510582;
+  const double c_light = 2.99792458e8;
+  Ibs_rates rates;
+
+  double gamma = op.gamma, rbeta = op.rbeta;
+  double sigma_p = op.sigma_p, sigma_z = op.sigma_z;
+  double emit_a = op.emit_a, emit_b = op.emit_b;
+  double beta_a = op.beta_a, beta_b = op.beta_b;
+  double alpha_a = op.alpha_a, alpha_b = op.alpha_b;
+  double Da = op.eta_a, Db = op.eta_b, Dap = op.etap_a, Dbp = op.etap_b;
+
+  double classical_radius = op.classical_radius;
+  double r2 = classical_radius * classical_radius;
+
+  double Ha = (Da * Da + (beta_a * Dap + alpha_a * Da) * (beta_a * Dap + alpha_a * Da)) / beta_a;
+  double Hb = (Db * Db + (beta_b * Dbp + alpha_b * Db) * (beta_b * Dbp + alpha_b * Db)) / beta_b;
+  double sigma_H = 1 / sqrt(1 / (sigma_p * sigma_p) + Ha / emit_a + Hb / emit_b);
+  double a = sigma_H / gamma * sqrt(beta_a / emit_a);
+  double b = sigma_H / gamma * sqrt(beta_b / emit_b);
+
+  double big_A = r2 * c_light * n_part / 64.0 / (pi * pi) / (rbeta * rbeta * rbeta) /
+                 pow(gamma, 4) / emit_a / emit_b / sigma_z / sigma_p;
+
+  switch (formula) {
+
+  // Bjorken-Mtingwa. See bjmt1.
+
+  case BJMT: {
+    double phi_h = Dap + alpha_a * Da / beta_a;
+    double phi_v = Dbp + alpha_b * Db / beta_b;
+    double g2 = gamma * gamma;
+
+    // Lp, Lh, Lv only have entries in the upper 2x2 (Lh), (2,2) (Lp) and lower 2x2 (Lv) blocks.
+
+    double lp22 = g2 / (sigma_p * sigma_p);
+    double fh = beta_a / emit_a, fv = beta_b / emit_b;
+    double lh11 = fh, lh12 = -fh * gamma * phi_h, lh22 = fh * g2 * Ha / beta_a;
+    double lv22 = fv * g2 * Hb / beta_b, lv23 = -fv * gamma * phi_v, lv33 = fv;
+
+    double L11 = lh11, L12 = lh12, L22 = lp22 + lh22 + lv22, L23 = lv23, L33 = lv33;
+    double tr_p = lp22, tr_h = lh11 + lh22, tr_v = lv22 + lv33;
+
+    const vector<double>& t = quad_bjmt.t;
+    const vector<double>& w = quad_bjmt.w;
+    int n = t.size();
+    double sum_p = 0, sum_h = 0, sum_v = 0;
+
+    OMP_PRAGMA(omp simd reduction(+:sum_p,sum_h,sum_v))
+    for (int k = 0; k < n; k++) {
+      double x = exp(t[k]);
+      double a1 = L11 + x, a2 = L22 + x, a3 = L33 + x;
+      double det = a1 * (a2 * a3 - L23 * L23) - L12 * L12 * a3;
+
+      // Inverse of (L + x I) times det. L is symmetric.
+      double i11 = a2 * a3 - L23 * L23, i12 = -L12 * a3;
+      double i22 = a1 * a3, i23 = -a1 * L23, i33 = a1 * a2 - L12 * L12;
+      double tr_im = (i11 + i22 + i33) / det;
+
+      double tr_p_im = lp22 * i22 / det;
+      double tr_h_im = (lh11 * i11 + 2 * lh12 * i12 + lh22 * i22) / det;
+      double tr_v_im = (lv22 * i22 + 2 * lv23 * i23 + lv33 * i33) / det;
+
+      double f = w[k] * sqrt(x / det) * x;
+      sum_p += f * (tr_p * tr_im - 3 * tr_p_im);
+      sum_h += f * (tr_h * tr_im - 3 * tr_h_im);
+      sum_v += f * (tr_v * tr_im - 3 * tr_v_im);
+    }
+
+    double c = 4 * pi * big_A * coulomb_log;
+    rates.inv_Tz = c * sum_p;
+    rates.inv_Ta = c * sum_h;
+    rates.inv_Tb = c * sum_v;
+    break;
+  }
+
+  // High energy approximation of Bjorken-Mtingwa. See bane1.
+
+  case BANE: {
+    double big_A_bane = r2 * c_light * n_part / 16.0 / (gamma * gamma * gamma) / 
+                  pow(emit_a, 0.75) / pow(emit_b, 0.75) / sigma_z / (sigma_p * sigma_p * sigma_p);
+    double alpha = a / b;
+    const vector<double>& t = quad_inf.t;
+    const vector<double>& w = quad_inf.w;
+    int n = t.size();
+    double sum = 0;
+
+    OMP_PRAGMA(omp simd reduction(+:sum))
+    for (int k = 0; k < n; k++) {
+      double x = exp(t[k]);
+      sum += w[k] * x / (sqrt(1 + x * x) * sqrt(alpha * alpha + x * x));
+    }
+
+    double g_bane = 2 * sqrt(alpha) / pi * sum;
+    rates.inv_Tz = big_A_bane * coulomb_log * sigma_H * g_bane * pow(beta_a * beta_b, -0.25);
+    rates.inv_Ta = sigma_p * sigma_p * Ha / emit_a * rates.inv_Tz;
+    rates.inv_Tb = sigma_p * sigma_p * Hb / emit_b * rates.inv_Tz;
+    break;
+  }
+
+  // Modified Piwinski. See mpxx1 and mpzt1.
+
+  case MPXX: case MPZT: {
+    double args[3][3] = {{a, b, 0}, {1 / a, b / a, 0}, {1 / b, a / b, 0}};
+    if (formula == MPZT) {
+      double sigma_b = sqrt(beta_b * emit_b + Db * Db * sigma_p * sigma_p);
+      double q = sigma_H * rbeta * sqrt(2 * sigma_b / classical_radius);
+      args[0][2] = q;  args[1][2] = q / a;  args[2][2] = q / b;
+    }
+
+    const vector<double>& t = quad_unit.t;
+    const vector<double>& w = quad_unit.w;
+    int n = t.size();
+    double f[3];
+    bool zotter = (formula == MPZT);
+
+    for (int i = 0; i < 3; i++) {
+      double av = args[i][0], bv = args[i][1], qv = args[i][2];
+      double sum = 0;
+
+      // In terms of y = 1 - x^2: P = sqrt(a^2 + (1 - a^2) x^2) = sqrt(1 + (a^2 - 1) y), 1 - 3 x^2 = 3 y - 2.
+
+      OMP_PRAGMA(omp simd reduction(+:sum))
+      for (int k = 0; k < 2*n; k++) {
+        double e = exp(t[k % n]);
+        double y = (k < n) ? 1 - e * e : e * (2 - e);
+        double P = sqrt(1 + (av * av - 1) * y);
+        double Q = sqrt(1 + (bv * bv - 1) * y);
+        double g = 8 * pi * (3 * y - 2) / P / Q;
+        if (zotter) g *= 2 * log(qv / 2 * (1 / P + 1 / Q)) - 0.577215665;
+        sum += w[k % n] * e * g;
+      }
+      f[i] = sum;
+    }
+
+    double cl = (formula == MPXX) ? coulomb_log : 1;
+    rates.inv_Tz = cl * big_A * sigma_H * sigma_H / (sigma_p * sigma_p) * f[0];
+    rates.inv_Ta = cl * big_A * (f[1] + Ha * sigma_H * sigma_H / emit_a * f[0]);
+    rates.inv_Tb = cl * big_A * (f[2] + Hb * sigma_H * sigma_H / emit_b * f[0]);
+    break;
+  }
+
+  // Completely integrated modified Piwinski. See cimp1.
+
+  case CIMP: {
+    double g_ba = ibs_cimp_g(b / a);
+    double g_ab = ibs_cimp_g(a / b);
+    double c = 2 * pow(pi, 1.5) * big_A * coulomb_log;
+    rates.inv_Tz = c * sigma_H * sigma_H / (sigma_p * sigma_p) * (g_ba / a + g_ab / b);
+    rates.inv_Ta = c * (-a * g_ba + Ha * sigma_H * sigma_H / emit_a * (g_ba / a + g_ab / b));
+    rates.inv_Tb = c * (-b * g_ab + Hb * sigma_H * sigma_H / emit_b * (g_ba / a + g_ab / b));
+    break;
+  }
+
+  default:
+    cerr << "ERROR IN IBS_RATES_CALC: INVALID IBS FORMULA: " << formula << endl;
+  }
+
+  return rates;
+}
+
+//--------------------------------------------------------------------
+
+int Ibs_rates_calc::rates(int formula, long n, const Ibs_optics* op, const double* coulomb_log, double n_part, Ibs_rates* r) const {
+  int n_out_of_range = 0;
+
+  OMP_PRAGMA(omp parallel for schedule(dynamic, 8) reduction(+:n_out_of_range))
+  for (long i = 0; i < n; i++) {
+    r[i] = rates1(formula, op[i], coulomb_log[i], n_part);
+
+    if (formula == CIMP) {
+      double b_over_a = sqrt(op[i].beta_b * op[i].emit_a / (op[i].beta_a * op[i].emit_b));
+      if (!ibs_cimp_in_range(b_over_a) || !ibs_cimp_in_range(1 / b_over_a)) n_out_of_range++;
+    }
+  }
+
+  return n_out_of_range;
+}
+
+//--------------------------------------------------------------------
+// Interface for ibs_rates_mod.f90. optics(ibs_n_optics$, n) and rates(3, n) with rates(:,i) = [inv_Ta, inv_Tb, inv_Tz].
+
+extern "C" void ibs_rates_calc_c(int formula, long n, const double* optics, const double* coulomb_log,
+                                 double n_part, double* rates) {
+  static const Ibs_rates_calc calc;
+  vector<Ibs_rates> r(n);
+  int n_out_of_range = calc.rates(formula, n, (const Ibs_optics*)optics, coulomb_log, n_part, &r[0]);
+
+  for (long i = 0; i < n; i++) {
+    rates[3*i] = r[i].inv_Ta;
+    rates[3*i+1] = r[i].inv_Tb;
+    rates[3*i+2] = r[i].inv_Tz;
+  }
+
+  if (n_out_of_range > 0) {
+    cerr << "CRITICAL WARNING: interpolation range exceeded for " << n_out_of_range << " points" << endl;
+  }
+}
+
+//--------------------------------------------------------------------
+// 13 degree piecewise polynomial fit to the CIMP integral. See function g in cimp1.
+
+double ibs_cimp_g(double u) {
+  static const double o[14] = {0.27537408880308967,-0.0014411559647655005,4.760237316963749E-6,-1.056200254057877E-8,
+       1.652957676252096E-11,-1.8807607644579788E-14,1.582497859744359E-17,-9.911417850544026E-21,
+       4.606212267581107E-24,-1.5661683056801226E-27,3.7836532348260456E-31,-6.148053455724941E-35,
+       6.021954146486214E-39,-2.6856345839264216E-43};   // Last two have the 1E-10 factor applied
+  static const double p[14] = {1.3728514796955633,-0.06329159139596323,0.0019843996282577487,-0.00004282113130209425,
+       6.588299268041797E-7,-7.411644739022654E-9,6.186473337975396E-11,-3.851874112809632E-13,
+       1.7820926145729545E-15,-6.038143148108221E-18,1.454670683108795E-20,-2.358356775328005E-23,
+       2.305700018891372E-26,-1.026694954987225E-29};
+  static const double pa[14] = {2.4560269972177395,-0.34483385959575796,0.04060452194930618,-0.0036548931452558006,
+       0.00024651396218017436,-0.000012205596049761074,4.224156486889531E-7,-8.746709793365587E-9,
+       2.0010958003696878E-11,5.293109492480939E-12,-1.8692549451553078E-13,3.313011636321362E-15,
+       -3.191257818162888E-17,1.333629848206322E-19};
+  static const double pb[14] = {0.2509305915339517, 3.655027986910339, -3.538178517122364, 2.0378515154003622,
+       -0.8131215410970869, 0.23600479506508648, -0.0508941392205539, 0.008214142113823073,
+       -0.000988882504551898, 0.00008751565040446301, -5.526659141312207E-6,
+       2.3564088895171855E-7, -6.0770418816204626E-9, 7.15762060347684E-11};
+  static const double qb[14] = {-4.5128859976303835, 44.038623289844345, -201.50265131380843, 685.7422921643122,
+       -1733.9460775721304, 3272.7093350374225, -4637.724347309373, 4940.122242846527,
+       -3931.6350463124686, 2301.047404938234, -960.7211908043258, 270.6618330819612,
+       -46.088423620894815, 3.581345541476106};
+  static const double qa[14] = {-7.9542527228302164, 207.51519155414007, -4406.431743148087, 75592.0699189963,
+       -992747.0161009694, 9.983494244578896E6, -7.72264540055081E7, 4.593887542691004E8,
+       -2.0856924957059484E9, 7.103526742990105E9, -1.758262228582309E10, 2.9881056304916122E10,
+       -3.11970246734184E10, 1.5092353688380434E10};
+  static const double q[14] = {-10.427660034546474, 614.5741414073021, -37752.0301748355, 1.8467024380709291E6,
+       -6.787056202900247E7, 1.87800146779508E9, -3.9344782189063065E10, 6.245185690585099E11,
+       -7.460242970344108E12, 6.596837840619067E13, -4.186282233147678E14, 1.8023052362000775E15,
+       -4.713009373619726E15, 5.649407049035322E15};
+  static const double ra[14] = {-13.151132987122772, 2076.0767607226853, -439312.2888781302, 7.549171067948443E7,
+       -9.918579267112797E9, 9.97612075477821E11, -7.717556597617397E13, 4.591087739048907E15,
+       -2.0844941927298595E17, 7.099636713666537E18, -1.757338267407412E20, 2.986592440773308E21,
+       -3.1181759869417024E22, 1.5085206738847978E23};
+  static const double rb[14] = {-16.158250737444753, 7653.567961683397, -5.677248220833501E6, 3.2736621037820387E9,
+       -1.3885723919300298E12, 4.356123741560311E14, -1.018979723977809E17, 1.782083486703034E19,
+       -2.31837909173977E21, 2.209799968074478E23, -1.4978388984105023E25, 6.831861840241021E26,
+       -1.878873461985899E28, 2.3529610201488045E29};
+  static const double r[14] = {-21.460085854969584, 80412.06002488811, -6.294777676054858E8, 3.84371292991909E12,
+       -1.7311478313121348E16, 5.7791722579515556E19, -1.4411700564165495E23, +2.6910329100895636E26,
+       -3.742607580627404E29, 3.8178627111416235E32, -2.7722017774216816E35, 1.3556698189607729E38,
+       -4.000249119089512E40, 5.378513442816346E42};   // Last two have the 1E10 factor applied
+
+  if (!ibs_cimp_in_range(u)) return 0;
+
+  const double* c;
+  if (u > 300)         c = o;
+  else if (u > 30)     c = p;
+  else if (u > 10)     c = pa;
+  else if (u > 1.6)    c = pb;
+  else if (u > 0.2)    c = qb;
+  else if (u > 0.1)    c = qa;
+  else if (u > 0.02)   c = q;
+  else if (u > 0.01)   c = ra;
+  else if (u > 0.001)  c = rb;
+  else                 c = r;
+
+  double g = c[13];
+  for (int i = 12; i >= 0; i--) g = g * u + c[i];
+  return g;
+}
@@ -0,0 +1,64 @@
+//+
+// Intrabeam scattering (IBS) rate calc used by the C++ Ibs_engine, and by ibs1 of ibs_mod.f90
+// when ibs_sim_params%fixed_quadrature is set. By default ibs_mod uses the GSL routines.
+//
+// This implements the bjmt, bane, mpxx, mpzt and cimp formulas of ibs_rates_mod.f90 (bjmt1, bane1, etc).
+// The GSL routines of ibs_rates_mod integrate one element at a time with an adaptive integrator which
+// calls back into Fortran for every quadrature node. Here, all integrals are done with a fixed composite
+// 15 point Gauss-Kronrod rule over a logarithmic change of variables so that the nodes are the same
+// for every element. The integrands are evaluated over all the nodes of an element in vectorizable
+// loops and elements are done in parallel.
+//-
+
+#ifndef IBS_RATES_CALC
+
+#include <vector>
+
+struct Ibs_rates {       // Betatron growth rates. Same as ibs_struct.
+  double inv_Ta;
+  double inv_Tb;
+  double inv_Tz;
+  Ibs_rates() : inv_Ta(0), inv_Tb(0), inv_Tz(0) {}
+};
+
+// Beam parameters at a point. The layout matches the optics(ibs_n_optics$) array of ibs_rates_mod.f90.
+
+struct Ibs_optics {
+  double gamma, rbeta;          // Relativistic gamma and beta.
+  double classical_radius;      // Particle classical radius.
+  double sigma_p, sigma_z;      // Energy spread and bunch length.
+  double emit_a, emit_b;        // Mode emittances.
+  double beta_a, beta_b;        // Twiss.
+  double alpha_a, alpha_b;
+  double eta_a, eta_b;          // Mode dispersion.
+  double etap_a, etap_b;
+};
+
+class Ibs_rates_calc {
+public:
+  enum Formula {BJMT = 1, BANE, MPXX, MPZT, CIMP};
+
+  Ibs_rates_calc();
+
+  // Rates at a single point using formula BJMT, etc. n_part is the number of particles in the bunch.
+  Ibs_rates rates1(int formula, const Ibs_optics& op, double coulomb_log, double n_part) const;
+
+  // Rates for n points in parallel. Returns the number of points outside of the
+  // range of the CIMP g(u) interpolation (always 0 for other formulas).
+  int rates(int formula, long n, const Ibs_optics* op, const double* coulomb_log, double n_part, Ibs_rates* r) const;
+
+private:
+  struct Quadrature {
+    std::vector<double> t, w;       // Nodes and weights in the integration variable.
+    Quadrature(double t0, double t1, int n_panel);
+  };
+
+  Quadrature quad_bjmt, quad_inf, quad_unit;
+};
+
+// CIMP g(u) interpolation. Valid for u in [1e-4, 3000]. Outside of this range g = 0 is returned.
+double ibs_cimp_g(double u);
+inline bool ibs_cimp_in_range(double u) {return u >= 0.0001 && u <= 3000;}
+
+#define IBS_RATES_CALC
+#endif
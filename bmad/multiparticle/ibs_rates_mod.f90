@@ -1,3 +1,12 @@
+!+
+! IBS rate formulas.
+!
+! bjmt1, bane1, mpxx1, mpzt1 and cimp1 compute the rates for one element using GSL integration.
+! These are what ibs_mod uses by default.
+! ibs_rates_calc computes the same formulas for many points at once in C++ (ibs_rates_calc.cpp).
+! It is used by the C++ Ibs_engine, and by ibs1 when ibs_sim_params%fixed_quadrature is set.
+!-
+
 module ibs_rates_mod
 
 use bmad_routine_interface
@@ -14,8 +23,105 @@ end type
 real(fgsl_double), parameter :: eps7 = 1.0d-7
 integer(fgsl_size_t), parameter :: limit = 1000_fgsl_size_t
 
+! Size of the optics array used by ibs_rates_calc. See ibs_optics_calc.
+
+integer, parameter :: ibs_n_optics$ = 15
+
+interface
+  subroutine ibs_rates_calc_c (formula, n, optics, coulomb_log, n_part, rates) bind(c)
+    import c_int, c_long, c_double
+    integer(c_int), value :: formula
+    integer(c_long), value :: n
+    real(c_double) optics(*), coulomb_log(*), rates(*)
+    real(c_double), value :: n_part
+  end subroutine
+end interface
+
 contains
 
+!-------------------------------------------------------------------------------------------------------------------
+!-------------------------------------------------------------------------------------------------------------------
+!-------------------------------------------------------------------------------------------------------------------
+!+
+!  subroutine ibs_optics_calc(ele, optics)
+!
+!  Fills the optics array used by ibs_rates_calc with the beam parameters at an element.
+!
+!  Input:
+!    ele               - ele_struct: contains Twiss parameters used in IBS formula
+!  Output:
+!    optics(ibs_n_optics$) - real(rp): [gamma, beta, classical_radius, sigma_p, sigma_z, emit_a, emit_b,
+!                              beta_a, beta_b, alpha_a, alpha_b, eta_a, eta_b, etap_a, etap_b]
+!-
+
+subroutine ibs_optics_calc(ele, optics)
+
+  implicit none
+
+  type(ele_struct) :: ele
+  real(rp) optics(ibs_n_optics$)
+  real(rp) gamma, KE, rbeta, classical_radius
+
+  call convert_total_energy_to(ele%value(E_TOT$), ele%branch%param%particle, gamma, KE, rbeta)
+  classical_radius = c_light*c_light*e_charge*1.0d-7*abs(charge_of(ele%branch%param%particle))/mass_of(ele%branch%param%particle)
+
+  optics = [gamma, rbeta, classical_radius, ele%z%sigma_p, ele%z%sigma, ele%a%emit, ele%b%emit, &
+            ele%a%beta, ele%b%beta, ele%a%alpha, ele%b%alpha, ele%a%eta, ele%b%eta, ele%a%etap, ele%b%etap]
+
+end subroutine ibs_optics_calc
+
+!-------------------------------------------------------------------------------------------------------------------
+!-------------------------------------------------------------------------------------------------------------------
+!-------------------------------------------------------------------------------------------------------------------
+!+
+!  subroutine ibs_rates_calc(formula, optics, coulomb_log, n_part, rates)
+!
+!  IBS rates at a set of points computed by the C++ Ibs_rates_calc (ibs_rates_calc.cpp).
+!  The formulas are the same as bjmt1, bane1, mpxx1, mpzt1 and cimp1 but the integrals are done
+!  with a fixed quadrature instead of GSL and the points are done in parallel.
+!
+!  Input:
+!    formula           - character(*): 'bjmt', 'bane', 'mpxx', 'mpzt' or 'cimp'.
+!    optics(:,:)       - real(rp): optics(ibs_n_optics$, n_point) as computed by ibs_optics_calc.
+!    coulomb_log(:)    - real(rp): Coulomb log at each point.
+!    n_part            - real(rp): number of particles in the bunch.
+!  Output:
+!    rates(:)          - ibs_struct: Rates at each point.
+!-
+
+subroutine ibs_rates_calc(formula, optics, coulomb_log, n_part, rates)
+
+  implicit none
+
+  character(*) formula
+  real(rp) optics(:,:), coulomb_log(:), n_part
+  type(ibs_struct) :: rates(:)
+  real(rp) r(3, size(rates))
+  integer i, ix_formula
+
+  select case (formula)
+  case ('bjmt');  ix_formula = 1
+  case ('bane');  ix_formula = 2
+  case ('mpxx');  ix_formula = 3
+  case ('mpzt');  ix_formula = 4
+  case ('cimp');  ix_formula = 5
+  case default
+    write(*,*) "Invalid IBS formula selected ... terminating"
+    write(*,*) "Valid IBS formulas are: cimp, bjmt, bane, mpzt, and mpxx"
+    STOP
+  end select
+
+  if (size(rates) == 0) return
+  call ibs_rates_calc_c(ix_formula, int(size(rates), c_long), optics, coulomb_log, n_part, r)
+
+  do i = 1, size(rates)
+    rates(i)%inv_Ta = r(1,i)
+    rates(i)%inv_Tb = r(2,i)
+    rates(i)%inv_Tz = r(3,i)
+  enddo
+
+end subroutine ibs_rates_calc
+
 !-------------------------------------------------------------------------------------------------------------------
 !-------------------------------------------------------------------------------------------------------------------
 !-------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,295 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Benchmarks of the in-process selectors (see ../common/apisa_selector.hpp).
+
+  Usage:
+    apisa_benchmark nsga2
+    apisa_benchmark dtlz <selector> <problem> <objectives> [seed]
+
+  nsga2: Times the phases of the NSGA2 environmental selection (sorting,
+  crowding distance and survivor selection) for random populations of
+  1000 to 100000 individuals with 2 and 3 objectives. The crowding
+  distance runs the objectives in parallel when compiled with OpenMP.
+
+  dtlz: Runs selector nsga2, nsga3 or spea2 on problem dtlz1 or dtlz2
+  with 3, 5 or 8 objectives and prints the IGD of the final archive.
+  The population, generations and reference directions are those of
+  the table in ../nsga3/nsga3_documentation.txt, the variation is SBX
+  (eta 15, probability 0.9) and polynomial mutation (eta 20, 1/n). The
+  selector writes the metrics log <selector>_<problem>_<objectives>_<seed>.log
+  and the reference front dtlz_front.txt in the current directory.
+
+  Built with the test executables (ACC_BUILD_TEST_EXES).
+
+  file: apisa_benchmark.cpp
+  ========================================================================
+*/
+
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../common/apisa_selector.hpp"
+#include "../common/nd_sort.hpp"
+#include "../common/nsga2_selector.hpp"
+
+using namespace std;
+
+static unsigned long long rng = 1;
+
+static double uniform()
+/* Random number in [0, 1), same generator as the selectors. */
+{
+  rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+  return((rng >> 11) * (1.0 / 9007199254740992.0));
+}
+
+
+static double phase_time(const ApisaSelector& sel, const char* name)
+{
+  const vector<pair<const char*, double> >& t = sel.phase_times();
+  for(size_t i = 0; i < t.size(); i++)
+    if(strcmp(t[i].first, name) == 0) return(t[i].second);
+  return(0);
+}
+
+/*---------------------------| nsga2 phases |----------------------------*/
+
+static void nsga2_phases()
+/* The archive (alpha = size / 2) and the offspring (lambda = size -
+   alpha) together are the 'size' individuals of the timed selection. */
+{
+  int sizes[] = {1000, 3000, 10000, 30000, 100000};
+
+  printf("%4s %8s %8s %12s %12s %12s\n",
+	 "dim", "size", "fronts", "sort_sec", "crowd_sec", "survive_sec");
+
+  for(int dim = 2; dim <= 3; dim++) {
+    for(int s = 0; s < 5; s++) {
+      int size = sizes[s];
+      int alpha = size / 2, lambda = size - alpha;
+      Nsga2Selector sel(alpha, 1, lambda, dim, 0, 1, 2);
+
+      vector<int> index(size);
+      vector<double> f((size_t) size * dim);
+      for(int i = 0; i < size; i++) index[i] = i;
+      for(size_t k = 0; k < f.size(); k++) f[k] = uniform();
+
+      sel.select_initial(alpha, &index[0], &f[0], NULL);
+      sel.select_normal(lambda, &index[alpha], &f[(size_t) alpha * dim], NULL);
+
+      vector<double*> fp(size), cp(size, (double*) NULL);
+      vector<int> rank(size);
+      for(int i = 0; i < size; i++) fp[i] = &f[(size_t) i * dim];
+      int n_front = nd_sort(size, dim, 0, &fp[0], &cp[0], &rank[0]);
+
+      printf("%4d %8d %8d %12.5f %12.5f %12.5f\n", dim, size, n_front,
+	     phase_time(sel, "fitness"), phase_time(sel, "crowding"),
+	     phase_time(sel, "environmental"));
+    }
+  }
+}
+
+/*----------------------------| dtlz runs |------------------------------*/
+
+static void dtlz_eval(bool dtlz1, int dim, int n_var, const double* x, double* f)
+/* Objectives f (dim) of DTLZ1 or DTLZ2 for the variables x (n_var) in [0, 1]. */
+{
+  double g = 0;
+  for(int i = dim - 1; i < n_var; i++) {
+    double d = x[i] - 0.5;
+    g += dtlz1 ? d * d - cos(20 * M_PI * d) : d * d;
+  }
+  if(dtlz1) g = 100 * (n_var - dim + 1 + g);
+
+  for(int m = 0; m < dim; m++) {
+    double v;
+    if(dtlz1) {
+      v = 0.5 * (1 + g);
+      for(int i = 0; i < dim - 1 - m; i++) v *= x[i];
+      if(m > 0) v *= 1 - x[dim - 1 - m];
+    }
+    else {
+      v = 1 + g;
+      for(int i = 0; i < dim - 1 - m; i++) v *= cos(x[i] * M_PI / 2);
+      if(m > 0) v *= sin(x[dim - 1 - m] * M_PI / 2);
+    }
+    f[m] = v;
+  }
+}
+
+
+static void das_dennis(int dim, int p, int pos, int left, vector<int>& k,
+		       vector<vector<double> >& points)
+/* All points of the simplex with coordinates k / p, sum(k) = p. */
+{
+  if(pos == dim - 1) {
+    k[pos] = left;
+    vector<double> v(dim);
+    for(int d = 0; d < dim; d++) v[d] = k[d] / (double) p;
+    points.push_back(v);
+    return;
+  }
+  for(int m = left; m >= 0; m--) {
+    k[pos] = m;
+    das_dennis(dim, p, pos + 1, left - m, k, points);
+  }
+}
+
+
+static double clip(double v)
+{
+  return(v < 0 ? 0 : v > 1 ? 1 : v);
+}
+
+
+static int dtlz_run(const char* name, const char* problem, int dim, int seed)
+{
+  bool dtlz1 = strcmp(problem, "dtlz1") == 0;
+  if(!dtlz1 && strcmp(problem, "dtlz2") != 0) return(1);
+
+  int size, gen, divisions, divisions_inner = 0, p_front;
+  if(dim == 3) {size = 92; gen = dtlz1 ? 400 : 250; divisions = 12; p_front = 40;}
+  else if(dim == 5) {size = 212; gen = dtlz1 ? 600 : 350; divisions = 6; p_front = 12;}
+  else if(dim == 8) {size = 156; gen = dtlz1 ? 750 : 500; divisions = 3; divisions_inner = 2; p_front = 7;}
+  else return(1);
+  int n_var = dim + (dtlz1 ? 4 : 9);
+
+  rng = (unsigned long long) seed * 7919 + 1;
+
+  /* reference front for the IGD: the linear (DTLZ1) or spherical (DTLZ2)
+     Pareto front sampled on Das-Dennis points */
+  vector<vector<double> > front;
+  vector<int> k(dim);
+  das_dennis(dim, p_front, 0, p_front, k, front);
+  FILE* fp = fopen("dtlz_front.txt", "w");
+  if(fp == NULL) return(1);
+  for(size_t i = 0; i < front.size(); i++) {
+    double norm = 0;
+    for(int d = 0; d < dim; d++) norm += front[i][d] * front[i][d];
+    norm = sqrt(norm);
+    for(int d = 0; d < dim; d++)
+      fprintf(fp, "%.8g ", dtlz1 ? 0.5 * front[i][d] : front[i][d] / norm);
+    fprintf(fp, "\n");
+  }
+  fclose(fp);
+
+  char log[256];
+  snprintf(log, sizeof(log), "%s_%s_%d_%d.log", name, problem, dim, seed);
+  string ref;
+  for(int d = 0; d < dim; d++) ref += d ? (dtlz1 ? ",0.55" : ",1.1") : (dtlz1 ? "0.55" : "1.1");
+
+  fp = fopen("dtlz_param.txt", "w");
+  if(fp == NULL) return(1);
+  fprintf(fp, "seed %d\ntournament 2\nk_neighbor SQRT\ndivisions %d\ndivisions_inner %d\n",
+	  seed, divisions, divisions_inner);
+  fprintf(fp, "metrics %s\nmetrics_ref %s\nmetrics_front dtlz_front.txt\nmetrics_samples 20000\n",
+	  log, ref.c_str());
+  fclose(fp);
+
+  void* sel = apisa_selector_new(name, "dtlz_param.txt", size, size, size, dim, 0);
+  if(sel == NULL) return(1);
+
+  /* every individual ever made is kept, its index is its row in x */
+  vector<double> x((size_t) size * (gen + 2) * n_var);
+  vector<int> index(size), parent(size);
+  vector<double> f((size_t) size * dim);
+  double c = 0;
+  int next = 0;
+
+  for(int i = 0; i < size; i++, next++) {
+    index[i] = next;
+    for(int j = 0; j < n_var; j++) x[(size_t) next * n_var + j] = uniform();
+    dtlz_eval(dtlz1, dim, n_var, &x[(size_t) next * n_var], &f[(size_t) i * dim]);
+  }
+  apisa_select_initial(sel, size, &index[0], &f[0], &c);
+
+  for(int g = 0; g < gen; g++) {
+    apisa_selected(sel, size, &parent[0]);
+    for(int i = 0; i < size; i += 2) {
+      double* y[2] = {&x[(size_t) next * n_var], &x[(size_t) (next + 1) * n_var]};
+      const double* a = &x[(size_t) parent[i] * n_var];
+      const double* b = &x[(size_t) parent[(i + 1) % size] * n_var];
+
+      /* SBX crossover */
+      bool cross = uniform() < 0.9;
+      for(int j = 0; j < n_var; j++) {
+	if(cross && uniform() < 0.5) {
+	  double u = uniform();
+	  double beta = u <= 0.5 ? pow(2 * u, 1 / 16.0) : pow(1 / (2 * (1 - u)), 1 / 16.0);
+	  y[0][j] = clip(0.5 * ((1 + beta) * a[j] + (1 - beta) * b[j]));
+	  y[1][j] = clip(0.5 * ((1 - beta) * a[j] + (1 + beta) * b[j]));
+	}
+	else {
+	  y[0][j] = a[j];
+	  y[1][j] = b[j];
+	}
+      }
+
+      /* polynomial mutation */
+      for(int t = 0; t < 2; t++) {
+	for(int j = 0; j < n_var; j++) {
+	  if(uniform() >= 1.0 / n_var) continue;
+	  double u = uniform();
+	  double dq = u < 0.5 ? pow(2 * u, 1 / 21.0) - 1 : 1 - pow(2 * (1 - u), 1 / 21.0);
+	  y[t][j] = clip(y[t][j] + dq);
+	}
+      }
+
+      for(int t = 0; t < 2 && i + t < size; t++, next++) {
+	index[i + t] = next;
+	dtlz_eval(dtlz1, dim, n_var, &x[(size_t) next * n_var], &f[(size_t) (i + t) * dim]);
+      }
+    }
+    apisa_select_normal(sel, size, &index[0], &f[0], &c);
+  }
+  apisa_selector_delete(sel);
+
+  /* IGD of the last line of the metrics log */
+  fp = fopen(log, "r");
+  if(fp == NULL) return(1);
+  string line, last;
+  int ch;
+  while((ch = fgetc(fp)) != EOF) {
+    if(ch != '\n') line += (char) ch;
+    else {
+      if(!line.empty()) last = line;
+      line.clear();
+    }
+  }
+  fclose(fp);
+  if(!line.empty()) last = line;
+  size_t pos = last.find("\"igd\":");
+  if(pos == string::npos) return(1);
+
+  printf("%6s %6s %4d %6d %6d %6d %10.4f\n", name, problem, dim, size, gen, seed,
+	 atof(last.c_str() + pos + 6));
+  return(0);
+}
+
+/*------------------------------| main() |-------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  if(argc == 2 && strcmp(argv[1], "nsga2") == 0) nsga2_phases();
+  else if((argc == 5 || argc == 6) && strcmp(argv[1], "dtlz") == 0) {
+    if(dtlz_run(argv[2], argv[3], atoi(argv[4]), argc == 6 ? atoi(argv[5]) : 1) != 0) {
+      fprintf(stderr, "apisa_benchmark: invalid dtlz run or cannot write its files\n");
+      return(1);
+    }
+  }
+  else {
+    fprintf(stderr, "Usage: apisa_benchmark nsga2\n"
+	    "       apisa_benchmark dtlz <nsga2|nsga3|spea2> <dtlz1|dtlz2> <3|5|8> [seed]\n");
+    return(1);
+  }
+  return(0);
+}
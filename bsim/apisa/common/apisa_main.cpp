@@ -0,0 +1,405 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Selector process shared by the ansga2, ansga3 and aspea2 programs
+  (see apisa_main.hpp). Implements the Petri net of the selector side
+  and the data exchange through files (text or binary) or the socket.
+
+  file: apisa_main.cpp
+  based on the NSGA2 and SPEA2 selector programs by
+    Marco Laumanns, laumanns@tik.ee.ethz.ch
+    Stefan Bleuler, bleuler@tik.ee.ethz.ch
+    Ivan Bazarov, bazarov@cornell.edu
+  ========================================================================
+*/
+
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/* Choose the sleep function of wait_state():
+   PISA_UNIX uses sleep() and usleep() in <unistd.h>,
+   PISA_WIN uses Sleep() in <windows.h>. */
+/* #define PISA_WIN */
+#define PISA_UNIX
+
+#ifdef PISA_UNIX
+#include <unistd.h>
+#endif
+
+#ifdef PISA_WIN
+#include <windows.h>
+#endif
+
+#include "apisa_main.hpp"
+#include "apisa_selector.hpp"
+#include "pisa_bin.hpp"
+#include "pisa_ipc.hpp"
+
+using namespace std;
+
+namespace {
+
+/* State of the selector process. */
+struct Process {
+  string name;       /* selector name for apisa_selector_new */
+  string paramfile;  /* file with local parameters */
+  string statefile, cfgfile, inifile, varfile, selfile, arcfile;
+  bool binary_files; /* option 'bin': binary data files */
+
+  /* common parameters from the cfg file */
+  int alpha;  /* number of individuals in initial population */
+  int mu;     /* number of individuals selected as parents */
+  int lambda; /* number of offspring individuals */
+  int dim;    /* number of objectives */
+  int con;    /* number of constraints */
+
+  void* selector;  /* NULL before the initial selection */
+
+  /* individuals read from the 'ini' or 'var' file, indices to write */
+  vector<int> new_index;
+  vector<double> new_f, new_c;
+  vector<int> out_index;
+};
+
+
+void pisa_error(const char* msg)
+{
+  fprintf(stderr, "\nError: %s\n", msg);
+  fflush(stderr);
+  exit(EXIT_FAILURE);
+}
+
+/*-------------------------| control flow |------------------------------*/
+
+void write_flag(const string& filename, int flag)
+/* Write the state flag to given file. */
+{
+  if(pisa_ipc_active()) { /* the other side may have quit already */
+    pisa_ipc_write_state(flag);
+    return;
+  }
+
+  FILE* fp = fopen(filename.c_str(), "w");
+  if(fp == NULL) pisa_error("Selector: cannot write state file.");
+  fprintf(fp, "%d", flag);
+  fclose(fp);
+}
+
+
+int read_flag(const string& filename)
+/* Read state flag from given file. -1 if it cannot be read. */
+{
+  int flag = -1;
+
+  if(pisa_ipc_active()) return(pisa_ipc_read_state());
+
+  FILE* fp = fopen(filename.c_str(), "r");
+  if(fp != NULL) {
+    int result = fscanf(fp, "%d", &flag);
+    fclose(fp);
+    if(result != 1) return(-1);
+    if(flag < 0 || flag > 11) pisa_error("Selector: Invalid state read from file.");
+  }
+  return(flag);
+}
+
+
+void wait_state(double sec)
+/* Makes the calling process sleep for sec (>= 0.01) seconds. With the
+   socket transport waits for the next state instead. */
+{
+  if(pisa_ipc_active()) {
+    if(pisa_ipc_wait(-1) < 0) pisa_error("Selector: variator disconnected.");
+    return;
+  }
+
+#ifdef PISA_UNIX
+  /* split it up, usleep can fail if argument greater than 1e6 */
+  unsigned int int_sec = (unsigned int) sec;
+  sleep(int_sec);
+  usleep((useconds_t) ((sec - int_sec) * 1e6));
+#endif
+
+#ifdef PISA_WIN
+  Sleep((DWORD) (sec * 1e3));
+#endif
+}
+
+/*-----------------------| initialization |------------------------------*/
+
+void read_cfg_entry(FILE* fp, const char* name, int& value)
+{
+  char str[128];
+  if(fscanf(fp, "%127s %d", str, &value) != 2 || strcmp(str, name) != 0) {
+    fprintf(stderr, "\nError: Selector: '%s' expected in cfg file\n", name);
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+void initialize(Process& p)
+/* Reads the cfg file and creates the selector. */
+{
+  FILE* fp = fopen(p.cfgfile.c_str(), "r");
+  if(fp == NULL) pisa_error("Selector: cannot open cfg file.");
+  read_cfg_entry(fp, "initial_population_size", p.alpha);
+  read_cfg_entry(fp, "parent_set_size", p.mu);
+  read_cfg_entry(fp, "offspring_set_size", p.lambda);
+  read_cfg_entry(fp, "objectives", p.dim);
+  read_cfg_entry(fp, "constraints", p.con);
+  fclose(fp);
+
+  p.selector = apisa_selector_new(p.name.c_str(), p.paramfile.c_str(),
+				  p.alpha, p.mu, p.lambda, p.dim, p.con);
+  if(p.selector == NULL) pisa_error("Selector: invalid cfg file or paramfile.");
+
+  int n = p.alpha > p.lambda ? p.alpha : p.lambda;
+  p.new_index.assign(n, 0);
+  p.new_f.assign((size_t) n * p.dim, 0);
+  p.new_c.assign((size_t) n * p.con + 1, 0);
+  p.out_index.assign(p.alpha + p.lambda + p.mu, 0);
+}
+
+
+void free_selector(Process& p)
+{
+  if(p.selector == NULL) return;
+  apisa_selector_delete(p.selector);
+  p.selector = NULL;
+}
+
+/*--------------------| data exchange functions |------------------------*/
+
+void clear_file(const string& filename)
+/* Marks a file as read by setting its content to "0". */
+{
+  FILE* fp = fopen(filename.c_str(), "w");
+  if(fp == NULL) pisa_error("Selector: cannot write data file.");
+  fprintf(fp, "0");
+  fclose(fp);
+}
+
+
+int read_pop(const string& filename, int* index, double* f, double* c,
+	     int size, int dim, int con)
+/* Reads individuals from file into index, f (size x dim) and c (size x con).
+   Returns 1 if the file is not (completely) written yet. */
+{
+  int entries = 0;
+  char tag[4];
+
+  FILE* fp = fopen(filename.c_str(), "r");
+  if(fp == NULL) return(1);
+
+  if(fscanf(fp, "%d", &entries) != 1 || entries == 0) {
+    fclose(fp);
+    return(1);
+  }
+  if(entries != size * (dim + con + 1)) pisa_error("Selector: wrong number of entries in data file.");
+
+  for(int j = 0; j < size; j++) {
+    bool ok = fscanf(fp, "%d", &index[j]) == 1;
+    for(int i = 0; i < dim && ok; i++) ok = fscanf(fp, "%le", &f[j * dim + i]) == 1;
+    for(int i = 0; i < con && ok; i++) ok = fscanf(fp, "%le", &c[j * con + i]) == 1;
+    if(!ok) {  /* file not completely written */
+      fclose(fp);
+      return(1);
+    }
+  }
+
+  /* after all data elements: "END" expected */
+  if(fscanf(fp, "%3s", tag) != 1 || strcmp(tag, "END") != 0) {
+    fclose(fp);
+    return(1);
+  }
+  fclose(fp);
+
+  clear_file(filename);  /* delete file content if reading successful */
+  return(0);
+}
+
+
+int read_pop_ipc(Process& p, int size)
+/* Reads individuals received over the socket. */
+{
+  int columns = p.dim + p.con + 1;
+  vector<double> rows((size_t) size * columns + 1);
+
+  if(pisa_ipc_get_pop(size, columns, &rows[0]) != 0) return(1);
+
+  for(int j = 0; j < size; j++) {
+    const double* row = &rows[(size_t) j * columns];
+    p.new_index[j] = (int) row[0];
+    for(int i = 0; i < p.dim; i++) p.new_f[j * p.dim + i] = row[1 + i];
+    for(int i = 0; i < p.con; i++) p.new_c[j * p.con + i] = row[1 + p.dim + i];
+  }
+  return(0);
+}
+
+
+int read_individuals(Process& p, const string& filename, int size)
+/* Reads the 'ini' (size = alpha) or 'var' (size = lambda) individuals.
+   Returns 0 on success and 1 if they are not available yet. */
+{
+  if(pisa_ipc_active()) return(read_pop_ipc(p, size));
+
+  if(p.binary_files) {
+    if(pisa_bin_read_pop(filename.c_str(), size, p.dim, p.con,
+			 &p.new_index[0], &p.new_f[0], &p.new_c[0]) != 0) return(1);
+    clear_file(filename);
+    return(0);
+  }
+
+  return(read_pop(filename, &p.new_index[0], &p.new_f[0], &p.new_c[0], size, p.dim, p.con));
+}
+
+
+void write_indices(Process& p, int which)
+/* Writes the selected parents (PISA_IPC_SEL) or the archive (PISA_IPC_ARC). */
+{
+  int* index = &p.out_index[0];
+  int max_n = (int) p.out_index.size();
+  int size = which == PISA_IPC_SEL ? apisa_selected(p.selector, max_n, index)
+                                   : apisa_archive(p.selector, max_n, index);
+  const string& filename = which == PISA_IPC_SEL ? p.selfile : p.arcfile;
+
+  if(pisa_ipc_active()) {
+    pisa_ipc_put_index(which, size, index);
+    return;
+  }
+
+  if(p.binary_files) {
+    if(pisa_bin_write_index(filename.c_str(), size, index) != 0)
+      pisa_error("Selector: cannot write binary file.");
+    return;
+  }
+
+  FILE* fp = fopen(filename.c_str(), "w");
+  if(fp == NULL) pisa_error("Selector: cannot write data file.");
+  fprintf(fp, "%d\n", size); /* number of elements */
+  for(int i = 0; i < size; i++) fprintf(fp, "%d\n", index[i]);
+  fprintf(fp, "END");
+  fclose(fp);
+}
+
+
+int check_file(const string& filename)
+/* 0 if the variator has read the file (content "0"), 1 otherwise. */
+{
+  int control_element = 1;
+
+  if(pisa_ipc_active()) return(0); /* nothing to wait for */
+
+  FILE* fp = fopen(filename.c_str(), "r");
+  if(fp == NULL) pisa_error("Selector: cannot read data file.");
+  if(fscanf(fp, "%d", &control_element) != 1) control_element = 1;
+  fclose(fp);
+
+  return(control_element == 0 ? 0 : 1);
+}
+
+} /* namespace */
+
+/*------------------------------| main |---------------------------------*/
+
+int apisa_main(const char* name, int argc, char* argv[])
+{
+  Process p;
+  string base;        /* filename base, e.g., "dir/test." */
+  double poll = 1.0;  /* polling interval in seconds */
+  int state = -1;
+
+  /* reading command line parameters */
+  if(argc != 4 && argc != 5)
+    pisa_error("Selector: wrong number of arguments");
+  p.name = name;
+  p.paramfile = argv[1];
+  base = argv[2];
+  if(sscanf(argv[3], "%lf", &poll) != 1 || poll < 0.01)
+    pisa_error("Selector: polling interval must be at least 0.01 s");
+  p.binary_files = false;
+  p.selector = NULL;
+
+  if(argc == 5) {
+    if(strcmp(argv[4], "ipc") == 0) {
+      if(pisa_ipc_connect(base.c_str(), poll) != 0)
+	pisa_error("Selector: cannot connect to variator");
+    }
+    else if(strcmp(argv[4], "bin") == 0)
+      p.binary_files = true;
+    else
+      pisa_error("Selector: unknown option");
+  }
+
+  p.statefile = base + "sta";
+  p.cfgfile = base + "cfg";
+  p.inifile = base + "ini";
+  p.varfile = base + "var";
+  p.selfile = base + "sel";
+  p.arcfile = base + "arc";
+
+  /* main loop */
+  while(state != 6) { /* stop state for selector */
+                      /* Caution: if reading of the statefile fails
+                         (e.g. no permission) this is an infinite loop */
+    state = read_flag(p.statefile);
+
+    if(state == 1) { /* initial selection */
+      free_selector(p);
+      initialize(p);
+      if(read_individuals(p, p.inifile, p.alpha) == 0) {
+	apisa_select_initial(p.selector, p.alpha, &p.new_index[0], &p.new_f[0], &p.new_c[0]);
+	write_indices(p, PISA_IPC_ARC);  /* all individuals that could ever be used again */
+	write_indices(p, PISA_IPC_SEL);
+	state = 2;
+	write_flag(p.statefile, state);
+      }  /* else don't do anything and wait again */
+    }
+
+    else if(state == 3) { /* selection */
+      if(check_file(p.arcfile) == 0 && check_file(p.selfile) == 0 &&
+	 read_individuals(p, p.varfile, p.lambda) == 0) {
+	apisa_select_normal(p.selector, p.lambda, &p.new_index[0], &p.new_f[0], &p.new_c[0]);
+	write_indices(p, PISA_IPC_ARC);
+	write_indices(p, PISA_IPC_SEL);
+	state = 2;
+	write_flag(p.statefile, state);
+      }  /* else don't do anything and wait again */
+    }
+
+    else if(state == 5) { /* variator just terminated,
+			     here you can do what you want */
+      state = 6;          /* e.g., terminate too */
+      write_flag(p.statefile, state);
+    }
+
+    else if(state == 9) { /* variator ready for reset,
+			     here you can do what you want */
+      state = 10;         /* e.g., get ready for reset too */
+      write_flag(p.statefile, state);
+    }
+
+    else if(state == 10) { /* reset */
+      free_selector(p);
+      state = 11;
+      write_flag(p.statefile, state);
+    }
+
+    else wait_state(poll); /* state == -1 (reading failed) or state concerns variator */
+  } /* state == 6 (stop) */
+
+  free_selector(p);
+  state = 7;
+  write_flag(p.statefile, state);
+  return(0);
+}
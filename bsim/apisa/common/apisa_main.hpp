@@ -0,0 +1,40 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Selector process shared by the ansga2, ansga3 and aspea2 programs.
+
+  apisa_main() runs the selector side of the PISA protocol: it follows
+  the state file '<filenamebase>sta', reads the individuals from the
+  'ini' and 'var' files and writes the 'sel' and 'arc' index files. The
+  selection is done by an in-process selector made with
+  apisa_selector_new() (see apisa_selector.hpp).
+
+  Command line of the programs:
+    <program> paramfile filenamebase poll [ipc|bin]
+
+    paramfile     -- selector parameter file (nsga2_param.txt, etc.)
+    filenamebase  -- prefix of the PISA files, e.g. "dir/test."
+    poll          -- polling interval in seconds (at least 0.01)
+    ipc           -- exchange states and data over the socket
+                     '<filenamebase>sock' instead of files (pisa_ipc.hpp)
+    bin           -- binary ini, var, sel and arc files (pisa_bin.hpp)
+
+  The common parameters are read from the cfg file '<filenamebase>cfg'
+  at each initial selection.
+
+  file: apisa_main.hpp
+  ========================================================================
+*/
+
+#ifndef APISA_MAIN_HPP
+#define APISA_MAIN_HPP
+
+/* Runs selector 'name' ("nsga2", "nsga3" or "spea2") with the command
+   line arguments of the program until the variator stops it. Returns
+   the exit status of the program. Errors end the program. */
+int apisa_main(const char* name, int argc, char* argv[]);
+
+#endif /* APISA_MAIN_HPP */
@@ -0,0 +1,590 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  In-process selectors: common part and C interface.
+
+  file: apisa_selector.cpp
+  ========================================================================
+*/
+
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <ctime>
+#include <chrono>
+
+#include "apisa_selector.hpp"
+#include "metrics.hpp"
+#include "nd_sort.hpp"
+#include "nsga2_selector.hpp"
+#include "nsga3_selector.hpp"
+#include "spea2_selector.hpp"
+
+/*-------------------------| construction |------------------------------*/
+
+ApisaSelector::ApisaSelector(int alpha, int mu, int lambda, int dim, int con,
+			     int seed, int tournament)
+  : alpha(alpha), mu(mu), lambda(lambda), dim(dim), con(con),
+    tournament(tournament), diag_first(true), metrics_auto_ref(true),
+    metrics_samples(0), generation(0), phase_start(0)
+{
+  assert(alpha > 0 && mu > 0 && lambda > 0);
+  assert(dim > 0 && con >= 0);
+
+  /* seeding random number generator */
+  rng = (unsigned long long) seed;
+  irand(1);
+
+  /* create individual pool */
+  int n = alpha + lambda;
+  slab = (ind*) chk_malloc(n * sizeof(ind));
+  f_slab = (double*) chk_malloc((size_t) n * dim * sizeof(double));
+  c_slab = (double*) chk_malloc((size_t) n * con * sizeof(double) + 1);
+  free_slot = (int*) chk_malloc(n * sizeof(int));
+  for(int s = 0; s < n; s++) free_slot[s] = n - 1 - s; /* slot 0 on top */
+  n_free = n;
+
+  /* create archive, offspring and mating pool pop */
+  pp_all = create_pop(alpha + lambda);
+  pp_new = create_pop(alpha > lambda ? alpha : lambda);
+  pp_sel = create_pop(mu);
+}
+
+
+ApisaSelector::~ApisaSelector()
+{
+  clear();
+  free_pop(pp_sel);
+  free_pop(pp_new);
+  free_pop(pp_all);
+  free(slab);
+  free(f_slab);
+  free(c_slab);
+  free(free_slot);
+}
+
+
+void ApisaSelector::clear()
+/* Frees the individuals of the archive. */
+{
+  for(int i = 0; i < pp_all->size; i++) free_ind(pp_all->ind_array[i]);
+  pp_all->size = 0;
+  pp_sel->size = 0;
+}
+
+/*---------------------------| selection |-------------------------------*/
+
+int ApisaSelector::select_initial(int n, const int* index, const double* f, const double* c)
+{
+  if(n != alpha) return(1);
+  clear();
+  generation = 0;
+  phase(NULL);
+  read(n, index, f, c);
+  phase("read");
+  selection();
+  if(!metrics_file.empty()) write_metrics();
+  return(0);
+}
+
+
+int ApisaSelector::select_normal(int n, const int* index, const double* f, const double* c)
+{
+  if(n != lambda) return(1);
+  generation++;
+  phase(NULL);
+  read(n, index, f, c);
+  phase("read");
+  selection();
+  if(!metrics_file.empty()) write_metrics();
+  return(0);
+}
+
+
+int ApisaSelector::read(int n, const int* index, const double* f, const double* c)
+/* Copies the individuals into 'pp_new'. */
+{
+  assert(n <= pp_new->maxsize);
+
+  for(int i = 0; i < n; i++) {
+    ind* p_ind = create_ind();
+    p_ind->index = index[i];
+    for(int d = 0; d < dim; d++) p_ind->f[d] = f[i * dim + d];
+    for(int j = 0; j < con; j++) p_ind->c[j] = c[i * con + j];
+    pp_new->ind_array[i] = p_ind;
+  }
+  pp_new->size = n;
+  return(0);
+}
+
+
+void ApisaSelector::mergeOffspring()
+/* Joins the offspring individuals 'pp_new' to the population. */
+{
+  assert(pp_all->size + pp_new->size <= pp_all->maxsize);
+
+  for(int i = 0; i < pp_new->size; i++)
+    pp_all->ind_array[pp_all->size + i] = pp_new->ind_array[i];
+
+  pp_all->size += pp_new->size;
+  pp_new->size = 0;
+}
+
+
+int ApisaSelector::archive_size() const
+{
+  return(pp_all->size);
+}
+
+
+int ApisaSelector::selected_size() const
+{
+  return(pp_sel->size);
+}
+
+
+void ApisaSelector::archive(int* index) const
+{
+  for(int i = 0; i < pp_all->size; i++) index[i] = pp_all->ind_array[i]->index;
+}
+
+
+void ApisaSelector::selected(int* index) const
+{
+  for(int i = 0; i < pp_sel->size; i++) index[i] = pp_sel->ind_array[i]->index;
+}
+
+/*--------------------------| diagnostics |------------------------------*/
+
+void ApisaSelector::set_diagnostics(const char* file)
+{
+  diag_file = file == NULL ? "" : file;
+  diag_first = true;
+}
+
+
+void ApisaSelector::diag(const char* str)
+/* Writes date and time and 'str' to the diagnostics file, if any. */
+{
+  if(diag_file.empty()) return;
+
+  char date_string[64];
+  time_t now = time(0);
+  struct tm* curr_date = localtime(&now);
+  if(curr_date != NULL)
+    strftime(date_string, sizeof (date_string), "%d.%m.%Y %H:%M:%S", curr_date);
+  else strcpy(date_string, "no date");
+
+  FILE* fp = fopen(diag_file.c_str(), diag_first ? "w" : "a");
+  if(fp == NULL) return;
+  diag_first = false;
+  fprintf(fp, "(%s) %s", date_string, str);
+  fclose(fp);
+}
+
+/*----------------------------| metrics |--------------------------------*/
+
+int ApisaSelector::set_metrics(const char* file, const char* ref_point,
+			       const char* ref_front, int samples)
+{
+  metrics_file = file == NULL ? "" : file;
+  metrics_samples = samples > 0 ? samples : 10000;
+  metrics_ref.clear();
+  metrics_front.clear();
+  metrics_auto_ref = true;
+
+  if(ref_point != NULL && ref_point[0] != '\0') {
+    const char* p = ref_point;
+    char* end;
+    for(int d = 0; d < dim; d++) {
+      if(d > 0 && *p++ != ',') return(1);
+      metrics_ref.push_back(strtod(p, &end));
+      if(end == p) return(1);
+      p = end;
+    }
+    if(*p != '\0') return(1);
+    metrics_auto_ref = false;
+  }
+
+  if(ref_front != NULL && ref_front[0] != '\0') {
+    FILE* fp = fopen(ref_front, "r");
+    if(fp == NULL) return(1);
+    double x;
+    while(fscanf(fp, "%lf", &x) == 1) metrics_front.push_back(x);
+    bool ok = feof(fp) && !metrics_front.empty() && metrics_front.size() % dim == 0;
+    fclose(fp);
+    if(!ok) {
+      metrics_front.clear();
+      return(1);
+    }
+  }
+  metrics_front_file = ref_front == NULL ? "" : ref_front;
+  return(0);
+}
+
+
+static double seconds()
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void ApisaSelector::phase(const char* name)
+{
+  double t = seconds();
+  if(name == NULL) phase_sec.clear();
+  else phase_sec.push_back(std::make_pair(name, t - phase_start));
+  phase_start = t;
+}
+
+
+const std::vector<std::pair<const char*, double> >& ApisaSelector::phase_times() const
+{
+  return(phase_sec);
+}
+
+
+static void print_number(FILE* fp, double x)
+/* JSON number, null for undefined (negative) metrics. */
+{
+  if(x < 0) fprintf(fp, "null");
+  else fprintf(fp, "%.10g", x);
+}
+
+
+void ApisaSelector::write_metrics()
+/* Appends the metrics of the archive to the metrics file. */
+{
+  int i, d;
+  int size = pp_all->size;
+  double** f = (double**) chk_malloc(size * sizeof(double*) + 1);
+  double** c = (double**) chk_malloc(size * sizeof(double*) + 1);
+  int* rank = (int*) chk_malloc(size * sizeof(int) + 1);
+
+  for(i = 0; i < size; i++) {
+    f[i] = pp_all->ind_array[i]->f;
+    c[i] = pp_all->ind_array[i]->c;
+  }
+  int n_front = size > 0 ? nd_sort(size, dim, con, f, c, rank) : 0;
+
+  /* reference point from the initial population */
+  if(generation == 0 && metrics_auto_ref) {
+    metrics_ref.assign(dim, 0);
+    for(d = 0; d < dim && size > 0; d++) {
+      double lo = f[0][d], hi = f[0][d];
+      for(i = 1; i < size; i++) {
+	if(f[i][d] < lo) lo = f[i][d];
+	if(f[i][d] > hi) hi = f[i][d];
+      }
+      metrics_ref[d] = hi + (hi > lo ? 0.1 * (hi - lo) : 1);
+    }
+  }
+
+  /* feasible members of the first front, moved to the top of f */
+  int n = 0, n_first = 0, n_feasible = 0;
+  for(i = 0; i < size; i++) {
+    bool feasible = is_feasible(pp_all->ind_array[i]);
+    if(feasible) n_feasible++;
+    if(rank[i] == 0) {
+      n_first++;
+      if(feasible) f[n++] = f[i];
+    }
+  }
+
+  int n_ref = metrics_front.size() / dim;
+  std::vector<double*> r(n_ref + 1);
+  for(i = 0; i < n_ref; i++) r[i] = &metrics_front[i * dim];
+
+  double hv = 0;
+  if(metrics_ref.size() == (size_t) dim) {
+    if(dim <= METRICS_EXACT_DIM) hv = hypervolume_exact(n, dim, f, &metrics_ref[0]);
+    else hv = hypervolume_mc(n, dim, f, &metrics_ref[0], metrics_samples, 1);
+  }
+  double ig = n_ref > 0 ? igd(n, dim, f, n_ref, &r[0]) : -1;
+  double sp = spread(n, dim, f, n_ref, &r[0]);
+
+  free(f);
+  free(c);
+  free(rank);
+  phase("metrics");
+
+  FILE* fp = fopen(metrics_file.c_str(), generation == 0 ? "w" : "a");
+  if(fp == NULL) return;
+
+  if(generation == 0) {
+    fprintf(fp, "{\"dim\":%d,\"ref\":[", dim);
+    for(d = 0; d < dim; d++) fprintf(fp, "%s%.10g", d > 0 ? "," : "", metrics_ref[d]);
+    fprintf(fp, "],\"hypervolume\":\"%s\",\"samples\":%d,\"ref_front\":",
+	    dim <= METRICS_EXACT_DIM ? "exact" : "monte_carlo",
+	    dim <= METRICS_EXACT_DIM ? 0 : metrics_samples);
+    if(n_ref > 0) fprintf(fp, "\"%s\"", metrics_front_file.c_str());
+    else fprintf(fp, "null");
+    fprintf(fp, ",\"ref_front_size\":%d}\n", n_ref);
+  }
+
+  fprintf(fp, "{\"gen\":%d,\"archive\":%d,\"feasible\":%d,\"fronts\":%d,\"front1\":%d,\"hv\":",
+	  generation, size, n_feasible, n_front, n_first);
+  print_number(fp, hv);
+  fprintf(fp, ",\"igd\":");
+  print_number(fp, ig);
+  fprintf(fp, ",\"spread\":");
+  print_number(fp, sp);
+  fprintf(fp, ",\"sec\":{");
+  for(i = 0; i < (int) phase_sec.size(); i++)
+    fprintf(fp, "%s\"%s\":%.6g", i > 0 ? "," : "", phase_sec[i].first, phase_sec[i].second);
+  fprintf(fp, "}}\n");
+  fclose(fp);
+}
+
+/*-------------------| memory allocation functions |---------------------*/
+
+void* ApisaSelector::chk_malloc(size_t size)
+/* Wrapper function for malloc(). Checks for failed allocations. */
+{
+  void* return_value = malloc(size);
+  if(return_value == NULL) {
+    fprintf(stderr, "\nError: Selector: Out of memory.\n");
+    fflush(stderr);
+    exit(EXIT_FAILURE);
+  }
+  return(return_value);
+}
+
+
+ApisaSelector::pop* ApisaSelector::create_pop(int maxsize)
+/* Allocates memory for a population. */
+{
+  pop* pp;
+
+  assert(maxsize >= 0);
+
+  pp = (pop*) chk_malloc(sizeof(pop));
+  pp->size = 0;
+  pp->maxsize = maxsize;
+  pp->ind_array = (ind**) chk_malloc(maxsize * sizeof(ind*) + 1);
+
+  for(int i = 0; i < maxsize; i++) pp->ind_array[i] = NULL;
+
+  return(pp);
+}
+
+
+void ApisaSelector::free_pop(pop* pp)
+/* Frees memory for given population. */
+{
+  assert(pp != NULL);
+
+  free(pp->ind_array);
+  free(pp);
+}
+
+
+ApisaSelector::ind* ApisaSelector::create_ind()
+/* Takes an individual from the pool. */
+{
+  ind* p_ind;
+  int s;
+
+  assert(n_free > 0); /* more than alpha + lambda individuals */
+
+  s = free_slot[--n_free];
+  p_ind = &slab[s];
+  p_ind->index = -1;
+  p_ind->fitness = -1;
+  p_ind->f = f_slab + (size_t) s * dim;
+  p_ind->c = c_slab + (size_t) s * con;
+  return(p_ind);
+}
+
+
+void ApisaSelector::free_ind(ind* p_ind)
+/* Returns an individual to the pool. */
+{
+  assert(p_ind != NULL);
+  assert(slab <= p_ind && p_ind < slab + alpha + lambda);
+  assert(n_free < alpha + lambda);
+
+  free_slot[n_free++] = p_ind - slab;
+}
+
+/*----------------------------| dominance |------------------------------*/
+
+bool ApisaSelector::is_feasible(ind* i1) const
+/* Determines if an individual is feasible.
+   Constraints are of the form g(x) >= 0. */
+{
+  for(int j = 0; j < con; ++j) if(i1->c[j] < 0) return false;
+  return(true);
+}
+
+
+bool ApisaSelector::con_dominates(ind* i1, ind* i2) const
+/* Determines if one individual constrain-dominates another.
+   Minimizing fitness values.
+   Constraints are of the form g(x) >= 0. */
+{
+  bool i1_feasible = is_feasible(i1);
+  bool i2_feasible = is_feasible(i2);
+
+  if(i1_feasible)
+    if(i2_feasible) return(dominates(i1,i2));
+    else return(true);
+  else if(i2_feasible) return(false);
+
+  /* here if both individuals are infeasible */
+  bool is_better = false;
+  for(int j = 0; j < con; ++j) {
+    if((i1->c[j] >= 0) && (i2->c[j] >= 0)) continue;
+    if(i1->c[j] < i2->c[j]) return(false);
+    else if(i1->c[j] > i2->c[j]) is_better = true;
+  }
+  return(is_better);
+}
+
+
+bool ApisaSelector::dominates(ind* p_ind_a, ind* p_ind_b) const
+/* Determines if one individual dominates another.
+   Minimizing fitness values. */
+{
+  bool a_is_worse = false;
+  bool equal = true;
+
+  for(int i = 0; i < dim && !a_is_worse; i++) {
+    a_is_worse = p_ind_a->f[i] > p_ind_b->f[i];
+    equal = (p_ind_a->f[i] == p_ind_b->f[i]) && equal;
+  }
+
+  return(!equal && !a_is_worse);
+}
+
+
+int ApisaSelector::is_equal(ind* p_ind_a, ind* p_ind_b) const
+/* Determines if two individuals are equal in all objective values. */
+{
+  int equal = 1;
+
+  for(int i = 0; i < dim; i++)
+    equal = (p_ind_a->f[i] == p_ind_b->f[i]) && equal;
+
+  return(equal);
+}
+
+
+int ApisaSelector::irand(int range)
+/* Generate a random integer in [0, range). Each selector has its own
+   generator (64 bit linear congruential, D. Knuth's MMIX constants)
+   so selectors in the same process do not disturb each other. */
+{
+  rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+  double u = (rng >> 11) * (1.0 / 9007199254740992.0); /* 53 bits in [0, 1) */
+  return((int) (range * u));
+}
+
+/*---------------------------| C interface |-----------------------------*/
+
+void* apisa_selector_new(const char* name, const char* paramfile,
+			 int alpha, int mu, int lambda, int dim, int con)
+{
+  FILE* fp;
+  char str[128], val[128];
+  int seed = -1, tournament = -1, kth = 0, divisions = 0, divisions_inner = 0;
+  bool verbose = false;
+  std::string metrics, metrics_ref, metrics_front;
+  int metrics_samples = 0;
+  ApisaSelector* selector;
+
+  if(alpha <= 0 || mu <= 0 || lambda <= 0 || dim <= 0 || con < 0) return(NULL);
+
+  /* parameter file: 'name value' pairs */
+  fp = fopen(paramfile, "r");
+  if(fp == NULL) {
+    fprintf(stderr, "Selector: cannot open %s\n", paramfile);
+    return(NULL);
+  }
+  while(fscanf(fp, "%127s %127s", str, val) == 2) {
+    if(strcmp(str, "seed") == 0) seed = atoi(val);
+    else if(strcmp(str, "tournament") == 0) tournament = atoi(val);
+    else if(strcmp(str, "k_neighbor") == 0) kth = strcmp(val, "SQRT") == 0 ? 0 : atoi(val);
+    else if(strcmp(str, "divisions") == 0) divisions = atoi(val);
+    else if(strcmp(str, "divisions_inner") == 0) divisions_inner = atoi(val);
+    else if(strcmp(str, "verbose") == 0) verbose = strcmp(val, "YES") == 0;
+    else if(strcmp(str, "metrics") == 0) metrics = val;
+    else if(strcmp(str, "metrics_ref") == 0) metrics_ref = val;
+    else if(strcmp(str, "metrics_front") == 0) metrics_front = val;
+    else if(strcmp(str, "metrics_samples") == 0) metrics_samples = atoi(val);
+    else {
+      fprintf(stderr, "Selector: unknown parameter %s in %s\n", str, paramfile);
+      fclose(fp);
+      return(NULL);
+    }
+  }
+  fclose(fp);
+
+  if(seed < 0 || tournament <= 0 || kth < 0 || divisions < 0 || divisions_inner < 0) {
+    fprintf(stderr, "Selector: missing or invalid parameters in %s\n", paramfile);
+    return(NULL);
+  }
+
+  if(strcmp(name, "nsga2") == 0)
+    selector = new Nsga2Selector(alpha, mu, lambda, dim, con, seed, tournament);
+  else if(strcmp(name, "spea2") == 0)
+    selector = new Spea2Selector(alpha, mu, lambda, dim, con, seed, tournament, kth);
+  else if(strcmp(name, "nsga3") == 0)
+    selector = new Nsga3Selector(alpha, mu, lambda, dim, con, seed, tournament,
+				 divisions, divisions_inner);
+  else {
+    fprintf(stderr, "Selector: unknown selector %s\n", name);
+    return(NULL);
+  }
+
+  if(verbose) selector->set_diagnostics((std::string(name) + "_diag.log").c_str());
+  if(!metrics.empty() &&
+     selector->set_metrics(metrics.c_str(), metrics_ref.c_str(), metrics_front.c_str(), metrics_samples) != 0) {
+    fprintf(stderr, "Selector: invalid metrics_ref or metrics_front in %s\n", paramfile);
+    delete selector;
+    return(NULL);
+  }
+  return(selector);
+}
+
+
+void apisa_selector_delete(void* selector)
+{
+  delete (ApisaSelector*) selector;
+}
+
+
+int apisa_select_initial(void* selector, int n, const int* index, const double* f, const double* c)
+{
+  return(((ApisaSelector*) selector)->select_initial(n, index, f, c));
+}
+
+
+int apisa_select_normal(void* selector, int n, const int* index, const double* f, const double* c)
+{
+  return(((ApisaSelector*) selector)->select_normal(n, index, f, c));
+}
+
+
+int apisa_archive(void* selector, int max_n, int* index)
+{
+  ApisaSelector* s = (ApisaSelector*) selector;
+  int n = s->archive_size();
+  if(n <= max_n) s->archive(index);
+  return(n);
+}
+
+
+int apisa_selected(void* selector, int max_n, int* index)
+{
+  ApisaSelector* s = (ApisaSelector*) selector;
+  int n = s->selected_size();
+  if(n <= max_n) s->selected(index);
+  return(n);
+}
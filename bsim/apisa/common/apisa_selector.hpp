@@ -0,0 +1,216 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  In-process selectors.
+
+  ApisaSelector is the base class of the NSGA2, NSGA3 and SPEA2
+  selectors (nsga2_selector.hpp, nsga3_selector.hpp, spea2_selector.hpp). A selector object holds the
+  whole state of one optimization, so several can be used in the same
+  process. The individuals are passed in and out as arrays, without
+  the PISA files or processes. The ansga2, ansga3 and aspea2 programs
+  run one selector with the PISA file (or socket) exchange of
+  apisa_main.hpp.
+
+  The C functions at the end give Fortran (bind(c)) and C access, see
+  pisa_mod for the Fortran side.
+
+  file: apisa_selector.hpp
+  ========================================================================
+*/
+
+#ifndef APISA_SELECTOR_HPP
+#define APISA_SELECTOR_HPP
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ApisaSelector {
+public:
+  /* alpha: archive (initial population) size, mu: number of selected
+     parents, lambda: number of offspring, dim: number of objectives,
+     con: number of constraints, seed: random number seed,
+     tournament: tournament size of the mating selection. */
+  ApisaSelector(int alpha, int mu, int lambda, int dim, int con, int seed, int tournament);
+  virtual ~ApisaSelector();
+
+  /* Selection for the initial population (n = alpha) and for the
+     offspring of each generation (n = lambda). index[i] identifies
+     individual i, its objectives are f[i*dim + d] and its constraints
+     c[i*con + j] (g >= 0 is feasible; c may be NULL if con = 0).
+     Objectives are minimized.
+     Returns 0, or 1 if n is wrong. */
+  int select_initial(int n, const int* index, const double* f, const double* c);
+  int select_normal(int n, const int* index, const double* f, const double* c);
+
+  /* The archive (all individuals that can still be selected) and the mu
+     selected parents after the last selection, as indices. */
+  int archive_size() const;
+  int selected_size() const;
+  void archive(int* index) const;
+  void selected(int* index) const;
+
+  /* Appends diagnostics messages to 'file' (truncated on the first
+     message). */
+  void set_diagnostics(const char* file);
+
+  /* Writes quality metrics of the archive after every selection to
+     'file', one JSON object per line (truncated at each initial selection,
+     written and closed at each generation so it can be followed while
+     the optimization runs). The first line has the setup:
+
+       {"dim":2,"ref":[1.1,1.1],"hypervolume":"exact","samples":0,
+        "ref_front":"front.txt","ref_front_size":100}
+
+     and the others one generation each (gen 0 = initial selection):
+
+       {"gen":12,"archive":100,"feasible":100,"fronts":3,"front1":64,
+        "hv":0.8312,"igd":0.0123,"spread":0.41,
+        "sec":{"read":1e-05,"fitness":0.0012,...,"metrics":0.0009}}
+
+     The metrics are those of the feasible members of the first front
+     (see metrics.hpp): the hypervolume with respect to ref_point, exact
+     for up to METRICS_EXACT_DIM objectives and a Monte Carlo estimate
+     from 'samples' points above; the IGD to the points of the file
+     ref_front, if given; and the generalized spread. 'fronts' is the
+     number of non-dominated fronts of the archive and 'sec' the time of
+     each phase of the selection and of the metrics.
+
+     ref_point is dim comma separated numbers; if NULL or empty it is set
+     at the initial selection to the worst objective values of the
+     initial population plus 10% of their range. ref_front is a text
+     file of dim numbers per point. igd and spread are null where they
+     are not defined (no reference front, too few points).
+     Returns 0, or 1 if ref_point or ref_front cannot be read. */
+  int set_metrics(const char* file, const char* ref_point, const char* ref_front,
+		  int samples);
+
+  /* Name and time in seconds of each phase of the last selection (the
+     'sec' entry of the metrics log). */
+  const std::vector<std::pair<const char*, double> >& phase_times() const;
+
+  typedef struct ind_st  /* an individual */
+  {
+    int index;
+    double* f; /* objective vector */
+    double* c; /* constraint vector */
+    double fitness;
+  } ind;
+
+  typedef struct pop_st  /* a population */
+  {
+    int size;
+    int maxsize;
+    ind** ind_array;
+  } pop;
+
+protected:
+  int alpha;  /* number of individuals in initial population */
+  int mu;     /* number of individuals selected as parents */
+  int lambda; /* number of offspring individuals */
+  int dim;    /* number of objectives */
+  int con;    /* number of constraints */
+  int tournament;  /* parameter for tournament selection */
+
+  /* population containers */
+  pop* pp_all;
+  pop* pp_new;
+  pop* pp_sel;
+
+  /* One selection step: merges pp_new into pp_all, truncates pp_all to
+     alpha individuals and fills pp_sel. */
+  virtual void selection() = 0;
+
+  void mergeOffspring();
+  void diag(const char* str);
+
+  /* Ends the current phase of the selection and records its time under
+     'name' for the metrics log. The first phase starts before reading
+     the individuals. */
+  void phase(const char* name);
+
+  static void* chk_malloc(size_t size);
+  pop* create_pop(int maxsize);
+  void free_pop(pop* pp);
+
+  /* Individuals come from a pool of alpha + lambda slots, the most that
+     are alive at a time (archive and offspring). The objectives and the
+     constraints of all slots are each one contiguous block, and the
+     slots of deleted individuals are reused for the next offspring, so
+     nothing is allocated during a run. */
+  ind* create_ind();
+  void free_ind(ind* p_ind);
+
+  bool is_feasible(ind* i1) const;
+  bool con_dominates(ind* i1, ind* i2) const;
+  bool dominates(ind* p_ind_a, ind* p_ind_b) const;
+  int is_equal(ind* p_ind_a, ind* p_ind_b) const;
+  int irand(int range);
+
+private:
+  /* individual pool (see create_ind) */
+  ind* slab;          /* records of all slots */
+  double* f_slab;     /* objectives of slot s at f_slab[s*dim] */
+  double* c_slab;     /* constraints of slot s at c_slab[s*con] */
+  int* free_slot;     /* stack of unused slots */
+  int n_free;
+
+  unsigned long long rng;  /* state of the random number generator */
+  std::string diag_file;
+  bool diag_first;
+
+  /* metrics log (see set_metrics) */
+  std::string metrics_file;
+  std::vector<double> metrics_ref;    /* reference point, empty until set */
+  bool metrics_auto_ref;              /* set from the initial population */
+  std::vector<double> metrics_front;  /* reference front, dim per point */
+  std::string metrics_front_file;
+  int metrics_samples;
+  int generation;
+  double phase_start;
+  std::vector<std::pair<const char*, double> > phase_sec;
+
+  void write_metrics();
+
+  int read(int n, const int* index, const double* f, const double* c);
+  void clear();
+
+  ApisaSelector(const ApisaSelector&);
+  ApisaSelector& operator=(const ApisaSelector&);
+};
+
+extern "C" {
+#endif /* __cplusplus */
+
+/*---------------------------| C interface |-----------------------------*/
+
+/* Creates a selector. name is "nsga2", "nsga3" or "spea2" and paramfile
+   is the selector parameter file of ansga2, ansga3 or aspea2
+   (nsga2_param.txt, nsga3_param.txt, spea2_param.txt), including the optional metrics parameters (see
+   set_metrics). The other arguments are those of the PISA cfg file.
+   Returns NULL on error. */
+void* apisa_selector_new(const char* name, const char* paramfile,
+			 int alpha, int mu, int lambda, int dim, int con);
+void apisa_selector_delete(void* selector);
+
+/* See ApisaSelector. Return 0 on success. */
+int apisa_select_initial(void* selector, int n, const int* index, const double* f, const double* c);
+int apisa_select_normal(void* selector, int n, const int* index, const double* f, const double* c);
+
+/* Copy the indices of the archive or the selected parents into index
+   if there are at most max_n. Return the number of individuals in the
+   set. */
+int apisa_archive(void* selector, int max_n, int* index);
+int apisa_selected(void* selector, int max_n, int* index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APISA_SELECTOR_HPP */
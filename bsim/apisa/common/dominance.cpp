@@ -0,0 +1,243 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Pairwise dominance of a population and the SPEA2 fitness derived
+  from it.
+
+  Row i of 'dom' holds the individuals dominated by i and row i of
+  'domby' those dominating i, one bit each. Only the upper triangle
+  (j > i) is compared. The lower triangle of each matrix is the
+  transpose of the upper triangle of the other one and is filled by
+  64 x 64 bit block transposes.
+
+  file: dominance.cpp
+  ========================================================================
+*/
+
+
+#include <cmath>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "dominance.hpp"
+
+#ifdef _OPENMP
+#define OMP_PRAGMA(directive) _Pragma(#directive)
+#else
+#define OMP_PRAGMA(directive)
+#endif
+
+using namespace std;
+
+namespace {
+
+typedef unsigned long long Word;
+const int word_bits = 64;
+
+
+bool is_feasible(const double* c, int con)
+{
+  for(int j = 0; j < con; ++j) if(c[j] < 0) return false;
+  return true;
+}
+
+
+/* Constraint dominance of two infeasible individuals.
+   Same as the infeasible branch of con_dominates() in the selectors. */
+bool con_dominates(const double* a, const double* b, int con)
+{
+  bool is_better = false;
+  for(int j = 0; j < con; ++j) {
+    if((a[j] >= 0) && (b[j] >= 0)) continue;
+    if(a[j] < b[j]) return false;
+    else if(a[j] > b[j]) is_better = true;
+  }
+  return is_better;
+}
+
+
+/* Fills the words of rows i of 'dom' and 'domby' from the one holding
+   bit i+1 on. n_infeasible[w] is the number of infeasible individuals
+   in word w. obj is padded with NaN, which compares false, to a
+   multiple of 64 individuals. */
+void compare_row(int i, int size, int dim, int con, const vector<double>& obj,
+		 const vector<char>& feasible, const vector<int>& n_infeasible,
+		 double** c, Word* dom_i, Word* domby_i)
+{
+  int stride = obj.size() / dim;
+
+  for(int j0 = (i + 1) / word_bits * word_bits; j0 < size; j0 += word_bits) {
+    int n = size - j0 < word_bits ? size - j0 : word_bits;
+    Word w_dom = 0, w_domby = 0;
+
+    /* objective comparisons for a block of 64 */
+#ifdef __SSE2__
+    for(int jj = 0; jj < word_bits; jj += 2) {
+      __m128d better = _mm_setzero_pd(), worse = _mm_setzero_pd();
+      for(int d = 0; d < dim; d++) {
+	__m128d fj = _mm_loadu_pd(&obj[d * stride + j0 + jj]);
+	__m128d fi = _mm_set1_pd(obj[d * stride + i]);
+	better = _mm_or_pd(better, _mm_cmplt_pd(fi, fj));
+	worse = _mm_or_pd(worse, _mm_cmpgt_pd(fi, fj));
+      }
+      w_dom |= Word(_mm_movemask_pd(_mm_andnot_pd(worse, better))) << jj;
+      w_domby |= Word(_mm_movemask_pd(_mm_andnot_pd(better, worse))) << jj;
+    }
+#else
+    double better[word_bits], worse[word_bits]; /* 1 if i is better/worse in some objective */
+    for(int jj = 0; jj < word_bits; jj++) better[jj] = worse[jj] = 0;
+    for(int d = 0; d < dim; d++) {
+      const double* fj = &obj[d * stride + j0];
+      double fi = obj[d * stride + i];
+      for(int jj = 0; jj < word_bits; jj++) {
+	better[jj] = fi < fj[jj] ? 1 : better[jj];
+	worse[jj] = fi > fj[jj] ? 1 : worse[jj];
+      }
+    }
+    for(int jj = 0; jj < word_bits; jj++) {
+      w_dom |= Word(better[jj] > worse[jj]) << jj;
+      w_domby |= Word(worse[jj] > better[jj]) << jj;
+    }
+#endif
+
+    /* constraints */
+    if(!feasible[i] || n_infeasible[j0 / word_bits] > 0) {
+      for(int jj = 0; jj < n; jj++) {
+	int j = j0 + jj;
+	bool i_dom, j_dom;
+	if(feasible[i] && feasible[j]) continue;
+	else if(feasible[i] || feasible[j]) {
+	  i_dom = feasible[i];
+	  j_dom = feasible[j];
+	}
+	else {
+	  i_dom = con_dominates(c[i], c[j], con);
+	  j_dom = con_dominates(c[j], c[i], con);
+	}
+	w_dom = (w_dom & ~(Word(1) << jj)) | (Word(i_dom) << jj);
+	w_domby = (w_domby & ~(Word(1) << jj)) | (Word(j_dom) << jj);
+      }
+    }
+
+    /* only j > i */
+    if(j0 <= i) {
+      Word mask = ~Word(0) << (i - j0 + 1);
+      w_dom &= mask;
+      w_domby &= mask;
+    }
+
+    dom_i[j0 / word_bits] = w_dom;
+    domby_i[j0 / word_bits] = w_domby;
+  }
+}
+
+
+/* Transposes a 64 x 64 bit matrix, bit l of a[k] being element (k, l)
+   (H. S. Warren, Hacker's Delight, 2nd ed., section 7-3). */
+void transpose64(Word* a)
+{
+  Word m = 0x00000000FFFFFFFFULL;
+  for(int j = 32; j != 0; j >>= 1, m ^= m << j) {
+    for(int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+      Word t = ((a[k] >> j) ^ a[k | j]) & m;
+      a[k] ^= t << j;
+      a[k | j] ^= t;
+    }
+  }
+}
+
+
+/* Fills the lower triangle of the rows in block 'jb' (64 rows) from the
+   upper triangle of the other matrix: dom[j][i] = domby[i][j]. */
+void fill_lower(int jb, int size, int nw, vector<Word>& dom, vector<Word>& domby)
+{
+  Word a[word_bits], b[word_bits];
+  int r0 = jb * word_bits;
+  int nr = size - r0 < word_bits ? size - r0 : word_bits;
+
+  for(int ib = 0; ib <= jb; ib++) {
+    int c0 = ib * word_bits;
+    int nc = size - c0 < word_bits ? size - c0 : word_bits;
+
+    /* block (ib, jb) of the upper triangle */
+    for(int k = 0; k < word_bits; k++) {
+      a[k] = k < nc ? domby[(c0 + k) * nw + jb] : 0;
+      b[k] = k < nc ? dom[(c0 + k) * nw + jb] : 0;
+    }
+    transpose64(a);
+    transpose64(b);
+
+    for(int k = 0; k < nr; k++) {
+      dom[(r0 + k) * nw + ib] |= a[k];
+      domby[(r0 + k) * nw + ib] |= b[k];
+    }
+  }
+}
+
+} /* namespace */
+
+/*-------------------------| strength_fitness |--------------------------*/
+
+void strength_fitness(int size, int dim, int con, double** f, double** c,
+		      int* strength, int* raw)
+{
+  int nw = (size + word_bits - 1) / word_bits;
+  int stride = nw * word_bits;
+  vector<double> obj(stride * dim, NAN);    /* obj[d*stride + i] = f[i][d] */
+  vector<char> feasible(size);
+  vector<int> n_infeasible(nw, 0);
+  vector<Word> dom(size * nw, 0);
+  vector<Word> domby(size * nw, 0);
+
+  for(int i = 0; i < size; i++) {
+    for(int d = 0; d < dim; d++) obj[d * stride + i] = f[i][d];
+    feasible[i] = is_feasible(c[i], con);
+    if(!feasible[i]) n_infeasible[i / word_bits]++;
+    strength[i] = 0;
+    raw[i] = 0;
+  }
+
+  OMP_PRAGMA(omp parallel for schedule(dynamic, 16))
+  for(int i = 0; i < size; i++)
+    compare_row(i, size, dim, con, obj, feasible, n_infeasible, c,
+		&dom[i * nw], &domby[i * nw]);
+
+  /* complete the matrices with the transposed upper triangles */
+  OMP_PRAGMA(omp parallel for schedule(dynamic))
+  for(int jb = 0; jb < nw; jb++)
+    fill_lower(jb, size, nw, dom, domby);
+
+  /* strength = row popcount of 'dom' */
+  int max_strength = 0;
+  for(int i = 0; i < size; i++) {
+    for(int w = 0; w < nw; w++) strength[i] += __builtin_popcountll(dom[i * nw + w]);
+    if(strength[i] > max_strength) max_strength = strength[i];
+  }
+
+  /* raw fitness = sum of the strengths in row i of 'domby'. With the
+     bit planes plane[b] = {j: bit b of strength[j] set} this is
+     sum_b 2^b popcount(domby[i] & plane[b]). */
+  int n_plane = 0;
+  while((max_strength >> n_plane) != 0) n_plane++;
+
+  vector<Word> plane(n_plane * nw, 0);
+  for(int j = 0; j < size; j++)
+    for(int b = 0; b < n_plane; b++)
+      if((strength[j] >> b) & 1) plane[b * nw + j / word_bits] |= Word(1) << (j % word_bits);
+
+  OMP_PRAGMA(omp parallel for schedule(dynamic, 16))
+  for(int i = 0; i < size; i++) {
+    const Word* row = &domby[i * nw];
+    for(int b = 0; b < n_plane; b++) {
+      const Word* pb = &plane[b * nw];
+      int n = 0;
+      for(int w = 0; w < nw; w++) n += __builtin_popcountll(row[w] & pb[w]);
+      raw[i] += n << b;
+    }
+  }
+}
@@ -0,0 +1,36 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Pairwise dominance of a population and the SPEA2 fitness derived
+  from it.
+
+  file: dominance.hpp
+  ========================================================================
+*/
+
+#ifndef DOMINANCE_HPP
+#define DOMINANCE_HPP
+
+/* Computes the SPEA2 strength and raw fitness of 'size' individuals.
+
+   f[i] (dim values) and c[i] (con values) are the objective and
+   constraint vectors of individual i, with the dominance relation of
+   con_dominates() in the selectors (see nd_sort.hpp).
+
+   On return strength[i] is the number of individuals that i dominates
+   and raw[i] is the sum of the strengths of the individuals dominating
+   i (0 for non-dominated individuals).
+
+   Each pair is compared once, with the objectives in struct of arrays
+   layout so the comparisons vectorize. The relations are stored in
+   bit matrices (2 size^2 bits) and strength and raw fitness are bit
+   count reductions over their rows. The rows are distributed over
+   threads when compiled with OpenMP. */
+
+void strength_fitness(int size, int dim, int con, double** f, double** c,
+		      int* strength, int* raw);
+
+#endif /* DOMINANCE_HPP */
@@ -0,0 +1,163 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  k-d tree for nearest neighbor queries in objective space.
+
+  The tree splits at the median of the coordinate with the largest
+  spread. A query descends to the leaf containing the point and visits
+  the far side of a split only if the splitting plane is closer than the
+  k-th best distance found so far. For the low number of objectives of
+  typical problems a query costs O(k log N).
+
+  file: kd_tree.cpp
+  ========================================================================
+*/
+
+
+#include <algorithm>
+#include <cmath>
+
+#include "kd_tree.hpp"
+
+using namespace std;
+
+namespace {
+
+const int leaf_size = 8;
+
+
+/* Order of the points along one coordinate. */
+struct CoordLess {
+  const double* x;
+  int dim, d;
+  bool operator()(int a, int b) const {
+    if(x[a*dim+d] != x[b*dim+d]) return x[a*dim+d] < x[b*dim+d];
+    return a < b;
+  }
+};
+
+} /* namespace */
+
+/*--------------------------| construction |-----------------------------*/
+
+KdTree::KdTree(int n, int dim, double** xx) : n(n), dim(dim), x(n * dim), perm(n)
+{
+  for(int i = 0; i < n; i++) {
+    for(int d = 0; d < dim; d++) x[i*dim+d] = xx[i][d];
+    perm[i] = i;
+  }
+
+  if(n > 0) {
+    nodes.reserve(2 * n / leaf_size + 1);
+    build(0, n);
+  }
+}
+
+
+int KdTree::build(int begin, int end)
+/* Builds the subtree for perm[begin..end-1]. Returns its node index. */
+{
+  Node node = {begin, end, 0, 0, -1, -1};
+  int inode = nodes.size();
+  nodes.push_back(node);
+
+  if(end - begin <= leaf_size) return inode;
+
+  /* split the coordinate with the largest spread */
+  double max_spread = -1;
+  for(int d = 0; d < dim; d++) {
+    double lo = x[perm[begin]*dim+d], hi = lo;
+    for(int p = begin + 1; p < end; p++) {
+      double v = x[perm[p]*dim+d];
+      if(v < lo) lo = v;
+      if(v > hi) hi = v;
+    }
+    if(hi - lo > max_spread) {
+      max_spread = hi - lo;
+      node.split_dim = d;
+    }
+  }
+
+  if(max_spread == 0) return inode; /* all points identical */
+
+  int mid = (begin + end) / 2;
+  CoordLess less = {&x[0], dim, node.split_dim};
+  nth_element(perm.begin() + begin, perm.begin() + mid, perm.begin() + end, less);
+  node.split = x[perm[mid]*dim+node.split_dim];
+
+  node.left = build(begin, mid);
+  node.right = build(mid, end);
+  nodes[inode] = node;
+
+  return inode;
+}
+
+/*-----------------------------| queries |-------------------------------*/
+
+double KdTree::distance(int a, int b) const
+{
+  double sum = 0;
+  for(int d = 0; d < dim; d++) {
+    double diff = x[a*dim+d] - x[b*dim+d];
+    sum += diff * diff;
+  }
+  return sqrt(sum);
+}
+
+
+void KdTree::nearest(int i, int k, vector<int>& nn, vector<double>& d) const
+{
+  nn.clear();
+  d.clear();
+  if(k > n - 1) k = n - 1;
+  if(k <= 0) return;
+
+  /* max heap of the k best (distance, index) pairs found so far */
+  Heap heap;
+  heap.reserve(k + 1);
+  search(0, i, k, heap);
+
+  sort_heap(heap.begin(), heap.end());
+  for(size_t m = 0; m < heap.size(); m++) {
+    d.push_back(heap[m].first);
+    nn.push_back(heap[m].second);
+  }
+}
+
+
+void KdTree::search(int inode, int i, int k, Heap& heap) const
+{
+  const Node& node = nodes[inode];
+
+  if(node.left < 0) {
+    for(int p = node.begin; p < node.end; p++) {
+      int j = perm[p];
+      if(j == i) continue;
+      pair<double, int> cand(distance(i, j), j);
+      if((int)heap.size() < k) {
+	heap.push_back(cand);
+	push_heap(heap.begin(), heap.end());
+      }
+      else if(cand < heap.front()) {
+	pop_heap(heap.begin(), heap.end());
+	heap.back() = cand;
+	push_heap(heap.begin(), heap.end());
+      }
+    }
+    return;
+  }
+
+  double diff = x[i*dim+node.split_dim] - node.split;
+  int near = diff <= 0 ? node.left : node.right;
+  int far = diff <= 0 ? node.right : node.left;
+
+  search(near, i, k, heap);
+
+  /* Points beyond the plane are at least |diff| away. The tolerance keeps
+     points at exactly the k-th distance so that ties go to the lower index. */
+  if((int)heap.size() < k || fabs(diff) <= heap.front().first * (1 + 1e-12))
+    search(far, i, k, heap);
+}
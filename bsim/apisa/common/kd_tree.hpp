@@ -0,0 +1,58 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  k-d tree for nearest neighbor queries in objective space.
+
+  file: kd_tree.hpp
+  ========================================================================
+*/
+
+#ifndef KD_TREE_HPP
+#define KD_TREE_HPP
+
+#include <utility>
+#include <vector>
+
+class KdTree {
+public:
+  /* Builds the tree for 'n' points x[i] with 'dim' coordinates each.
+     The coordinates are copied so x may be freed afterwards. */
+  KdTree(int n, int dim, double** x);
+
+  int size() const { return n; }
+
+  /* Euclidean distance between points a and b. */
+  double distance(int a, int b) const;
+
+  /* Finds the 'k' nearest neighbors of point i (i itself excluded)
+     ordered by distance and then by index. On return nn[] holds the
+     neighbors and d[] their distances. Fewer than k neighbors are
+     returned if the tree has fewer than k+1 points.
+
+     The distances are computed exactly as distance() does so ties are
+     resolved consistently with it. */
+  void nearest(int i, int k, std::vector<int>& nn, std::vector<double>& d) const;
+
+private:
+  struct Node {
+    int begin, end;   /* range in 'perm' */
+    int split_dim;
+    double split;
+    int left, right;  /* children, -1 for a leaf */
+  };
+
+  int n, dim;
+  std::vector<double> x;    /* coordinates, point i at x[i*dim] */
+  std::vector<int> perm;    /* point indices in tree order */
+  std::vector<Node> nodes;
+
+  typedef std::vector< std::pair<double, int> > Heap;
+
+  int build(int begin, int end);
+  void search(int node, int i, int k, Heap& heap) const;
+};
+
+#endif /* KD_TREE_HPP */
@@ -0,0 +1,271 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Quality metrics of an approximation set.
+
+  file: metrics.cpp
+  ========================================================================
+*/
+
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "metrics.hpp"
+
+using namespace std;
+
+namespace {
+
+/* Points of the hypervolume recursion, rows of d values. */
+typedef vector<double> Points;
+
+
+/* Lexicographic order of rows. */
+struct RowLess {
+  const double* p;
+  int d;
+  bool operator()(int a, int b) const {
+    for(int i = 0; i < d; i++) {
+      if(p[a*d + i] < p[b*d + i]) return true;
+      if(p[a*d + i] > p[b*d + i]) return false;
+    }
+    return false;
+  }
+};
+
+
+/* Order of rows by the last value, largest (worst) first. */
+struct LastGreater {
+  const double* p;
+  int d;
+  bool operator()(int a, int b) const {
+    return p[a*d + d - 1] > p[b*d + d - 1];
+  }
+};
+
+
+/* Removes the rows weakly dominated by another row (one of several
+   equal rows is kept). In lexicographic order a row can only be
+   dominated by an earlier one. */
+void nondominated(Points& p, int d)
+{
+  int n = p.size() / d;
+  if(n < 2) return;
+
+  vector<int> order(n);
+  for(int i = 0; i < n; i++) order[i] = i;
+  RowLess less = {&p[0], d};
+  sort(order.begin(), order.end(), less);
+
+  Points kept;
+  kept.reserve(p.size());
+  for(int k = 0; k < n; k++) {
+    const double* a = &p[order[k] * d];
+    bool dominated = false;
+    for(size_t m = 0; m < kept.size() && !dominated; m += d) {
+      dominated = true;
+      for(int i = 0; i < d && dominated; i++) dominated = kept[m + i] <= a[i];
+    }
+    if(!dominated) kept.insert(kept.end(), a, a + d);
+  }
+  p.swap(kept);
+}
+
+
+/* Two objectives: sweep in order of the first objective. */
+double hv2(const Points& p, const double* ref)
+{
+  int n = p.size() / 2;
+  vector<int> order(n);
+  for(int i = 0; i < n; i++) order[i] = i;
+  RowLess less = {&p[0], 2};
+  sort(order.begin(), order.end(), less);
+
+  double vol = 0, y_last = ref[1];
+  for(int k = 0; k < n; k++) {
+    const double* a = &p[order[k] * 2];
+    if(a[1] < y_last) {
+      vol += (ref[0] - a[0]) * (y_last - a[1]);
+      y_last = a[1];
+    }
+  }
+  return vol;
+}
+
+
+/* Hypervolume of mutually nondominated rows of d values, all better
+   than ref. */
+double wfg(const Points& p, int d, const double* ref)
+{
+  int n = p.size() / d;
+  if(n == 0) return 0;
+
+  if(d == 1) {
+    double lo = p[0];
+    for(int k = 1; k < n; k++) lo = min(lo, p[k]);
+    return ref[0] - lo;
+  }
+  if(d == 2) return hv2(p, ref);
+
+  if(n == 1) {
+    double vol = 1;
+    for(int i = 0; i < d; i++) vol *= ref[i] - p[i];
+    return vol;
+  }
+
+  vector<int> order(n);
+  for(int i = 0; i < n; i++) order[i] = i;
+  LastGreater greater = {&p[0], d};
+  sort(order.begin(), order.end(), greater);
+
+  /* the rows after k are not worse in the last objective, so the limit
+     set of k is flat there and its volume a slice of height ref - a */
+  double vol = 0;
+  Points limit;
+  for(int k = 0; k < n; k++) {
+    const double* a = &p[order[k] * d];
+
+    limit.clear();
+    for(int j = k + 1; j < n; j++) {
+      const double* b = &p[order[j] * d];
+      for(int i = 0; i < d - 1; i++) limit.push_back(max(a[i], b[i]));
+    }
+    nondominated(limit, d - 1);
+
+    double incl = 1;
+    for(int i = 0; i < d - 1; i++) incl *= ref[i] - a[i];
+    vol += (ref[d-1] - a[d-1]) * (incl - wfg(limit, d - 1, ref));
+  }
+  return vol;
+}
+
+
+/* The points better than ref in every objective. */
+void inside(int n, int dim, double** f, const double* ref, Points& p)
+{
+  p.clear();
+  for(int k = 0; k < n; k++) {
+    bool in = true;
+    for(int i = 0; i < dim && in; i++) in = f[k][i] < ref[i];
+    if(in) p.insert(p.end(), f[k], f[k] + dim);
+  }
+}
+
+
+double distance(int dim, const double* a, const double* b)
+{
+  double s = 0;
+  for(int i = 0; i < dim; i++) s += (a[i] - b[i]) * (a[i] - b[i]);
+  return sqrt(s);
+}
+
+
+/* Distance from a to the closest of the n points f, skipping 'skip'. */
+double closest(int n, int dim, double** f, const double* a, int skip)
+{
+  double best = HUGE_VAL;
+  for(int k = 0; k < n; k++)
+    if(k != skip) best = min(best, distance(dim, a, f[k]));
+  return best;
+}
+
+} /* namespace */
+
+/*---------------------------| hypervolume |-----------------------------*/
+
+double hypervolume_exact(int n, int dim, double** f, const double* ref)
+{
+  Points p;
+  inside(n, dim, f, ref, p);
+  nondominated(p, dim);
+  return wfg(p, dim, ref);
+}
+
+
+double hypervolume_mc(int n, int dim, double** f, const double* ref,
+		      int samples, unsigned long long seed)
+{
+  Points p;
+  inside(n, dim, f, ref, p);
+  nondominated(p, dim);
+  int m = p.size() / dim;
+  if(m == 0 || samples <= 0) return 0;
+
+  vector<double> lo(p.begin(), p.begin() + dim);
+  for(int k = 1; k < m; k++)
+    for(int i = 0; i < dim; i++) lo[i] = min(lo[i], p[k*dim + i]);
+
+  double box = 1;
+  for(int i = 0; i < dim; i++) box *= ref[i] - lo[i];
+
+  /* 64 bit linear congruential generator as in ApisaSelector::irand;
+     the point that dominated the last sample is tried first */
+  vector<double> x(dim);
+  unsigned long long rng = seed;
+  int hits = 0, last = 0;
+  for(int s = 0; s < samples; s++) {
+    for(int i = 0; i < dim; i++) {
+      rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+      double u = (rng >> 11) * (1.0 / 9007199254740992.0);
+      x[i] = lo[i] + u * (ref[i] - lo[i]);
+    }
+    for(int t = 0; t < m; t++) {
+      int k = (last + t) % m;
+      bool dom = true;
+      for(int i = 0; i < dim && dom; i++) dom = p[k*dim + i] <= x[i];
+      if(dom) {
+	hits++;
+	last = k;
+	break;
+      }
+    }
+  }
+  return box * hits / samples;
+}
+
+/*------------------------| distance metrics |---------------------------*/
+
+double igd(int n, int dim, double** f, int n_ref, double** r)
+{
+  if(n == 0) return -1;
+  if(n_ref == 0) return 0;
+
+  double sum = 0;
+  for(int k = 0; k < n_ref; k++) sum += closest(n, dim, f, r[k], -1);
+  return sum / n_ref;
+}
+
+
+double spread(int n, int dim, double** f, int n_ref, double** r)
+{
+  if(n < 2) return -1;
+
+  vector<double> nn(n);
+  double mean = 0;
+  for(int k = 0; k < n; k++) {
+    nn[k] = closest(n, dim, f, f[k], k);
+    mean += nn[k];
+  }
+  mean /= n;
+
+  double extreme = 0;
+  if(n_ref > 0) {
+    for(int i = 0; i < dim; i++) {
+      int e = 0;
+      for(int k = 1; k < n_ref; k++)
+	if(r[k][i] < r[e][i]) e = k;
+      extreme += closest(n, dim, f, r[e], -1);
+    }
+  }
+
+  double dev = 0;
+  for(int k = 0; k < n; k++) dev += fabs(nn[k] - mean);
+
+  double denom = extreme + n * mean;
+  return denom > 0 ? (extreme + dev) / denom : 0;
+}
@@ -0,0 +1,58 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Quality metrics of an approximation set, for the per generation log
+  of the selectors (ApisaSelector::set_metrics).
+
+  f[i] (dim values) is the objective vector of point i. Objectives are
+  minimized.
+
+  file: metrics.hpp
+  ========================================================================
+*/
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+/* Largest number of objectives for which hypervolume_exact() is used
+   by the selectors; above it the hypervolume is estimated. */
+#define METRICS_EXACT_DIM 5
+
+/* Hypervolume of the region dominated by the points and bounded by the
+   reference point ref. Points that are not better than ref in every
+   objective add nothing.
+
+   hypervolume_exact() uses the WFG algorithm (While, Bradstreet and
+   Barone, IEEE TEC 16, 2012): the points are processed worst first in
+   the last objective, so the part of the volume dominated by point k
+   alone is a slice of the (dim-1) dimensional volume of its limit set,
+   and the recursion ends in an O(N log N) sweep for two objectives.
+
+   hypervolume_mc() is a Monte Carlo estimate from 'samples' uniform
+   points in the box between the ideal point of the set and ref. The
+   samples come from a generator seeded with 'seed', so calls with the
+   same seed and box use the same samples and differences between sets
+   are not masked by the sampling noise. The standard error is about
+   box volume * sqrt(p (1 - p) / samples), p = hypervolume / box volume. */
+double hypervolume_exact(int n, int dim, double** f, const double* ref);
+double hypervolume_mc(int n, int dim, double** f, const double* ref,
+		      int samples, unsigned long long seed);
+
+/* Inverted generational distance: mean Euclidean distance from each of
+   the n_ref points of the reference front r to the closest point of
+   the set. Returns -1 if the set is empty. */
+double igd(int n, int dim, double** f, int n_ref, double** r);
+
+/* Generalized spread (Zhou, Jin, Zhang, Sendhoff and Tsang, CEC 2006):
+   (sum_d e_d + sum_i |d_i - mean d|) / (sum_d e_d + n mean d), where
+   d_i is the distance of point i to its nearest neighbor in the set and
+   e_d the distance of the extreme reference point in objective d (the
+   one with the smallest value) to the set. Without a reference front
+   (n_ref = 0) the e_d terms are left out. 0 for evenly spaced points.
+   Returns -1 for fewer than two points. */
+double spread(int n, int dim, double** f, int n_ref, double** r);
+
+#endif /* METRICS_HPP */
@@ -0,0 +1,282 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Non-dominated sorting shared by the APISA selectors.
+
+  The sweeps for one to three objectives follow
+    M. T. Jensen, "Reducing the run-time complexity of multiobjective
+    EAs: The NSGA-II and other algorithms", IEEE Trans. Evol. Comp. 7,
+    503-515 (2003).
+  Infeasible individuals are ranked with the domination count algorithm of
+    K. Deb et al., "A fast and elitist multiobjective genetic algorithm:
+    NSGA-II", IEEE Trans. Evol. Comp. 6, 182-197 (2002).
+
+  file: nd_sort.cpp
+  ========================================================================
+*/
+
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "nd_sort.hpp"
+
+using namespace std;
+
+namespace {
+
+/*-------------------------| dominance tests |---------------------------*/
+
+bool is_feasible(const double* c, int con)
+{
+  for(int j = 0; j < con; ++j) if(c[j] < 0) return false;
+  return true;
+}
+
+
+/* Constraint dominance of two infeasible individuals.
+   Same as the infeasible branch of con_dominates() in the selectors. */
+struct ConDominates {
+  double** c;
+  int con;
+  bool operator()(int a, int b) const {
+    bool is_better = false;
+    for(int j = 0; j < con; ++j) {
+      if((c[a][j] >= 0) && (c[b][j] >= 0)) continue;
+      if(c[a][j] < c[b][j]) return false;
+      else if(c[a][j] > c[b][j]) is_better = true;
+    }
+    return is_better;
+  }
+};
+
+
+/* Lexicographic order of the objective vectors. */
+struct LexLess {
+  double** f;
+  int dim;
+  bool operator()(int a, int b) const {
+    for(int i = 0; i < dim; i++) {
+      if(f[a][i] < f[b][i]) return true;
+      if(f[a][i] > f[b][i]) return false;
+    }
+    return a < b;
+  }
+};
+
+
+bool same_point(const double* a, const double* b, int dim)
+{
+  for(int i = 0; i < dim; i++) if(a[i] != b[i]) return false;
+  return true;
+}
+
+/*-----------------------| domination count sort |-----------------------*/
+
+/* Ranks the individuals in 'idx' starting at front 'rank0'.
+   Returns the rank following the last front. */
+
+template <class Dom> int count_sort(const vector<int>& idx, Dom dom, int* rank, int rank0)
+{
+  int n = idx.size();
+  vector<int> count(n, 0);
+  vector< vector<int> > dominated(n);
+  vector<int> current, next;
+
+  for(int i = 0; i < n; i++) {
+    for(int j = i + 1; j < n; j++) {
+      if(dom(idx[i], idx[j])) {
+	dominated[i].push_back(j);
+	count[j]++;
+      }
+      else if(dom(idx[j], idx[i])) {
+	dominated[j].push_back(i);
+	count[i]++;
+      }
+    }
+  }
+
+  for(int i = 0; i < n; i++) if(count[i] == 0) current.push_back(i);
+
+  int r = rank0;
+  while(!current.empty()) {
+    next.clear();
+    for(size_t k = 0; k < current.size(); k++) {
+      int p = current[k];
+      rank[idx[p]] = r;
+      for(size_t m = 0; m < dominated[p].size(); m++) {
+	int q = dominated[p][m];
+	if(--count[q] == 0) next.push_back(q);
+      }
+    }
+    current.swap(next);
+    r++;
+  }
+
+  return r;
+}
+
+/*----------------------------| sweeps |---------------------------------*/
+
+/* In lexicographic order an individual can only be dominated by one
+   that comes before it. Moreover, if it is dominated by a member of
+   front k then it is dominated by a member of every front before k.
+   Its rank is therefore the first front that does not dominate it,
+   which is found by binary search. Identical objective vectors are
+   adjacent and get the same rank. */
+
+/* One or two objectives: front k dominates a point iff the smallest
+   last objective seen in front k is <= that of the point. */
+
+int sweep2(vector<int>& idx, double** f, int dim, int* rank)
+{
+  LexLess less = {f, dim};
+  sort(idx.begin(), idx.end(), less);
+
+  int d = dim - 1;
+  vector<double> tail;
+
+  for(size_t k = 0; k < idx.size(); ) {
+    int p = idx[k];
+    int r = upper_bound(tail.begin(), tail.end(), f[p][d]) - tail.begin();
+    if(r == (int)tail.size()) tail.push_back(f[p][d]);
+    else tail[r] = f[p][d];
+
+    for(; k < idx.size() && same_point(f[idx[k]], f[p], dim); k++)
+      rank[idx[k]] = r;
+  }
+
+  return tail.size();
+}
+
+
+/* Three objectives: each front keeps the staircase of its points
+   projected on objectives 2 and 3 (map from f[1] to f[2], f[2]
+   decreasing). */
+
+typedef map<double, double> Staircase;
+
+bool stair_dominates(const Staircase& st, double a, double b)
+{
+  Staircase::const_iterator it = st.upper_bound(a);
+  if(it == st.begin()) return false;
+  --it;
+  return it->second <= b;
+}
+
+
+void stair_insert(Staircase& st, double a, double b)
+{
+  Staircase::iterator it = st.lower_bound(a);
+  while(it != st.end() && it->second >= b) st.erase(it++);
+  st[a] = b;
+}
+
+
+int sweep3(vector<int>& idx, double** f, int* rank)
+{
+  LexLess less = {f, 3};
+  sort(idx.begin(), idx.end(), less);
+
+  vector<Staircase> stair;
+
+  for(size_t k = 0; k < idx.size(); ) {
+    int p = idx[k];
+    double a = f[p][1], b = f[p][2];
+
+    int lo = 0, hi = stair.size();
+    while(lo < hi) {
+      int mid = (lo + hi) / 2;
+      if(stair_dominates(stair[mid], a, b)) lo = mid + 1;
+      else hi = mid;
+    }
+
+    if(lo == (int)stair.size()) stair.push_back(Staircase());
+    stair_insert(stair[lo], a, b);
+
+    for(; k < idx.size() && same_point(f[idx[k]], f[p], 3); k++)
+      rank[idx[k]] = lo;
+  }
+
+  return stair.size();
+}
+
+
+/* Four or more objectives: each front keeps a list of its members which
+   is searched for a dominating point (efficient non-dominated sort with
+   binary search, Zhang et al., IEEE Trans. Evol. Comp. 19, 201 (2015)).
+   Since members come before the point in lexicographic order, only
+   objectives 2 to dim need to be compared. */
+
+bool list_dominates(const vector<int>& members, double** f, int dim, int p)
+{
+  for(int m = members.size() - 1; m >= 0; m--) {
+    const double* q = f[members[m]];
+    int i = 1;
+    while(i < dim && q[i] <= f[p][i]) i++;
+    if(i == dim) return true;
+  }
+  return false;
+}
+
+
+int sweep_ens(vector<int>& idx, double** f, int dim, int* rank)
+{
+  LexLess less = {f, dim};
+  sort(idx.begin(), idx.end(), less);
+
+  vector< vector<int> > members;
+
+  for(size_t k = 0; k < idx.size(); ) {
+    int p = idx[k];
+
+    int lo = 0, hi = members.size();
+    while(lo < hi) {
+      int mid = (lo + hi) / 2;
+      if(list_dominates(members[mid], f, dim, p)) lo = mid + 1;
+      else hi = mid;
+    }
+
+    if(lo == (int)members.size()) members.push_back(vector<int>());
+    members[lo].push_back(p);
+
+    for(; k < idx.size() && same_point(f[idx[k]], f[p], dim); k++)
+      rank[idx[k]] = lo;
+  }
+
+  return members.size();
+}
+
+} /* namespace */
+
+/*---------------------------| nd_sort |---------------------------------*/
+
+int nd_sort(int size, int dim, int con, double** f, double** c, int* rank)
+{
+  vector<int> feasible, infeasible;
+
+  for(int i = 0; i < size; i++) {
+    if(is_feasible(c[i], con)) feasible.push_back(i);
+    else infeasible.push_back(i);
+  }
+
+  /* feasible individuals come first */
+  int n_front = 0;
+  if(!feasible.empty()) {
+    if(dim <= 2) n_front = sweep2(feasible, f, dim, rank);
+    else if(dim == 3) n_front = sweep3(feasible, f, rank);
+    else n_front = sweep_ens(feasible, f, dim, rank);
+  }
+
+  /* infeasible individuals are dominated by all feasible ones */
+  if(!infeasible.empty()) {
+    ConDominates dom = {c, con};
+    n_front = count_sort(infeasible, dom, rank, n_front);
+  }
+
+  return n_front;
+}
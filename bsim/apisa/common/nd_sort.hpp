@@ -0,0 +1,37 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Non-dominated sorting shared by the APISA selectors.
+
+  file: nd_sort.hpp
+  ========================================================================
+*/
+
+#ifndef ND_SORT_HPP
+#define ND_SORT_HPP
+
+/* Sorts 'size' individuals into non-dominated fronts.
+
+   f[i] (dim values) and c[i] (con values) are the objective and
+   constraint vectors of individual i. Objectives are minimized and
+   constraints are of the form g(x) >= 0. The dominance relation is the
+   same as con_dominates() in the selectors: a feasible individual
+   dominates every infeasible one, feasible individuals are compared by
+   Pareto dominance and infeasible individuals by their constraint
+   violations.
+
+   On return rank[i] is the (0 based) front of individual i and the
+   number of fronts is returned.
+
+   Feasible individuals are sorted with an O(N log N) sweep for one or
+   two objectives and an O(N log^2 N) sweep for three objectives. For
+   more objectives a sweep with a linear search of each front is used
+   (O(M N^2) worst case, much less in practice). Infeasible individuals
+   are sorted with Deb's domination count algorithm, O(con N^2). */
+
+int nd_sort(int size, int dim, int con, double** f, double** c, int* rank);
+
+#endif /* ND_SORT_HPP */
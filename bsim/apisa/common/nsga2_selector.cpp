@@ -0,0 +1,255 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  NSGA2
+
+  Implements the selection.
+
+  file: nsga2_selector.cpp
+  author: Marco Laumanns, laumanns@tik.ee.ethz.ch
+
+  revision by:  Stefan Bleuler, bleuler@tik.ee.ethz.ch
+  rewritten by: Ivan Bazarov, bazarov@cornell.edu
+  ========================================================================
+*/
+
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#include "nsga2_selector.hpp"
+#include "nd_sort.hpp"
+
+#ifdef _OPENMP
+#define OMP_PRAGMA(directive) _Pragma(#directive)
+#else
+#define OMP_PRAGMA(directive)
+#endif
+
+#define PISA_MAXDOUBLE 1E99  /* Internal maximal value for double */
+
+typedef ApisaSelector::ind ind;
+
+
+Nsga2Selector::Nsga2Selector(int alpha, int mu, int lambda, int dim, int con,
+			     int seed, int tournament)
+  : ApisaSelector(alpha, mu, lambda, dim, con, seed, tournament), n_call(0)
+{
+}
+
+/*-----------------------| selection functions|--------------------------*/
+
+void Nsga2Selector::selection()
+{
+  int size;
+  
+  /* Join offspring individuals from variator to population */
+  mergeOffspring();
+  
+  size = pp_all->size;
+  
+  /* Create internal data structures for selection process */
+  /* Vectors */
+  copies = (int*) chk_malloc(size * sizeof(int));
+  dist = (double*) chk_malloc(size * sizeof(double));
+  
+  /* Fronts. Row l of 'front' points into one block of 'size' entries
+     (set in calcFitnesses) */
+  front = (int**) chk_malloc(size * sizeof(int*));
+  front[0] = (int*) chk_malloc(size * sizeof(int));
+  
+  /* Calculates NSGA2 fitness values for all individuals */
+  calcFitnesses();
+  phase("fitness");
+
+  /* Calculates distance cuboids */
+  calcDistances();
+  phase("crowding");
+
+  /* Performs environmental selection
+     (truncates 'pp_all' to size 'alpha') */
+  environmentalSelection();
+  phase("environmental");
+  
+  /* Performs mating selection
+     (fills mating pool / offspring population pp_sel */
+  matingSelection();
+  phase("mating");
+  
+  /* Frees memory of internal data structures */    
+  free(copies);
+  free(dist);
+  free(front[0]);
+  free(front);
+  
+  return;
+}
+
+
+void Nsga2Selector::calcFitnesses()
+/* Sorts 'pp_all' into non-dominated fronts. Fills 'front' and 'copies'
+   and sets the fitness of each individual to its front number. */
+{
+  int i, l;
+  int size;
+  int n_front;
+  int *rank;
+  double **f, **c;
+  
+  size = pp_all->size;
+  rank = (int*) chk_malloc(size * sizeof(int));
+  f = (double**) chk_malloc(size * sizeof(double*));
+  c = (double**) chk_malloc(size * sizeof(double*));
+  
+  for(i = 0; i < size; i++) {
+    f[i] = pp_all->ind_array[i]->f;
+    c[i] = pp_all->ind_array[i]->c;
+    copies[i] = 0;
+  }
+  
+  n_front = nd_sort(size, dim, con, f, c, rank);
+  
+  for(i = 0; i < size; i++) {
+    pp_all->ind_array[i]->fitness = rank[i];
+    copies[rank[i]] += 1;
+  }
+  
+  /* lay the fronts out one after the other, members in index order */
+  for(l = 1; l < size; l++)
+    front[l] = front[l-1] + (l <= n_front ? copies[l-1] : 0);
+  
+  for(l = 0; l < n_front; l++) copies[l] = 0;
+  for(i = 0; i < size; i++) {
+    l = rank[i];
+    front[l][copies[l]] = i;
+    copies[l] += 1;
+  }
+  
+  free(rank);
+  free(f);
+  free(c);
+  return;
+}
+
+/* Orders indices of 'pp_all' by objective d. */
+struct ObjectiveLess {
+  ind** ind_array;
+  int d;
+  bool operator()(int a, int b) const {
+    return ind_array[a]->f[d] < ind_array[b]->f[d];
+  }
+};
+
+
+/* Orders individuals by fitness. Ties are broken by index so the
+   result does not depend upon the sort algorithm. */
+struct FitnessLess {
+  bool operator()(const ind* a, const ind* b) const {
+    if(a->fitness != b->fitness) return a->fitness < b->fitness;
+    return a->index < b->index;
+  }
+};
+
+
+void Nsga2Selector::calcDistances()
+/* Crowding distances. The members of each front are index sorted by
+   each objective. Objectives are done in parallel, each with its own
+   distance array, and the contributions are summed afterwards in
+   objective order so the result does not depend on the number of
+   threads. */
+{
+  int i, d;
+  int size = pp_all->size;
+  double dmax = PISA_MAXDOUBLE / (dim + 1);
+  double* dist_obj = (double*) chk_malloc(dim * size * sizeof(double));
+  
+  OMP_PRAGMA(omp parallel for schedule(dynamic))
+  for(d = 0; d < dim; d++) {
+    ObjectiveLess less = {pp_all->ind_array, d};
+    double* dd = dist_obj + d * size;
+    int* order = (int*) chk_malloc(size * sizeof(int));
+    
+    for(int l = 0; l < size && copies[l] > 0; l++) {
+      int n = copies[l];
+      memcpy(order, front[l], n * sizeof(int));
+      std::stable_sort(order, order + n, less);
+      
+      for(int k = 0; k < n; k++) {
+	if (k == 0 || k == n - 1)
+	  dd[order[k]] = dmax;
+	else
+	  dd[order[k]] = pp_all->ind_array[order[k+1]]->f[d] -
+	    pp_all->ind_array[order[k-1]]->f[d];
+      }
+    }
+    
+    free(order);
+  }
+  
+  for(i = 0; i < size; i++) {
+    dist[i] = 1;
+    for(d = 0; d < dim; d++) dist[i] += dist_obj[d * size + i];
+  }
+  
+  free(dist_obj);
+}
+
+
+void Nsga2Selector::environmentalSelection()
+/* Keeps the 'alpha' individuals with the lowest fitness (front number
+   plus inverse crowding distance), ordered by fitness. */
+{
+  int i;
+  int size = pp_all->size;
+  int n_keep = alpha < size ? alpha : size;
+  ind** ia = pp_all->ind_array;
+  
+  char tmp [1024];
+  sprintf(tmp, " nsga2: #%d population size (%d)\n", ++n_call, size);
+  diag(tmp);
+  
+  for(i = 0; i < size; i++)
+    ia[i]->fitness += 1.0 / dist[i];
+  
+  std::nth_element(ia, ia + n_keep, ia + size, FitnessLess());
+  std::sort(ia, ia + n_keep, FitnessLess());
+    
+  for(i = n_keep; i < size; i++) {
+    free_ind(ia[i]);
+    ia[i] = NULL;
+  }
+  
+  pp_all->size = n_keep;
+  
+  return;
+}
+
+
+void Nsga2Selector::matingSelection()
+/* Fills mating pool 'pp_sel' */
+{
+  int i, j;
+  
+  for(i = 0; i < mu; i++) {
+    int winner = irand(pp_all->size);
+    
+    for(j = 1; j < tournament; j++) {
+      int opponent = irand(pp_all->size);
+      if (pp_all->ind_array[opponent]->fitness
+	  < pp_all->ind_array[winner]->fitness || winner == opponent) {
+	winner = opponent;
+      }
+    }  
+    pp_sel->ind_array[i] = pp_all->ind_array[winner];
+  }
+  pp_sel->size = mu;
+}
@@ -0,0 +1,39 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  NSGA2 selector (see apisa_selector.hpp).
+
+  file: nsga2_selector.hpp
+  ========================================================================
+*/
+
+#ifndef NSGA2_SELECTOR_HPP
+#define NSGA2_SELECTOR_HPP
+
+#include "apisa_selector.hpp"
+
+class Nsga2Selector : public ApisaSelector {
+public:
+  Nsga2Selector(int alpha, int mu, int lambda, int dim, int con, int seed, int tournament);
+
+protected:
+  void selection();
+
+private:
+  /* internal data of one selection */
+  int* copies;  /* copies[l] = size of front l */
+  int** front;  /* front[l] = members of front l */
+  double* dist; /* crowding distances */
+
+  int n_call;   /* call number for diagnostics purposes */
+
+  void calcFitnesses();
+  void calcDistances();
+  void environmentalSelection();
+  void matingSelection();
+};
+
+#endif /* NSGA2_SELECTOR_HPP */
@@ -0,0 +1,408 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  NSGA3
+
+  Implements the selection.
+
+  file: nsga3_selector.cpp
+  ========================================================================
+*/
+
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include "nsga3_selector.hpp"
+#include "nd_sort.hpp"
+
+typedef ApisaSelector::ind ind;
+
+namespace {
+
+/* Orders individuals by fitness (front number) and then by index, so
+   each front is contiguous and in index order. */
+struct FitnessLess {
+  bool operator()(const ind* a, const ind* b) const {
+    if(a->fitness != b->fitness) return a->fitness < b->fitness;
+    return a->index < b->index;
+  }
+};
+
+
+/* Orders members of a niche by their distance from the direction. */
+struct DistanceLess {
+  const double* d;
+  bool operator()(int a, int b) const {
+    if(d[a] != d[b]) return d[a] < d[b];
+    return a < b;
+  }
+};
+
+
+/* Number of Das and Dennis points, C(divisions + dim - 1, dim - 1). */
+double n_directions(int dim, int divisions)
+{
+  double n = 1;
+  for(int i = 1; i < dim; i++) n = n * (divisions + i) / i;
+  return n;
+}
+
+
+/* Appends all k[pos..dim-1] >= 0 with sum 'left' as points
+   scale * k / divisions + (1 - scale) / dim. */
+void compositions(int dim, int divisions, double scale, int pos, int left,
+		  std::vector<int>& k, std::vector<double>& points)
+{
+  if(pos == dim - 1) {
+    k[pos] = left;
+    for(int d = 0; d < dim; d++)
+      points.push_back(scale * k[d] / divisions + (1 - scale) / dim);
+    return;
+  }
+  for(int m = left; m >= 0; m--) {
+    k[pos] = m;
+    compositions(dim, divisions, scale, pos + 1, left - m, k, points);
+  }
+}
+
+
+/* Solves a x = 1 for the n x n matrix a (rows), by Gaussian elimination
+   with partial pivoting. Returns false if a is (nearly) singular. */
+bool solve_ones(int n, std::vector<double> a, std::vector<double>& x)
+{
+  std::vector<double> b(n, 1.0);
+  double scale = 0;
+  for(int i = 0; i < n * n; i++) scale = std::max(scale, fabs(a[i]));
+  if(scale == 0) return false;
+
+  for(int col = 0; col < n; col++) {
+    int p = col;
+    for(int r = col + 1; r < n; r++)
+      if(fabs(a[r*n + col]) > fabs(a[p*n + col])) p = r;
+    if(fabs(a[p*n + col]) < 1e-12 * scale) return false;
+    if(p != col) {
+      for(int j = 0; j < n; j++) std::swap(a[p*n + j], a[col*n + j]);
+      std::swap(b[p], b[col]);
+    }
+    for(int r = col + 1; r < n; r++) {
+      double m = a[r*n + col] / a[col*n + col];
+      for(int j = col; j < n; j++) a[r*n + j] -= m * a[col*n + j];
+      b[r] -= m * b[col];
+    }
+  }
+
+  x.assign(n, 0);
+  for(int r = n - 1; r >= 0; r--) {
+    double s = b[r];
+    for(int j = r + 1; j < n; j++) s -= a[r*n + j] * x[j];
+    x[r] = s / a[r*n + r];
+  }
+  return true;
+}
+
+} /* namespace */
+
+
+Nsga3Selector::Nsga3Selector(int alpha, int mu, int lambda, int dim, int con,
+			     int seed, int tournament, int divisions, int divisions_inner)
+  : ApisaSelector(alpha, mu, lambda, dim, con, seed, tournament), n_call(0)
+{
+  if(divisions <= 0) {
+    divisions = 1;
+    while(dim > 1 && n_directions(dim, divisions + 1) <= alpha) divisions++;
+  }
+
+  das_dennis(dim, divisions, 1.0, ref);
+  if(divisions_inner > 0) das_dennis(dim, divisions_inner, 0.5, ref);
+  n_ref = ref.size() / dim;
+
+  for(int j = 0; j < n_ref; j++) {
+    double* w = &ref[j * dim];
+    double norm = 0;
+    for(int d = 0; d < dim; d++) norm += w[d] * w[d];
+    norm = sqrt(norm);
+    for(int d = 0; d < dim; d++) w[d] /= norm;
+  }
+}
+
+
+int Nsga3Selector::reference_size() const
+{
+  return(n_ref);
+}
+
+
+void Nsga3Selector::das_dennis(int dim, int divisions, double scale, std::vector<double>& points)
+/* Appends the points with 'divisions' steps on each edge of the unit
+   simplex, scaled by 'scale' towards its center. */
+{
+  std::vector<int> k(dim);
+  compositions(dim, divisions, scale, 0, divisions, k, points);
+}
+
+/*-----------------------| selection functions|--------------------------*/
+
+void Nsga3Selector::selection()
+{
+  /* Join offspring individuals from variator to population */
+  mergeOffspring();
+
+  /* Sorts 'pp_all' into fronts and finds the last front to keep */
+  calcFitnesses();
+  phase("fitness");
+
+  /* Normalizes the objectives of the candidates */
+  normalize();
+  phase("normalization");
+
+  /* Performs environmental selection
+     (truncates 'pp_all' to size 'alpha') */
+  environmentalSelection();
+  phase("niching");
+
+  /* Performs mating selection
+     (fills mating pool / offspring population pp_sel */
+  matingSelection();
+  phase("mating");
+
+  return;
+}
+
+
+void Nsga3Selector::calcFitnesses()
+/* Sorts 'pp_all' into non-dominated fronts (fitness = front number) and
+   orders it by front. Sets n_sure and n_cand: the fronts before
+   n_sure are all kept and the last one, up to n_cand, only in part. */
+{
+  int i, j;
+  int size = pp_all->size;
+  ind** ia = pp_all->ind_array;
+  int* rank = (int*) chk_malloc(size * sizeof(int) + 1);
+  double** f = (double**) chk_malloc(size * sizeof(double*) + 1);
+  double** c = (double**) chk_malloc(size * sizeof(double*) + 1);
+
+  for(i = 0; i < size; i++) {
+    f[i] = ia[i]->f;
+    c[i] = ia[i]->c;
+  }
+
+  if(size > 0) nd_sort(size, dim, con, f, c, rank);
+
+  for(i = 0; i < size; i++) ia[i]->fitness = rank[i];
+  std::sort(ia, ia + size, FitnessLess());
+
+  n_sure = n_cand = size;
+  for(i = 0; i < size && size > alpha; i = j) {
+    for(j = i; j < size && ia[j]->fitness == ia[i]->fitness; j++);
+    if(j == alpha) {
+      n_sure = n_cand = alpha;
+      break;
+    }
+    if(j > alpha) {
+      n_sure = i;
+      n_cand = j;
+      break;
+    }
+  }
+
+  free(rank);
+  free(f);
+  free(c);
+  return;
+}
+
+
+void Nsga3Selector::normalize()
+/* Normalized objectives fn of the first n_cand individuals if the last
+   front is thinned by niching: translated by the ideal point and divided
+   by the intercepts of the hyperplane through the extreme points on the
+   axes. If the hyperplane is degenerate the worst values of the first
+   front are used instead. */
+{
+  int i, d, k;
+  ind** ia = pp_all->ind_array;
+  int n = n_cand;
+
+  fn.clear();
+  if(n_cand <= alpha || !is_feasible(ia[n_sure])) return;
+
+  std::vector<double> ideal(ia[0]->f, ia[0]->f + dim);
+  for(i = 1; i < n; i++)
+    for(d = 0; d < dim; d++) ideal[d] = std::min(ideal[d], ia[i]->f[d]);
+
+  fn.resize(n * dim);
+  for(i = 0; i < n; i++)
+    for(d = 0; d < dim; d++) fn[i*dim + d] = ia[i]->f[d] - ideal[d];
+
+  /* extreme point of axis d: smallest achievement scalarizing function
+     max_k fn_k / w_k with w_d = 1 and w_k = 1e-6 otherwise */
+  std::vector<double> extreme(dim * dim);
+  for(d = 0; d < dim; d++) {
+    int best = 0;
+    double best_asf = HUGE_VAL;
+    for(i = 0; i < n; i++) {
+      double asf = 0;
+      for(k = 0; k < dim; k++)
+	asf = std::max(asf, fn[i*dim + k] * (k == d ? 1 : 1e6));
+      if(asf < best_asf) {
+	best_asf = asf;
+	best = i;
+      }
+    }
+    for(k = 0; k < dim; k++) extreme[d*dim + k] = fn[best*dim + k];
+  }
+
+  std::vector<double> b, intercept(dim);
+  bool ok = solve_ones(dim, extreme, b);
+  for(d = 0; d < dim && ok; d++) {
+    intercept[d] = 1 / b[d];
+    ok = b[d] > 0 && intercept[d] > 1e-6 && intercept[d] < HUGE_VAL;
+  }
+  if(!ok) {
+    for(d = 0; d < dim; d++) {
+      intercept[d] = 0;
+      for(i = 0; i < n && ia[i]->fitness == ia[0]->fitness; i++)
+	intercept[d] = std::max(intercept[d], fn[i*dim + d]);
+      if(intercept[d] <= 1e-10) intercept[d] = 1;
+    }
+  }
+
+  for(i = 0; i < n; i++)
+    for(d = 0; d < dim; d++) fn[i*dim + d] /= intercept[d];
+}
+
+
+void Nsga3Selector::associate()
+/* Associates each of the first n_cand individuals with the reference
+   direction closest to its normalized objective vector. */
+{
+  niche.assign(n_cand, 0);
+  niche_d.assign(n_cand, 0);
+
+  for(int i = 0; i < n_cand; i++) {
+    const double* s = &fn[i * dim];
+    double ss = 0;
+    for(int d = 0; d < dim; d++) ss += s[d] * s[d];
+
+    double best = HUGE_VAL;
+    for(int j = 0; j < n_ref; j++) {
+      const double* w = &ref[j * dim];
+      double dot = 0;
+      for(int d = 0; d < dim; d++) dot += s[d] * w[d];
+      double d2 = ss - dot * dot;  /* squared distance from the line */
+      if(d2 < best) {
+	best = d2;
+	niche[i] = j;
+      }
+    }
+    niche_d[i] = sqrt(std::max(0.0, best));
+  }
+}
+
+
+void Nsga3Selector::environmentalSelection()
+/* Keeps the fronts before n_sure and fills the archive up to 'alpha'
+   from the last front: by niching if it is feasible, else by the
+   smallest total constraint violation. */
+{
+  int i;
+  int size = pp_all->size;
+  ind** ia = pp_all->ind_array;
+  std::vector<char> keep(size, 0);
+
+  char tmp [1024];
+  sprintf(tmp, " nsga3: #%d population size (%d), %d of last front (%d)\n",
+	  ++n_call, size, (n_cand > alpha ? alpha : n_cand) - n_sure, n_cand - n_sure);
+  diag(tmp);
+
+  for(i = 0; i < n_sure; i++) keep[i] = 1;
+
+  if(n_cand <= alpha) {
+    for(i = n_sure; i < n_cand; i++) keep[i] = 1;
+  }
+  else if(!fn.empty()) {
+    int k = alpha - n_sure;
+    associate();
+
+    /* niche counts of the sure fronts and candidates of each direction */
+    std::vector<int> count(n_ref, 0);
+    std::vector<std::vector<int> > members(n_ref);
+    for(i = 0; i < n_sure; i++) count[niche[i]]++;
+    for(i = n_sure; i < n_cand; i++) members[niche[i]].push_back(i);
+    DistanceLess closer = {&niche_d[0]};
+    for(int j = 0; j < n_ref; j++)
+      std::sort(members[j].begin(), members[j].end(), closer);
+
+    while(k > 0) {
+      /* least crowded direction with candidates left, ties at random */
+      int best = -1, n_tie = 0;
+      for(int j = 0; j < n_ref; j++) {
+	if(members[j].empty()) continue;
+	if(best < 0 || count[j] < count[best]) {
+	  best = j;
+	  n_tie = 1;
+	}
+	else if(count[j] == count[best] && irand(++n_tie) == 0) best = j;
+      }
+      assert(best >= 0);
+
+      /* the closest candidate for an empty niche, else any */
+      std::vector<int>& m = members[best];
+      int pick = count[best] == 0 ? 0 : irand(m.size());
+      keep[m[pick]] = 1;
+      m.erase(m.begin() + pick);
+      count[best]++;
+      k--;
+    }
+  }
+  else {
+    std::vector<std::pair<double, int> > violation;
+    for(i = n_sure; i < n_cand; i++) {
+      double v = 0;
+      for(int j = 0; j < con; j++) if(ia[i]->c[j] < 0) v -= ia[i]->c[j];
+      violation.push_back(std::make_pair(v, i));
+    }
+    std::sort(violation.begin(), violation.end());
+    for(i = 0; i < alpha - n_sure; i++) keep[violation[i].second] = 1;
+  }
+
+  int new_size = 0;
+  for(i = 0; i < size; i++) {
+    if(keep[i]) ia[new_size++] = ia[i];
+    else free_ind(ia[i]);
+  }
+  for(i = new_size; i < size; i++) ia[i] = NULL;
+  pp_all->size = new_size;
+
+  return;
+}
+
+
+void Nsga3Selector::matingSelection()
+/* Fills mating pool 'pp_sel' by tournaments on the front number. */
+{
+  int i, j;
+
+  for(i = 0; i < mu; i++) {
+    int winner = irand(pp_all->size);
+
+    for(j = 1; j < tournament; j++) {
+      int opponent = irand(pp_all->size);
+      if (pp_all->ind_array[opponent]->fitness
+	  < pp_all->ind_array[winner]->fitness) {
+	winner = opponent;
+      }
+    }
+    pp_sel->ind_array[i] = pp_all->ind_array[winner];
+  }
+  pp_sel->size = mu;
+}
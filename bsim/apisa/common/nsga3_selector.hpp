@@ -0,0 +1,65 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  NSGA3 selector (see apisa_selector.hpp).
+
+  NSGA-III (K. Deb and H. Jain, IEEE TEC 18, 577, 2014): the archive is
+  filled front by front as in NSGA2, but the last front that fits only
+  in part is thinned by niching on a set of reference directions
+  instead of the crowding distance, which keeps the selection pressure
+  towards a spread front for four and more objectives.
+
+  file: nsga3_selector.hpp
+  ========================================================================
+*/
+
+#ifndef NSGA3_SELECTOR_HPP
+#define NSGA3_SELECTOR_HPP
+
+#include <vector>
+
+#include "apisa_selector.hpp"
+
+class Nsga3Selector : public ApisaSelector {
+public:
+  /* divisions: the reference directions are the Das and Dennis points
+     with 'divisions' steps along each edge of the unit simplex, 0 =>
+     the most steps that give at most alpha directions.
+     divisions_inner > 0 adds a second layer with that many steps, shrunk
+     by half towards the center of the simplex (for many objectives,
+     where one layer has either too few or no inner points). */
+  Nsga3Selector(int alpha, int mu, int lambda, int dim, int con, int seed,
+		int tournament, int divisions, int divisions_inner);
+
+  /* Number of reference directions. */
+  int reference_size() const;
+
+protected:
+  void selection();
+
+private:
+  std::vector<double> ref;  /* reference directions, dim values each,
+			       scaled to unit length */
+  int n_ref;
+
+  /* internal data of one selection */
+  int n_sure;     /* the fronts before the last one that fits in part */
+  int n_cand;     /* ... and with the last front */
+  std::vector<double> fn;      /* normalized objectives of the first n_cand */
+  std::vector<int> niche;      /* reference direction of individual i */
+  std::vector<double> niche_d; /* and its distance from it */
+
+  int n_call;   /* call number for diagnostics purposes */
+
+  static void das_dennis(int dim, int divisions, double scale, std::vector<double>& points);
+  void calcFitnesses();
+  void normalize();
+  void associate();
+  void environmentalSelection();
+  void matingSelection();
+};
+
+#endif /* NSGA3_SELECTOR_HPP */
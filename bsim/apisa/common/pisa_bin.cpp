@@ -0,0 +1,248 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Binary format of the PISA data files.
+
+  file: pisa_bin.cpp
+  ========================================================================
+*/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "pisa_bin.hpp"
+
+using namespace std;
+
+namespace {
+
+const char magic_pop[8] = {'A', 'P', 'I', 'S', 'A', 'P', 'O', 'P'};
+const char magic_index[8] = {'A', 'P', 'I', 'S', 'A', 'I', 'D', 'X'};
+const uint32_t byte_order = 0x01020304;
+
+struct PisaBinHeader {
+  char magic[8];
+  uint32_t version;      /* PISA_BIN_VERSION of the writer */
+  uint32_t byte_order;   /* 0x01020304 in the byte order of the writer */
+  uint32_t header_size;  /* offset of the data, may grow in later versions */
+  uint32_t dim, con;     /* objective and constraint blocks */
+  uint32_t reserved;
+  uint64_t rows;         /* individuals or indices */
+  uint64_t data_size;    /* bytes after the header */
+  uint64_t checksum;     /* see checksum() */
+};
+
+
+/* Bytes of the index block, padded so the double blocks are aligned. */
+size_t index_bytes(size_t rows)
+{
+  return (rows * sizeof(int32_t) + 7) / 8 * 8;
+}
+
+
+/* 64 bit FNV-1a over the data as 64 bit words (the data size is a
+   multiple of 8). */
+uint64_t checksum(const char* data, size_t n)
+{
+  uint64_t h = 14695981039346656037ULL;
+  for(size_t k = 0; k + 8 <= n; k += 8) {
+    uint64_t w;
+    memcpy(&w, data + k, 8);
+    h = (h ^ w) * 1099511628211ULL;
+  }
+  return h;
+}
+
+
+/* Writes header and data to '<filename>.tmp' and renames it. */
+int write_file(const char* filename, const char* magic, uint32_t dim, uint32_t con,
+	       uint64_t rows, vector<char>& data)
+{
+  PisaBinHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, magic, 8);
+  h.version = PISA_BIN_VERSION;
+  h.byte_order = byte_order;
+  h.header_size = sizeof(h);
+  h.dim = dim;
+  h.con = con;
+  h.rows = rows;
+  h.data_size = data.size();
+  h.checksum = checksum(data.empty() ? NULL : &data[0], data.size());
+
+  string tmp = string(filename) + ".tmp";
+  FILE* fp = fopen(tmp.c_str(), "wb");
+  if(fp == NULL) return -1;
+  bool ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+  if(ok && !data.empty()) ok = fwrite(&data[0], data.size(), 1, fp) == 1;
+  ok = (fclose(fp) == 0) && ok;
+  if(!ok || rename(tmp.c_str(), filename) != 0) {
+    remove(tmp.c_str());
+    return -1;
+  }
+  return 0;
+}
+
+
+/* A read-only view of a whole file, mapped if possible. */
+class FileView {
+public:
+  const char* data;
+  size_t size;
+
+  explicit FileView(const char* filename) : data(NULL), size(0), mapped(NULL)
+  {
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) return;
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(p != MAP_FAILED) {
+	mapped = p;
+	data = (const char*)p;
+	size = st.st_size;
+      }
+    }
+    close(fd);
+#else
+    FILE* fp = fopen(filename, "rb");
+    if(fp == NULL) return;
+    char buf[65536];
+    size_t n;
+    while((n = fread(buf, 1, sizeof(buf), fp)) > 0) copy.insert(copy.end(), buf, buf + n);
+    fclose(fp);
+    if(!copy.empty()) {
+      data = &copy[0];
+      size = copy.size();
+    }
+#endif
+  }
+
+  ~FileView()
+  {
+#ifndef _WIN32
+    if(mapped != NULL) munmap(mapped, size);
+#endif
+  }
+
+private:
+  void* mapped;
+  vector<char> copy;
+
+  FileView(const FileView&);
+  FileView& operator=(const FileView&);
+};
+
+
+/* The header of a valid file of the given kind, NULL otherwise. */
+const PisaBinHeader* check_file(const FileView& file, const char* magic)
+{
+  if(file.size < sizeof(PisaBinHeader)) return NULL;
+  const PisaBinHeader* h = (const PisaBinHeader*)file.data;
+  if(memcmp(h->magic, magic, 8) != 0) return NULL;
+  if(h->byte_order != byte_order) {
+    fprintf(stderr, "PISA binary file: wrong byte order\n");
+    return NULL;
+  }
+  if(h->version > PISA_BIN_VERSION || h->header_size < sizeof(PisaBinHeader)) return NULL;
+  if(h->header_size % 8 != 0 || h->data_size % 8 != 0) return NULL;
+  if(file.size != h->header_size + h->data_size) return NULL;
+  if(h->data_size != index_bytes(h->rows) + (uint64_t)(h->dim + h->con) * h->rows * sizeof(double))
+    return NULL;
+  if(checksum(file.data + h->header_size, h->data_size) != h->checksum) return NULL;
+  return h;
+}
+
+} /* namespace */
+
+/*----------------------------| population |-----------------------------*/
+
+int pisa_bin_write_pop(const char* filename, int size, int dim, int con,
+		       const int* index, const double* f, const double* c)
+{
+  if(size < 0 || dim < 0 || con < 0) return -1;
+
+  size_t n = size;
+  size_t ib = index_bytes(n);
+  vector<char> data(ib + (size_t)(dim + con) * n * sizeof(double), 0);
+
+  int32_t* idx = (int32_t*)&data[0];
+  for(size_t i = 0; i < n; i++) idx[i] = index[i];
+
+  /* transpose into one block per objective and constraint */
+  double* col = (double*)&data[ib];
+  for(int d = 0; d < dim; d++, col += n)
+    for(size_t i = 0; i < n; i++) col[i] = f[i * dim + d];
+  for(int j = 0; j < con; j++, col += n)
+    for(size_t i = 0; i < n; i++) col[i] = c[i * con + j];
+
+  return write_file(filename, magic_pop, dim, con, n, data);
+}
+
+
+int pisa_bin_read_pop(const char* filename, int size, int dim, int con,
+		      int* index, double* f, double* c)
+{
+  FileView file(filename);
+  const PisaBinHeader* h = check_file(file, magic_pop);
+  if(h == NULL) return 1;
+  if(h->rows != (uint64_t)size || h->dim != (uint32_t)dim || h->con != (uint32_t)con) return 1;
+
+  size_t n = size;
+  const char* data = file.data + h->header_size;
+
+  const int32_t* idx = (const int32_t*)data;
+  for(size_t i = 0; i < n; i++) index[i] = idx[i];
+
+  const double* col = (const double*)(data + index_bytes(n));
+  for(int d = 0; d < dim; d++, col += n)
+    for(size_t i = 0; i < n; i++) f[i * dim + d] = col[i];
+  for(int j = 0; j < con; j++, col += n)
+    for(size_t i = 0; i < n; i++) c[i * con + j] = col[i];
+
+  return 0;
+}
+
+/*---------------------------| index lists |-----------------------------*/
+
+int pisa_bin_write_index(const char* filename, int n, const int* index)
+{
+  if(n < 0) return -1;
+
+  vector<char> data(index_bytes(n), 0);
+  int32_t* idx = n > 0 ? (int32_t*)&data[0] : NULL;
+  for(int i = 0; i < n; i++) idx[i] = index[i];
+
+  return write_file(filename, magic_index, 0, 0, n, data);
+}
+
+
+int pisa_bin_read_index(const char* filename, int max_n, int* index)
+{
+  FileView file(filename);
+  const PisaBinHeader* h = check_file(file, magic_index);
+  if(h == NULL || h->dim != 0 || h->con != 0) return -1;
+
+  int n = (int)h->rows;
+  if(n <= max_n) {
+    const int32_t* idx = (const int32_t*)(file.data + h->header_size);
+    for(int i = 0; i < n; i++) index[i] = idx[i];
+  }
+  return n;
+}
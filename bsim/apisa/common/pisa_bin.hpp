@@ -0,0 +1,74 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Binary format of the PISA data files.
+
+  An alternative to the text ini/var (population) and sel/arc (index)
+  files, for large populations and network file systems. A file is a
+  header followed by the data in column-major blocks:
+
+    header       magic "APISAPOP" (population) or "APISAIDX" (index list),
+                 version, byte order mark, header size, dim, con,
+                 number of rows, data size and a checksum of the data
+                 (see struct PisaBinHeader in pisa_bin.cpp)
+    index        rows 32 bit ints, padded to a multiple of 8 bytes
+    objectives   dim blocks of rows doubles (population only)
+    constraints  con blocks of rows doubles (population only)
+
+  All numbers are in the byte order of the writer, so both sides must
+  run on machines of the same byte order; readers check this. Doubles
+  are stored exactly, unlike the 8 digits of the text files.
+
+  A file is written to '<filename>.tmp' and renamed, so a reader sees
+  either the old file or the complete new one. Readers map the file
+  (mmap) and check the header and checksum. As with the text files the
+  reader then overwrites the file with "0" to mark it as consumed, and
+  check_file() reads a binary file as not consumed.
+
+  The state file and the cfg file stay text files. Selectors use the
+  format with the option 'bin', the Fortran variator with pisa_bin_on
+  in pisa_mod. The functions have C linkage for the bind(c) interfaces
+  of pisa_mod.
+
+  file: pisa_bin.hpp
+  ========================================================================
+*/
+
+#ifndef PISA_BIN_HPP
+#define PISA_BIN_HPP
+
+#define PISA_BIN_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Writes a population of 'size' individuals. index[i] identifies
+   individual i, its objectives are f[i*dim + d] and its constraints
+   c[i*con + j] (c may be NULL if con = 0). Returns 0 on success. */
+int pisa_bin_write_pop(const char* filename, int size, int dim, int con,
+		       const int* index, const double* f, const double* c);
+
+/* Reads a population written by pisa_bin_write_pop() into index, f and
+   c (same layout). Returns 0 on success and 1 if the file is not a
+   valid population of this size, dim and con (as read_pop() for an
+   incomplete file). */
+int pisa_bin_read_pop(const char* filename, int size, int dim, int con,
+		      int* index, double* f, double* c);
+
+/* Writes an index list (sel or arc). Returns 0 on success. */
+int pisa_bin_write_index(const char* filename, int n, const int* index);
+
+/* Reads an index list into index if it has at most max_n entries.
+   Returns the length of the list, -1 if the file is not a valid index
+   list. */
+int pisa_bin_read_index(const char* filename, int max_n, int* index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PISA_BIN_HPP */
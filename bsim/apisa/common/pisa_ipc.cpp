@@ -0,0 +1,420 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Socket transport for the PISA protocol.
+
+  A message is a header (magic, state and the sizes of the population
+  and index lists, -1 if absent) followed by the population rows as
+  doubles and the sel and arc indices as ints. Both processes run on
+  the same host so native byte order is used. Only one message is in
+  flight at a time (the PISA protocol alternates between the two
+  sides), so the socket buffer is all the buffering needed.
+
+  file: pisa_ipc.cpp
+  ========================================================================
+*/
+
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "pisa_ipc.hpp"
+
+using namespace std;
+
+#ifndef _WIN32
+
+namespace {
+
+const int magic = 0x50495341; /* "PISA" */
+
+struct Header {
+  int magic;
+  int state;
+  int n_pop, n_col;   /* population rows and columns */
+  int n_index[2];     /* sel and arc */
+};
+
+int listen_fd = -1;   /* variator: listening socket until the selector connects */
+int fd = -1;          /* connection to the other side */
+bool peer_gone = false;
+string sock_path;     /* socket file created by this process */
+
+int state = -1;
+
+/* outgoing data for the next write_state, and messages queued while
+   the selector is not connected yet */
+vector<double> out_pop;
+int out_pop_size = -1, out_col = 0;
+vector<int> out_index[2];
+bool out_index_set[2] = {false, false};
+vector<char> outbox;
+
+/* received data */
+vector<double> in_pop;
+int in_pop_size = -1, in_col = 0;
+vector<int> in_index[2];
+bool in_index_set[2] = {false, false};
+
+
+double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+
+void remove_socket()
+{
+  if(!sock_path.empty()) unlink(sock_path.c_str());
+}
+
+
+bool socket_address(const char* prefix, struct sockaddr_un& addr)
+{
+  string path = string(prefix) + "sock";
+  if(path.size() >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "PISA IPC: socket path too long: %s\n", path.c_str());
+    return false;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path.c_str());
+  return true;
+}
+
+
+int new_socket()
+{
+  int s = socket(AF_UNIX, SOCK_STREAM, 0);
+#ifdef SO_NOSIGPIPE
+  int one = 1;
+  if(s >= 0) setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+  return s;
+}
+
+
+void disconnect()
+{
+  if(fd >= 0) close(fd);
+  fd = -1;
+  peer_gone = true;
+}
+
+
+bool write_all(const char* buf, size_t n)
+{
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  while(n > 0) {
+    ssize_t m = send(fd, buf, n, flags);
+    if(m < 0 && errno == EINTR) continue;
+    if(m <= 0) return false;
+    buf += m;
+    n -= m;
+  }
+  return true;
+}
+
+
+bool read_all(void* buf, size_t n)
+{
+  char* p = (char*)buf;
+  while(n > 0) {
+    ssize_t m = read(fd, p, n);
+    if(m < 0 && errno == EINTR) continue;
+    if(m <= 0) return false;
+    p += m;
+    n -= m;
+  }
+  return true;
+}
+
+
+/* Accepts the selector's connection, waiting at most 'timeout' seconds
+   (forever if negative), and sends the queued messages. */
+bool accept_peer(double timeout)
+{
+  if(fd >= 0) return true;
+  if(listen_fd < 0) return false;
+
+  struct pollfd p = {listen_fd, POLLIN, 0};
+  int ms = timeout < 0 ? -1 : (int)(timeout * 1000);
+  int r = poll(&p, 1, ms);
+  if(r <= 0) return false;
+
+  fd = accept(listen_fd, NULL, NULL);
+  if(fd < 0) return false;
+#ifdef SO_NOSIGPIPE
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+  close(listen_fd);
+  listen_fd = -1;
+  remove_socket();
+  sock_path.clear();
+
+  if(!outbox.empty()) {
+    if(!write_all(&outbox[0], outbox.size())) disconnect();
+    outbox.clear();
+  }
+  return fd >= 0;
+}
+
+
+/* True if a message can be read within 'timeout' seconds. */
+bool readable(double timeout)
+{
+  if(fd < 0) return false;
+  struct pollfd p = {fd, POLLIN, 0};
+  int ms = timeout < 0 ? -1 : (int)(timeout * 1000);
+  int r;
+  while((r = poll(&p, 1, ms)) < 0 && errno == EINTR);
+  return r > 0;
+}
+
+
+/* Reads one message. */
+bool receive()
+{
+  Header h;
+  if(!read_all(&h, sizeof(h)) || h.magic != magic) {
+    disconnect();
+    return false;
+  }
+
+  if(h.n_pop >= 0) {
+    in_pop.resize((size_t)h.n_pop * h.n_col);
+    if(!in_pop.empty() && !read_all(&in_pop[0], in_pop.size() * sizeof(double))) {
+      disconnect();
+      return false;
+    }
+    in_pop_size = h.n_pop;
+    in_col = h.n_col;
+  }
+
+  for(int w = 0; w < 2; w++) {
+    if(h.n_index[w] < 0) continue;
+    in_index[w].resize(h.n_index[w]);
+    if(!in_index[w].empty() && !read_all(&in_index[w][0], in_index[w].size() * sizeof(int))) {
+      disconnect();
+      return false;
+    }
+    in_index_set[w] = true;
+  }
+
+  state = h.state;
+  return true;
+}
+
+
+void append(vector<char>& buf, const void* data, size_t n)
+{
+  const char* p = (const char*)data;
+  buf.insert(buf.end(), p, p + n);
+}
+
+} /* namespace */
+
+/*---------------------------| connection |------------------------------*/
+
+int pisa_ipc_listen(const char* prefix)
+{
+  struct sockaddr_un addr;
+  if(!socket_address(prefix, addr)) return -1;
+
+  listen_fd = new_socket();
+  if(listen_fd < 0) return -1;
+
+  unlink(addr.sun_path); /* left over from an earlier run */
+  if(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listen_fd, 1) != 0) {
+    fprintf(stderr, "PISA IPC: cannot create socket %s: %s\n", addr.sun_path, strerror(errno));
+    close(listen_fd);
+    listen_fd = -1;
+    return -1;
+  }
+
+  static bool registered = false;
+  if(!registered) atexit(remove_socket);
+  registered = true;
+  sock_path = addr.sun_path;
+  return 0;
+}
+
+
+int pisa_ipc_connect(const char* prefix, double poll)
+{
+  struct sockaddr_un addr;
+  if(!socket_address(prefix, addr)) return -1;
+
+  while(true) {
+    fd = new_socket();
+    if(fd < 0) return -1;
+    if(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) return 0;
+
+    int err = errno;
+    close(fd);
+    fd = -1;
+    if(err != ENOENT && err != ECONNREFUSED) {
+      fprintf(stderr, "PISA IPC: cannot connect to %s: %s\n", addr.sun_path, strerror(err));
+      return -1;
+    }
+    struct timespec ts;
+    ts.tv_sec = (time_t)poll;
+    ts.tv_nsec = (long)((poll - ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+  }
+}
+
+
+int pisa_ipc_active()
+{
+  return fd >= 0 || listen_fd >= 0 || peer_gone;
+}
+
+
+int pisa_ipc_close()
+{
+  if(fd >= 0) close(fd);
+  if(listen_fd >= 0) close(listen_fd);
+  remove_socket();
+  sock_path.clear();
+  fd = listen_fd = -1;
+  peer_gone = false;
+  state = -1;
+
+  out_pop_size = in_pop_size = -1;
+  for(int w = 0; w < 2; w++) out_index_set[w] = in_index_set[w] = false;
+  outbox.clear();
+  return 0;
+}
+
+/*-----------------------------| state |---------------------------------*/
+
+int pisa_ipc_read_state()
+{
+  accept_peer(0);
+  while(readable(0) && receive());
+  return state;
+}
+
+
+int pisa_ipc_write_state(int new_state)
+{
+  Header h = {magic, new_state, out_pop_size, out_col, {-1, -1}};
+  for(int w = 0; w < 2; w++)
+    if(out_index_set[w]) h.n_index[w] = out_index[w].size();
+
+  vector<char> msg;
+  append(msg, &h, sizeof(h));
+  if(out_pop_size >= 0 && !out_pop.empty())
+    append(msg, &out_pop[0], out_pop.size() * sizeof(double));
+  for(int w = 0; w < 2; w++)
+    if(out_index_set[w] && !out_index[w].empty()) append(msg, &out_index[w][0], out_index[w].size() * sizeof(int));
+
+  out_pop_size = -1;
+  out_index_set[0] = out_index_set[1] = false;
+  state = new_state;
+
+  accept_peer(0);
+  if(fd < 0) {
+    if(peer_gone) return -1;
+    outbox.insert(outbox.end(), msg.begin(), msg.end());
+    return 0;
+  }
+  if(!write_all(&msg[0], msg.size())) {
+    disconnect();
+    return -1;
+  }
+  return 0;
+}
+
+
+int pisa_ipc_wait(double timeout)
+{
+  double t0 = now();
+  if(fd < 0 && !accept_peer(timeout)) return peer_gone ? -1 : 1;
+
+  double left = timeout;
+  if(timeout >= 0) {
+    left = timeout - (now() - t0);
+    if(left < 0) left = 0;
+  }
+  if(!readable(left)) return peer_gone ? -1 : 1;
+  return receive() ? 0 : -1;
+}
+
+/*------------------------------| data |---------------------------------*/
+
+int pisa_ipc_put_pop(int size, int columns, const double* rows)
+{
+  out_pop.assign(rows, rows + (size_t)size * columns);
+  out_pop_size = size;
+  out_col = columns;
+  return 0;
+}
+
+
+int pisa_ipc_get_pop(int size, int columns, double* rows)
+{
+  if(in_pop_size != size || in_col != columns) return 1;
+  for(size_t k = 0; k < in_pop.size(); k++) rows[k] = in_pop[k];
+  in_pop_size = -1;
+  return 0;
+}
+
+
+int pisa_ipc_put_index(int which, int n, const int* index)
+{
+  if(which != PISA_IPC_SEL && which != PISA_IPC_ARC) return -1;
+  out_index[which].assign(index, index + n);
+  out_index_set[which] = true;
+  return 0;
+}
+
+
+int pisa_ipc_get_index(int which, int max_n, int* index)
+{
+  if(which != PISA_IPC_SEL && which != PISA_IPC_ARC) return -1;
+  if(!in_index_set[which]) return -1;
+  int n = in_index[which].size();
+  for(int i = 0; i < n && i < max_n; i++) index[i] = in_index[which][i];
+  return n;
+}
+
+#else /* _WIN32 */
+
+int pisa_ipc_listen(const char* prefix) { return -1; }
+int pisa_ipc_connect(const char* prefix, double poll) { return -1; }
+int pisa_ipc_active() { return 0; }
+int pisa_ipc_close() { return -1; }
+int pisa_ipc_read_state() { return -1; }
+int pisa_ipc_write_state(int state) { return -1; }
+int pisa_ipc_wait(double timeout) { return -1; }
+int pisa_ipc_put_pop(int size, int columns, const double* rows) { return -1; }
+int pisa_ipc_get_pop(int size, int columns, double* rows) { return -1; }
+int pisa_ipc_put_index(int which, int n, const int* index) { return -1; }
+int pisa_ipc_get_index(int which, int max_n, int* index) { return -1; }
+
+#endif
@@ -0,0 +1,94 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  Socket transport for the PISA protocol.
+
+  The PISA state machine is unchanged, but the state file and the
+  ini/var/sel/arc files are replaced by messages over a Unix domain
+  socket '<prefix>sock'. Each message carries the new state together
+  with the data that goes with it, so no side ever polls: a process
+  waiting for the other one blocks in pisa_ipc_wait() until a message
+  arrives. The file protocol remains the default.
+
+  The variator creates the socket with pisa_ipc_listen() and the
+  selector connects with pisa_ipc_connect() (selector option 'ipc').
+  Either may be started first. States written before the selector is
+  connected are queued.
+
+  The functions have C linkage so the Fortran variator (pisa_mod) can
+  call them through bind(c) interfaces. All of them return -1 if the
+  transport is not available (not a Unix system).
+
+  file: pisa_ipc.hpp
+  ========================================================================
+*/
+
+#ifndef PISA_IPC_HPP
+#define PISA_IPC_HPP
+
+#define PISA_IPC_SEL 0 /* index lists in a state 2 message */
+#define PISA_IPC_ARC 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------| connection |------------------------------*/
+
+/* Variator: creates the socket '<prefix>sock'. Returns 0 on success. */
+int pisa_ipc_listen(const char* prefix);
+
+/* Selector: connects to '<prefix>sock', retrying every 'poll' seconds
+   until the variator is listening. Returns 0 on success. */
+int pisa_ipc_connect(const char* prefix, double poll);
+
+/* 1 if the socket transport is in use, 0 otherwise. */
+int pisa_ipc_active();
+
+/* Closes the connection and removes the socket. The transport can then
+   be opened again, e.g. for the next selector run. */
+int pisa_ipc_close();
+
+/*-----------------------------| state |---------------------------------*/
+
+/* Current state, i.e. the last state written by either side. Messages
+   that have arrived are processed first but the call does not block.
+   -1 if no state has been written yet (as a missing state file). */
+int pisa_ipc_read_state();
+
+/* Writes a state. The data given with pisa_ipc_put_pop() and
+   pisa_ipc_put_index() since the last call is sent with it. */
+int pisa_ipc_write_state(int state);
+
+/* Blocks until a message from the other side has arrived and processes
+   it. Gives up after 'timeout' seconds if timeout >= 0.
+   Returns 0 if a message arrived, 1 on timeout, -1 if the other side
+   has disconnected. */
+int pisa_ipc_wait(double timeout);
+
+/*------------------------------| data |---------------------------------*/
+
+/* Population rows (index, objectives, constraints) for the next state
+   (ini or var). rows[i*columns + j] is column j of row i. */
+int pisa_ipc_put_pop(int size, int columns, const double* rows);
+
+/* Copies the received population into rows. Returns 0 on success and 1
+   if no population of this size has been received (as read_pop() for
+   an incomplete file). The population is consumed. */
+int pisa_ipc_get_pop(int size, int columns, double* rows);
+
+/* Index list PISA_IPC_SEL or PISA_IPC_ARC for the next state. */
+int pisa_ipc_put_index(int which, int n, const int* index);
+
+/* Copies the received index list into index (at most max_n entries).
+   Returns the length of the list, -1 if none has been received. */
+int pisa_ipc_get_index(int which, int max_n, int* index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PISA_IPC_HPP */
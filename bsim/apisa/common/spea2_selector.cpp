@@ -0,0 +1,576 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  SPEA2 - Strength Pareto EA 2
+
+  Implements the selection.
+
+  file: spea2_selector.cpp
+  author: Marco Laumanns, laumanns@tik.ee.ethz.ch
+
+  revision by:  Stefan Bleuler, bleuler@tik.ee.ethz.ch
+  rewritten by: Ivan Bazarov, bazarov@cornell.edu
+  ========================================================================
+*/
+
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+#include "spea2_selector.hpp"
+#include "kd_tree.hpp"
+#include "dominance.hpp"
+
+#define PISA_MAXDOUBLE 1E99  /* Internal maximal value for double */
+
+typedef ApisaSelector::ind ind;
+
+namespace {
+
+/* Lexicographic order of the objective vectors. */
+struct ObjectiveLess {
+  ind** ind_array;
+  int dim;
+  bool operator()(int a, int b) const {
+    for(int i = 0; i < dim; i++) {
+      if(ind_array[a]->f[i] < ind_array[b]->f[i]) return true;
+      if(ind_array[a]->f[i] > ind_array[b]->f[i]) return false;
+    }
+    return a < b;
+  }
+};
+
+
+/* Priority queue entry of truncate_distinct(). */
+struct NNKey {
+  double d;     /* distance to the key neighbor, -1 if there is none */
+  int index;
+  int version;  /* entry is stale if the key has changed since */
+  bool operator>(const NNKey& b) const { return d > b.d; }
+};
+
+typedef std::priority_queue<NNKey, std::vector<NNKey>, std::greater<NNKey> > NNQueue;
+
+} /* namespace */
+
+
+Spea2Selector::Spea2Selector(int alpha, int mu, int lambda, int dim, int con,
+			     int seed, int tournament, int k_neighbor)
+  : ApisaSelector(alpha, mu, lambda, dim, con, seed, tournament),
+    kth(k_neighbor), kth_is_sqrt(k_neighbor <= 0), n_call(0)
+{
+}
+
+/*-----------------------| selection functions|--------------------------*/
+
+void Spea2Selector::selection()
+{
+  /* Join offspring individuals from variator to population */
+  mergeOffspring();
+  
+  int size = pp_all->size;
+
+  /* set k-th neighbor number */
+  if(kth_is_sqrt) kth = (int) sqrt((double) size);
+  assert(kth > 0);
+
+  /* Create internal data structures for selection process */
+  /* Vectors */
+  copies = (int*) chk_malloc(size * sizeof(int));
+  old_index = (int*) chk_malloc(size * sizeof(int));
+  
+  /* Neighbor lists (filled on demand) */
+  NN = new std::vector<int>[size];
+  NNd = new std::vector<double>[size];
+
+  /* Calculates SPEA2 fitness values for all individuals */
+  calcFitnesses();
+  phase("fitness");
+
+  /* Builds the nearest neighbor index and counts copies */
+  calcDistances();
+  phase("density");
+  
+  /* Performs environmental selection
+     (truncates 'pp_all' to size 'alpha') */
+  environmentalSelection();
+  phase("environmental");
+
+  /* Performs mating selection
+     (fills mating pool / offspring population pp_sel */
+  matingSelection();
+  phase("mating");
+
+  /* Frees memory of internal data structures */    
+  free(copies);
+  free(old_index);
+  delete knn;
+  delete[] NN;
+  delete[] NNd;
+  
+  return;
+}
+
+
+void Spea2Selector::calcFitnesses()
+/* Fitness = sum of the strengths of the dominators, where the strength
+   is the number of dominated individuals. */
+{  
+  int size = pp_all->size;
+  int* strength = (int*) chk_malloc(size * sizeof(int));
+  int* raw = (int*) chk_malloc(size * sizeof(int));
+  double** f = (double**) chk_malloc(size * sizeof(double*));
+  double** c = (double**) chk_malloc(size * sizeof(double*));
+
+  for(int i = 0; i < size; i++) {
+    f[i] = pp_all->ind_array[i]->f;
+    c[i] = pp_all->ind_array[i]->c;
+  }
+
+  strength_fitness(size, dim, con, f, c, strength, raw);
+
+  n_nondominated = 0;
+  for(int i = 0; i < size; i++) {
+    pp_all->ind_array[i]->fitness = raw[i];
+    if(raw[i] == 0) n_nondominated++;
+  }
+  
+  free(strength);
+  free(raw);
+  free(f);
+  free(c);
+  return;
+}
+
+
+
+
+void Spea2Selector::calcDistances()
+/* Builds the k-d tree of the objective vectors and counts the
+   individuals with identical objective values (copies[]). */
+{
+  int size = pp_all->size;
+  double** f = (double**) chk_malloc(size * sizeof(double*));
+  std::vector<int> order(size);
+
+  for(int i = 0; i < size; i++) {
+    f[i] = pp_all->ind_array[i]->f;
+    order[i] = i;
+  }
+
+  knn = new KdTree(size, dim, f);
+  free(f);
+
+  /* identical individuals are adjacent in lexicographic order */
+  ObjectiveLess less = {pp_all->ind_array, dim};
+  std::sort(order.begin(), order.end(), less);
+  for(int i = 0; i < size; ) {
+    int j = i + 1;
+    while(j < size && is_equal(pp_all->ind_array[order[i]], pp_all->ind_array[order[j]])) j++;
+    for(int m = i; m < j; m++) copies[order[m]] = j - i;
+    i = j;
+  }
+}
+
+
+int Spea2Selector::getNN(int index, int k)
+/* lazy evaluation of the k-th nearest neighbor. Neighbors are ordered
+   by distance and then by index, deleted individuals included. The list
+   is extended by a k-d tree query with at least twice the length. */
+{
+  assert(index >= 0);
+  assert(k >= 0 && k < knn->size());
+  assert(copies[index] > 0);
+
+  if(k >= (int)NN[index].size()) {
+    int n_query = 2 * NN[index].size();
+    if(n_query < k) n_query = k;
+    if(n_query < 2 * kth) n_query = 2 * kth;
+
+    knn->nearest(index, n_query, NN[index], NNd[index]);
+    NN[index].insert(NN[index].begin(), index);
+    NNd[index].insert(NNd[index].begin(), 0);
+  }
+
+  return(NN[index][k]);
+}
+
+
+double Spea2Selector::getNNd(int index, int k)
+/* Returns the distance to the k-th nearest neigbor
+   if this individual is still in the population.
+   For for already deleted individuals, returns -1 */
+{
+  int neighbor_index = getNN(index, k);
+    
+  if(copies[neighbor_index] == 0) return(-1);
+  else return(NNd[index][k]);
+}
+
+
+double Spea2Selector::getNNdist(int index, int k)
+/* Returns the distance to the k-th nearest neighbor
+   whether it is still in the population or not. */
+{
+  getNN(index, k);
+  return(NNd[index][k]);
+}
+
+
+void Spea2Selector::environmentalSelection()
+{
+  int new_size = 0;
+
+  char tmp [1024];
+  sprintf(tmp, " spea2: #%d 1st front size (%d%s)\n", ++n_call, n_nondominated,
+	  n_nondominated > alpha ? "*" : "");
+  diag(tmp);
+
+  if(n_nondominated > alpha) truncate_nondominated();
+  else if(pp_all->size > alpha)	truncate_dominated();
+
+  /* Move remaining individuals to top of array in 'pp_all' */
+  for(int i = 0; i < pp_all->size; i++) {
+    ind* temp_ind = pp_all->ind_array[i];
+    if(temp_ind != NULL) {
+      assert(copies[i] > 0);	    
+      pp_all->ind_array[i] = NULL;
+      pp_all->ind_array[new_size] = temp_ind;
+      old_index[new_size] = i;
+      new_size++;    
+    }
+  }
+  assert(new_size <= alpha);
+  pp_all->size = new_size;
+    
+  return;
+}
+
+
+void Spea2Selector::truncate_nondominated()
+/* truncate from nondominated individuals (if too many) */
+{
+  /* delete all dominated individuals */
+  for(int i = 0; i < pp_all->size; i++) {
+    if(pp_all->ind_array[i]->fitness > 0) {
+      free_ind(pp_all->ind_array[i]);
+      pp_all->ind_array[i] = NULL;
+      copies[i] = 0;
+    }
+  }
+    
+  /* truncate from non-dominated individuals */
+  while(n_nondominated > alpha) {
+    int* marked;
+    int max_copies = 0;
+    int count = 0;
+    int delete_index;
+
+    marked = (int*) chk_malloc(pp_all->size * sizeof(int));
+
+    /* compute inds with maximal copies */
+    for(int i = 0; i < pp_all->size; i++) {
+      if(copies[i] > max_copies) {
+	count = 0;
+	max_copies = copies[i];
+      }
+      if(copies[i] == max_copies) {
+	marked[count] = i;
+	count++;
+      }
+    }
+    
+    //assert(count >= max_copies); 
+
+    /* no more copies: continue with the priority queue */
+    if(max_copies == 1) {
+      free(marked);
+      truncate_distinct();
+      break;
+    }
+    
+    if(count > max_copies) {    
+      int* neighbor;
+      neighbor = (int*) chk_malloc(count * sizeof(int));
+      for(int i = 0; i < count; i++)
+	neighbor[i] = kth; /* k-th neighbor */
+      
+      while(count > max_copies) {
+	double min_dist = PISA_MAXDOUBLE;
+	int count2 = 0;
+	
+	for(int i = 0; i < count; i++) {
+	  double my_dist = -1;
+	  while(my_dist == -1 && neighbor[i] < pp_all->size) {
+	    my_dist = getNNd(marked[i],neighbor[i]);
+	    neighbor[i]++;
+	  }
+	  
+	  if(my_dist < min_dist) {
+	    count2 = 0;
+	    min_dist = my_dist;
+	  }
+	  if(my_dist == min_dist) {
+	    marked[count2] = marked[i];
+	    neighbor[count2] = neighbor[i];
+	    count2++;
+	  }
+	}
+	
+	count = count2;
+	if(min_dist == -1) break; /* all have equal distances */
+      }
+      
+      free(neighbor);
+    }
+    
+    /* remove individual from population */
+    delete_index = marked[irand(count)];
+    for(int i = 0; i < count; i++)
+      if(is_equal(pp_all->ind_array[delete_index], pp_all->ind_array[marked[i]]))
+	copies[marked[i]]--;
+    free_ind(pp_all->ind_array[delete_index]);
+    pp_all->ind_array[delete_index] = NULL;
+
+    copies[delete_index] = 0; /* Indicates that this index is empty */
+    n_nondominated--;
+    free(marked);
+  }
+  
+  return;
+}
+
+
+int Spea2Selector::nextNN(int index, int k)
+/* Position of the first neighbor of 'index' from the k-th on that is
+   still in the population. Returns -1 if there is none. */
+{
+  for(; k < knn->size(); k++)
+    if(copies[getNN(index, k)] > 0) return(k);
+  return(-1);
+}
+
+
+void Spea2Selector::truncate_distinct()
+/* truncate from nondominated individuals once all copies are removed.
+   Deletes the same individuals as the neighbor loop in
+   truncate_nondominated(): the smallest distance to the k-th neighbor
+   (skipping deleted ones) goes first, ties are resolved with the
+   following neighbors and then at random.
+   The key of an individual only changes when its key neighbor is
+   deleted, so the keys are kept in a priority queue and each deletion
+   updates just the individuals that used the deleted one as key. */
+{
+  int size = pp_all->size;
+  std::vector<int> pos(size, -1);    /* position of the key neighbor in NN[i] */
+  std::vector<int> version(size, 0);
+  std::vector< std::vector<int> > keyed(size); /* keyed[j]: individuals with key neighbor j */
+  std::vector<NNKey> tied;
+  std::vector<int> marked, neighbor;
+  NNQueue queue;
+
+  for(int i = 0; i < size; i++) {
+    if(copies[i] == 0) continue;
+    NNKey key = {-1, i, 0};
+    pos[i] = nextNN(i, kth); /* k-th neighbor */
+    if(pos[i] >= 0) {
+      key.d = NNd[i][pos[i]];
+      keyed[NN[i][pos[i]]].push_back(i);
+    }
+    queue.push(key);
+  }
+
+  while(n_nondominated > alpha) {
+    /* pop all individuals with the smallest key */
+    tied.clear();
+    while(!queue.empty()) {
+      NNKey key = queue.top();
+      if(copies[key.index] > 0 && key.version == version[key.index]) {
+	if(!tied.empty() && key.d != tied[0].d) break;
+	tied.push_back(key);
+      }
+      queue.pop();
+    }
+
+    marked.clear();
+    for(size_t i = 0; i < tied.size(); i++) marked.push_back(tied[i].index);
+    std::sort(marked.begin(), marked.end());
+    int count = marked.size();
+
+    /* resolve ties with the following neighbors */
+    if(count > 1 && tied[0].d != -1) {
+      neighbor.resize(count);
+      for(int i = 0; i < count; i++) neighbor[i] = pos[marked[i]] + 1;
+
+      while(count > 1) {
+	double min_dist = PISA_MAXDOUBLE;
+	int count2 = 0;
+
+	for(int i = 0; i < count; i++) {
+	  double my_dist = -1;
+	  int k = nextNN(marked[i], neighbor[i]);
+	  if(k >= 0) {
+	    my_dist = NNd[marked[i]][k];
+	    neighbor[i] = k + 1;
+	  }
+	  else neighbor[i] = size;
+
+	  if(my_dist < min_dist) {
+	    count2 = 0;
+	    min_dist = my_dist;
+	  }
+	  if(my_dist == min_dist) {
+	    marked[count2] = marked[i];
+	    neighbor[count2] = neighbor[i];
+	    count2++;
+	  }
+	}
+
+	count = count2;
+	if(min_dist == -1) break; /* all have equal distances */
+      }
+    }
+
+    /* remove individual from population */
+    int delete_index = marked[irand(count)];
+    free_ind(pp_all->ind_array[delete_index]);
+    pp_all->ind_array[delete_index] = NULL;
+    copies[delete_index] = 0; /* Indicates that this index is empty */
+    n_nondominated--;
+
+    for(size_t i = 0; i < tied.size(); i++)
+      if(tied[i].index != delete_index) queue.push(tied[i]);
+
+    /* move the key of those that had it as key neighbor */
+    for(size_t m = 0; m < keyed[delete_index].size(); m++) {
+      int i = keyed[delete_index][m];
+      if(copies[i] == 0 || pos[i] < 0 || NN[i][pos[i]] != delete_index) continue;
+
+      NNKey key = {-1, i, ++version[i]};
+      pos[i] = nextNN(i, pos[i] + 1);
+      if(pos[i] >= 0) {
+	key.d = NNd[i][pos[i]];
+	keyed[NN[i][pos[i]]].push_back(i);
+      }
+      queue.push(key);
+    }
+    std::vector<int>().swap(keyed[delete_index]);
+  }
+
+  return;
+}
+
+
+void Spea2Selector::truncate_dominated()
+/* truncate from dominated individuals */
+{
+  int size = pp_all->size;
+  int i, j;
+  int num = 0;
+  int num_better = 0;
+
+  /* j = fitness of the alpha-th best individual */
+  std::vector<int> fitness(size);
+  for(i = 0; i < size; i++) fitness[i] = pp_all->ind_array[i]->fitness;
+  std::nth_element(fitness.begin(), fitness.begin() + alpha - 1, fitness.end());
+  j = fitness[alpha - 1];
+
+  for(i = 0; i < size; i++) {
+    if(pp_all->ind_array[i]->fitness <= j) num++;
+    if(pp_all->ind_array[i]->fitness < j) num_better++;
+  }
+    
+  if(num == alpha) {
+    for(i = 0; i < size; i++) {
+      if(pp_all->ind_array[i]->fitness > j) {
+	free_ind(pp_all->ind_array[i]);
+	pp_all->ind_array[i] = NULL;
+      }
+    }
+  }
+  else { /* if not all fit into the next generation */
+    int k;
+    int free_spaces;
+    int fill_level = 0;
+
+    free_spaces = alpha - num_better;
+    std::vector<int> best(free_spaces);
+    for (i = 0; i < size; i++) {
+      if(pp_all->ind_array[i]->fitness > j) {
+	free_ind(pp_all->ind_array[i]);
+	pp_all->ind_array[i] = NULL;
+      }
+      else if(pp_all->ind_array[i]->fitness == j) {
+	if(fill_level < free_spaces) {
+	  best[fill_level] = i;
+	  fill_level++;
+	  for(k = fill_level - 1; k > 0; k--) {
+	    int temp;
+	    if(getNNd(best[k], kth) <= getNNd(best[k - 1], kth)) /* k-th neighbor */
+	      break;
+	    temp = best[k];
+	    best[k] = best[k-1];
+	    best[k-1] = temp;
+	  }
+	}
+	else {
+	  if(getNNd(i, kth) <= getNNd(best[free_spaces - 1], kth)) { /* k-th neighbor */
+	    free_ind(pp_all->ind_array[i]);
+	    pp_all->ind_array[i] = NULL;
+	  }
+	  else {
+	    free_ind(pp_all->ind_array[best[free_spaces - 1]]);
+	    pp_all->ind_array[best[free_spaces - 1]] = NULL;
+	    best[free_spaces - 1] = i;
+	    for(k = fill_level - 1; k > 0; k--) {
+	      int temp;
+	      if(getNNd(best[k], kth) <= getNNd(best[k - 1], kth)) /* k-th neighbor */
+		break;
+	      temp = best[k];
+	      best[k] = best[k-1];
+	      best[k-1] = temp;
+	    }
+	  }
+	}
+      }
+    }
+  }
+  return;
+}
+
+
+void Spea2Selector::matingSelection()
+/* Fills mating pool 'pp_sel' */
+{
+  for(int i = 0; i < mu; i++) {
+    int winner = irand(pp_all->size);
+	
+    for(int j = 1; j < tournament; j++) {
+      int opponent = irand(pp_all->size);
+      if(pp_all->ind_array[opponent]->fitness
+	 < pp_all->ind_array[winner]->fitness || winner == opponent)
+	winner = opponent;
+      else if(pp_all->ind_array[opponent]->fitness
+	      == pp_all->ind_array[winner]->fitness) {
+	if(getNNdist(old_index[opponent], kth) /* k-th neighbor */
+	   > getNNdist(old_index[winner], kth)) /* k-th neighbor */
+	  winner = opponent;
+      }
+    }  
+    pp_sel->ind_array[i] = pp_all->ind_array[winner];
+  }
+  pp_sel->size = mu;
+  return;
+}
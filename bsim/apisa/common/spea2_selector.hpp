@@ -0,0 +1,59 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  SPEA2 selector (see apisa_selector.hpp).
+
+  file: spea2_selector.hpp
+  ========================================================================
+*/
+
+#ifndef SPEA2_SELECTOR_HPP
+#define SPEA2_SELECTOR_HPP
+
+#include <vector>
+
+#include "apisa_selector.hpp"
+
+class KdTree;
+
+class Spea2Selector : public ApisaSelector {
+public:
+  /* k_neighbor: the k-th nearest neighbor is used for the density
+     estimate. 0 => k = sqrt of the merged population size. */
+  Spea2Selector(int alpha, int mu, int lambda, int dim, int con, int seed,
+		int tournament, int k_neighbor);
+
+protected:
+  void selection();
+
+private:
+  int kth;          /* k-th neighbor in niching operator */
+  bool kth_is_sqrt; /* k-th is equal to sqrt of merged population if true */
+
+  /* internal data of one selection */
+  int n_nondominated; /* number of individuals with fitness 0 */
+  int* copies;
+  int* old_index;
+  KdTree* knn;              /* nearest neighbor index of the combined population */
+  std::vector<int>* NN;     /* NN[i][k] = k-th nearest neighbor of i, NN[i][0] = i */
+  std::vector<double>* NNd; /* NNd[i][k] = distance to NN[i][k] */
+
+  int n_call;  /* call number for diagnostics purposes */
+
+  void calcFitnesses();
+  void calcDistances();
+  int getNN(int index, int k);
+  double getNNd(int index, int k);
+  double getNNdist(int index, int k);
+  int nextNN(int index, int k);
+  void environmentalSelection();
+  void truncate_nondominated();
+  void truncate_distinct();
+  void truncate_dominated();
+  void matingSelection();
+};
+
+#endif /* SPEA2_SELECTOR_HPP */
@@ -0,0 +1,24 @@
+/*========================================================================
+  APISA  (www.tik.ee.ethz.ch/pisa/; www.lepp.cornell.edu/~ib38/apisa/)
+  ========================================================================
+  Cornell University
+  Ithaca, NY 14853
+  ========================================================================
+  NSGA3
+
+  Selector program. The Petri net and the data exchange are in
+  ../common/apisa_main.cpp, the selection in ../common/nsga3_selector.cpp.
+  
+  file: nsga3.cpp
+  based on the NSGA2 selector (nsga2/nsga2.cpp)
+  ========================================================================
+*/
+
+#include "../common/apisa_main.hpp"
+
+/*------------------------------| main() |-------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  return(apisa_main("nsga3", argc, argv));
+}
@@ -50,6 +50,7 @@ real(rp) initial_blow_up(3)
 logical error, do_pwd
 logical :: ptc_calc
 logical set_dispersion
+logical fixed_quadrature
 
 character(200) in_file
 character(4) :: ibs_formula
@@ -87,6 +88,7 @@ namelist /parameters/ &
   delta_current, &   ! mA step size.
   low_current, &     ! Smallest current per bunch in mA.
   ibs_formula, &     ! 'cimp', 'bjmt', 'bane', 'mpzt', 'mpxx'
+  fixed_quadrature, & ! Optional. If true, compute the rates with the C++ fixed quadrature instead of GSL.
   clog_to_use, &     ! 1=classic, no tail cut.  2=Raubenheimer.  3=Oide, 4=Bane.  See multi_coulomb_log in ibs_mod.f90
   eqb_method, &      ! 'der' for derivatives.  'rlx' for relaxation approach.  Use 'der'.
   initial_blow_up, & ! initial starting point for 'rlx' method.
@@ -226,6 +228,7 @@ ibs_sim_params%etap_set = etap_set
 ibs_sim_params%do_pwd = do_pwd
 ibs_sim_params%inductance = inductance
 ibs_sim_params%formula = ibs_formula
+ibs_sim_params%fixed_quadrature = fixed_quadrature
 ibs_sim_params%tau_a = lat%param%total_length / c_light / mode%a%alpha_damp  !needed for tail cut calculation
 
 if(eqb_method == 'rlx') then
@@ -439,6 +442,7 @@ contains
     etap_set = -99.0
     ptc_calc      = .false.
     do_pwd = .false.
+    fixed_quadrature = .false.
 
     dotinlun = LUNGET()
     in_file = 'ibs_ring.in'
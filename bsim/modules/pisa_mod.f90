@@ -1,6 +1,7 @@
 module pisa_mod
 
 use bmad, only: rp
+use, intrinsic :: iso_c_binding
 
 implicit none
 
@@ -24,6 +25,132 @@ type breeder_params_struct
   real(rp) :: mutate_delta(100)
 end type
 
+! Set by pisa_ipc_open: States and populations are exchanged with the selector
+! over the socket <prefix>sock instead of files (apisa/common/pisa_ipc.hpp).
+logical :: pisa_ipc_on = .false.
+
+! Set to .true. to write the ini and var files and read the sel and arc files in the
+! binary format (apisa/common/pisa_bin.hpp). The selector is then started with the
+! additional argument 'bin'.
+logical :: pisa_bin_on = .false.
+
+! Set by pisa_lib_open: The selector runs in this process (apisa/common/apisa_selector.hpp).
+! write_state does the selection right away so there is nothing to wait for.
+logical :: pisa_lib_on = .false.
+type(c_ptr) :: pisa_lib = c_null_ptr
+integer :: pisa_lib_state = -1
+character(200) :: pisa_lib_prefix, pisa_lib_name, pisa_lib_param
+integer(c_int), allocatable :: pisa_lib_index(:)     ! population from the last write_pop_pisa
+real(c_double), allocatable :: pisa_lib_f(:,:), pisa_lib_c(:,:)
+
+interface
+  function pisa_ipc_listen_c (prefix) result (err) bind(c, name = 'pisa_ipc_listen')
+    import
+    character(kind = c_char) prefix(*)
+    integer(c_int) err
+  end function
+
+  function pisa_ipc_close_c () result (err) bind(c, name = 'pisa_ipc_close')
+    import
+    integer(c_int) err
+  end function
+
+  function pisa_ipc_read_state_c () result (sta) bind(c, name = 'pisa_ipc_read_state')
+    import
+    integer(c_int) sta
+  end function
+
+  function pisa_ipc_write_state_c (sta) result (err) bind(c, name = 'pisa_ipc_write_state')
+    import
+    integer(c_int), value :: sta
+    integer(c_int) err
+  end function
+
+  function pisa_ipc_wait_c (timeout) result (err) bind(c, name = 'pisa_ipc_wait')
+    import
+    real(c_double), value :: timeout
+    integer(c_int) err
+  end function
+
+  function pisa_ipc_put_pop_c (n, n_col, rows) result (err) bind(c, name = 'pisa_ipc_put_pop')
+    import
+    integer(c_int), value :: n, n_col
+    real(c_double) rows(*)
+    integer(c_int) err
+  end function
+
+  function pisa_ipc_get_index_c (which, max_n, items) result (n) bind(c, name = 'pisa_ipc_get_index')
+    import
+    integer(c_int), value :: which, max_n
+    integer(c_int) items(*)
+    integer(c_int) n
+  end function
+
+  function pisa_bin_write_pop_c (filename, n, dim, con, index, f, c) result (err) bind(c, name = 'pisa_bin_write_pop')
+    import
+    character(kind = c_char) filename(*)
+    integer(c_int), value :: n, dim, con
+    integer(c_int) index(*)
+    real(c_double) f(*), c(*)
+    integer(c_int) err
+  end function
+
+  function pisa_bin_read_index_c (filename, max_n, index) result (n) bind(c, name = 'pisa_bin_read_index')
+    import
+    character(kind = c_char) filename(*)
+    integer(c_int), value :: max_n
+    integer(c_int) index(*)
+    integer(c_int) n
+  end function
+
+  function apisa_selector_new_c (name, paramfile, alpha, mu, lambda, dim, con) result (selector) &
+                                                                bind(c, name = 'apisa_selector_new')
+    import
+    character(kind = c_char) name(*), paramfile(*)
+    integer(c_int), value :: alpha, mu, lambda, dim, con
+    type(c_ptr) selector
+  end function
+
+  subroutine apisa_selector_delete_c (selector) bind(c, name = 'apisa_selector_delete')
+    import
+    type(c_ptr), value :: selector
+  end subroutine
+
+  function apisa_select_initial_c (selector, n, index, f, c) result (err) bind(c, name = 'apisa_select_initial')
+    import
+    type(c_ptr), value :: selector
+    integer(c_int), value :: n
+    integer(c_int) index(*)
+    real(c_double) f(*), c(*)
+    integer(c_int) err
+  end function
+
+  function apisa_select_normal_c (selector, n, index, f, c) result (err) bind(c, name = 'apisa_select_normal')
+    import
+    type(c_ptr), value :: selector
+    integer(c_int), value :: n
+    integer(c_int) index(*)
+    real(c_double) f(*), c(*)
+    integer(c_int) err
+  end function
+
+  function apisa_archive_c (selector, max_n, index) result (n) bind(c, name = 'apisa_archive')
+    import
+    type(c_ptr), value :: selector
+    integer(c_int), value :: max_n
+    integer(c_int) index(*)
+    integer(c_int) n
+  end function
+
+  function apisa_selected_c (selector, max_n, index) result (n) bind(c, name = 'apisa_selected')
+    import
+    type(c_ptr), value :: selector
+    integer(c_int), value :: max_n
+    integer(c_int) index(*)
+    integer(c_int) n
+  end function
+end interface
+
 contains
 
 subroutine find_empty_pop_slot(pop,ix)
@@ -152,14 +279,55 @@ subroutine read_pisa_indexes(prefix,what,n,items)
   integer items(:)
   integer i
   character(10) end_str
+  integer(c_int), allocatable :: c_items(:)
 
-  open(21,file=trim(prefix)//what,action='read')
-  read(21,'(i8)') n
-  do i=1,n
-    read(21,'(i8)') items(i)
-  enddo
-  read(21,*) end_str
-  close(21)
+  if(pisa_lib_on) then
+    allocate(c_items(size(items)))
+    if(what == 'sel') then
+      n = apisa_selected_c(pisa_lib, size(items), c_items)
+    else
+      n = apisa_archive_c(pisa_lib, size(items), c_items)
+    endif
+    if(n .gt. size(items)) then
+      write(*,*) "ERROR: too many ", what, " indexes from PISA selector."
+      error stop
+    endif
+    items(1:n) = c_items(1:n)
+    return
+  endif
+
+  if(pisa_ipc_on) then
+    allocate(c_items(size(items)))
+    n = pisa_ipc_get_index_c(merge(0, 1, what == 'sel'), size(items), c_items)
+    if(n .lt. 0) then
+      write(*,*) "ERROR: no ", what, " indexes received from PISA selector."
+      error stop
+    endif
+    if(n .gt. size(items)) then
+      write(*,*) "ERROR: too many ", what, " indexes from PISA selector."
+      error stop
+    endif
+    items(1:n) = c_items(1:n)
+    return
+  endif
+
+  if(pisa_bin_on) then
+    allocate(c_items(size(items)))
+    n = pisa_bin_read_index_c(trim(prefix)//what//c_null_char, size(items), c_items)
+    if(n .lt. 0 .or. n .gt. size(items)) then
+      write(*,*) "ERROR: cannot read binary PISA file ", trim(prefix)//what
+      error stop
+    endif
+    items(1:n) = c_items(1:n)
+  else
+    open(21,file=trim(prefix)//what,action='read')
+    read(21,'(i8)') n
+    do i=1,n
+      read(21,'(i8)') items(i)
+    enddo
+    read(21,*) end_str
+    close(21)
+  endif
   open(21,file=trim(prefix)//what,action='write')
   write(21,'(i1)') 0
   close(21)
@@ -169,15 +337,59 @@ subroutine write_pop_pisa(pop,filename)
   implicit none
 
   type(pop_struct) pop(:)
-  integer i, N
+  integer i, N, n_col, n_o, n_c, err
   character(*) filename
+  real(c_double), allocatable :: rows(:,:), f(:,:), c(:,:)
+  integer(c_int), allocatable :: names(:)
 
   N = size(pop)
 
+  if(pisa_lib_on) then
+    ! Kept for the selection in the next write_state.
+    if(allocated(pisa_lib_index)) deallocate(pisa_lib_index, pisa_lib_f, pisa_lib_c)
+    allocate(pisa_lib_index(N), pisa_lib_f(size(pop(1)%o(:)),N), pisa_lib_c(max(1,size(pop(1)%c(:))),N))
+    do i=1,N
+      pisa_lib_index(i) = pop(i)%name
+      pisa_lib_f(:,i) = pop(i)%o(:)
+      pisa_lib_c(1:size(pop(1)%c(:)),i) = pop(i)%c(:)
+    enddo
+    return
+  endif
+
+  if(pisa_ipc_on) then
+    n_col = 1+size(pop(1)%o(:))+size(pop(1)%c(:))
+    allocate(rows(n_col,N))
+    do i=1,N
+      rows(:,i) = [real(pop(i)%name,rp), pop(i)%o(:), pop(i)%c(:)]
+    enddo
+    err = pisa_ipc_put_pop_c(N, n_col, rows)
+    if(err .ne. 0) then
+      write(*,*) "ERROR: cannot send population to PISA selector for ", trim(filename)
+      error stop
+    endif
+    return
+  endif
+
+  if(pisa_bin_on) then
+    n_o = size(pop(1)%o(:))
+    n_c = size(pop(1)%c(:))
+    allocate(names(N), f(n_o,N), c(max(1,n_c),N))
+    do i=1,N
+      names(i) = pop(i)%name
+      f(:,i) = pop(i)%o(:)
+      c(1:n_c,i) = pop(i)%c(:)
+    enddo
+    if(pisa_bin_write_pop_c(trim(filename)//c_null_char, N, n_o, n_c, names, f, c) .ne. 0) then
+      write(*,*) "ERROR: cannot write binary PISA file ", trim(filename)
+      error stop
+    endif
+    return
+  endif
+
   open(21,file=filename,action='write')
   write(21,'(i8)') N*(size(pop(1)%o(:))+size(pop(1)%c(:))+1)
   do i=1,N
-    write(21,'(i8,20es18.8)') pop(i)%name, pop(i)%o(:), pop(i)%c(:)
+    write(21,'(i8,20es18.8e3)') pop(i)%name, pop(i)%o(:), pop(i)%c(:)
   enddo
   write(21,'(a)') 'END'
   close(21)
@@ -235,9 +447,26 @@ subroutine block_on_pisa_status(polli,prefix)
 
   integer sta
 
+  if(pisa_lib_on) then
+    if(pisa_lib_state .ne. 2) then
+      write(*,*) "ERROR: no selection made by the PISA selector."
+      error stop
+    endif
+    return
+  endif
+
   sta = 1
+  if(pisa_ipc_on) sta = poll_state(prefix)  ! may have arrived already
   do while( sta .ne. 2 )
-    call milli_sleep(polli)
+    if(pisa_ipc_on) then
+      ! Blocks until the selector writes the next state.
+      if(pisa_ipc_wait_c(-1.0_c_double) .lt. 0) then
+        write(*,*) "ERROR: PISA selector disconnected."
+        error stop
+      endif
+    else
+      call milli_sleep(polli)
+    endif
     sta = poll_state(prefix)
   enddo
 end subroutine
@@ -249,6 +478,16 @@ function poll_state(prefix)
   integer iostat
   integer poll_state
 
+  if(pisa_lib_on) then
+    poll_state = pisa_lib_state
+    return
+  endif
+
+  if(pisa_ipc_on) then
+    poll_state = pisa_ipc_read_state_c()
+    return
+  endif
+
   poll_state = -1
   open(21,file=trim(prefix)//'sta',action='read',iostat=iostat)
   if(iostat .eq. 0) then
@@ -262,12 +501,123 @@ subroutine write_state(prefix,sta)
 
   character(*) prefix
   integer sta
+  integer err
+
+  if(pisa_lib_on) then
+    call pisa_lib_step(sta)
+    return
+  endif
+
+  if(pisa_ipc_on) then
+    err = pisa_ipc_write_state_c(sta)  ! the selector may have quit already
+    return
+  endif
 
   open(21,file=trim(prefix)//'sta',action='write')
   write(21,'(i1)') sta
   close(21)
 end subroutine
 
+subroutine pisa_ipc_open(prefix)
+  ! Switches the exchange with the selector from files to the socket
+  ! <prefix>sock. Call before the first write_state. The selector is then
+  ! started with the additional argument 'ipc' and may be started before or
+  ! after this call.
+  implicit none
+
+  character(*) prefix
+
+  if(pisa_ipc_listen_c(trim(prefix)//c_null_char) .ne. 0) then
+    write(*,*) "ERROR: cannot create PISA socket ", trim(prefix)//'sock'
+    error stop
+  endif
+  pisa_ipc_on = .true.
+end subroutine
+
+subroutine pisa_ipc_close()
+  ! Closes the socket opened by pisa_ipc_open. Files are used again afterwards.
+  implicit none
+
+  integer err
+
+  err = pisa_ipc_close_c()
+  pisa_ipc_on = .false.
+end subroutine
+
+subroutine pisa_lib_open(prefix, name, paramfile)
+  ! Runs the selector in this process instead of starting ansga2, aspea2 or ansga3.
+  ! name is 'nsga2', 'spea2' or 'nsga3' and paramfile is the selector's parameter file
+  ! (nsga2_param.txt, spea2_param.txt, nsga3_param.txt). The selector is created at state 1 from
+  ! the <prefix>cfg file, as the selector program does. Call before the first
+  ! write_state.
+  implicit none
+
+  character(*) prefix, name, paramfile
+
+  pisa_lib_prefix = prefix
+  pisa_lib_name = name
+  pisa_lib_param = paramfile
+  pisa_lib_state = -1
+  pisa_lib_on = .true.
+end subroutine
+
+subroutine pisa_lib_close()
+  ! Deletes the selector of pisa_lib_open. Files are used again afterwards.
+  implicit none
+
+  call pisa_lib_free()
+  if(allocated(pisa_lib_index)) deallocate(pisa_lib_index, pisa_lib_f, pisa_lib_c)
+  pisa_lib_state = -1
+  pisa_lib_on = .false.
+end subroutine
+
+subroutine pisa_lib_free()
+  implicit none
+
+  if(c_associated(pisa_lib)) call apisa_selector_delete_c(pisa_lib)
+  pisa_lib = c_null_ptr
+end subroutine
+
+subroutine pisa_lib_step(sta)
+  ! Does what the selector program does when it reads state sta from the variator.
+  implicit none
+
+  integer sta, next
+  integer alpha, mu, lambda, dim, con, err
+
+  next = sta
+  err = 0
+  select case(sta)
+  case(1)  ! initial selection
+    if(.not. c_associated(pisa_lib)) then
+      call pisa_cfg_parser(pisa_lib_prefix, alpha, mu, lambda, dim, con)
+      pisa_lib = apisa_selector_new_c(trim(pisa_lib_name)//c_null_char, trim(pisa_lib_param)//c_null_char, &
+                                      alpha, mu, lambda, dim, con)
+      if(.not. c_associated(pisa_lib)) then
+        write(*,*) "ERROR: cannot create PISA selector ", trim(pisa_lib_name)
+        error stop
+      endif
+    endif
+    err = apisa_select_initial_c(pisa_lib, size(pisa_lib_index), pisa_lib_index, pisa_lib_f, pisa_lib_c)
+    next = 2
+  case(3)  ! selection
+    err = apisa_select_normal_c(pisa_lib, size(pisa_lib_index), pisa_lib_index, pisa_lib_f, pisa_lib_c)
+    next = 2
+  case(5)  ! variator terminated: the selector terminates too
+    call pisa_lib_free()
+    next = 7
+  case(9)  ! reset: a new selector is created at the next state 1
+    call pisa_lib_free()
+    next = 11
+  end select
+
+  if(err .ne. 0) then
+    write(*,*) "ERROR: wrong number of individuals for PISA selector ", trim(pisa_lib_name)
+    error stop
+  endif
+  pisa_lib_state = next
+end subroutine
+
 subroutine kangal_breeder(pop, sel, pool, pool_ptr_b, breeder_params)
   ! http://www.iitk.ac.in/kangal/resources.shtml
   implicit none
@@ -72,6 +72,8 @@ program moga
   !pisa vars
   character(20) prefix
   character(10) poll_str
+  character(10) mode_str
+  character(200) lib_param
   real poll
   integer polli
   integer gen_num
@@ -135,6 +137,10 @@ program moga
   call getarg(1,in_file)
   call getarg(2,prefix)
   call getarg(3,poll_str)
+  call getarg(4,mode_str)  ! 'ipc' => socket exchange with the selector (started with 'ipc' too)
+                           ! 'bin' => binary PISA files (selector started with 'bin' too)
+                           ! 'nsga2', 'spea2' or 'nsga3' => selector runs in this program, with
+  call getarg(5,lib_param) !   argument 5 the selector parameter file (nsga2_param.txt)
   read(poll_str,*) poll
   polli = floor(poll*1000)
 
@@ -157,6 +163,9 @@ program moga
       call mpi_finalize(mpierr)
       error stop
     endif
+    if(mode_str == 'ipc') call pisa_ipc_open(prefix)
+    if(mode_str == 'bin') pisa_bin_on = .true.
+    if(mode_str == 'nsga2' .or. mode_str == 'spea2' .or. mode_str == 'nsga3') call pisa_lib_open(prefix, mode_str, lib_param)
     !Clear PISA state file
     call write_state(prefix,0)
   endif
@@ -0,0 +1,456 @@
+!+
+! Program opti_benchmark
+!
+! Benchmark for the optimizers in sim_utils/optimizers (opti_de, and the C routines
+! opti_, opti_shade_ and opti_cmaes_) and for the APISA multi-objective selectors.
+!
+! Single objective runs: Each optimizer is run on each problem at each dimension
+! with a budget of evals_per_dim * n_dim merit evaluations.
+!
+! Multi-objective runs: This program acts as the PISA variator (SBX crossover and
+! polynomial mutation via kangal_breeder) and starts the selector given by each
+! mo_selector command. The selector is started with:
+!   <mo_selector> <prefix> <poll>        (ipc = F, PISA text files)
+!   <mo_selector> <prefix> <poll> bin    (ipc = F, binary = T, binary PISA files)
+!   <mo_selector> <prefix> <poll> ipc    (ipc = T, socket <prefix>sock)
+! so a command like 'ansga2 nsga2_param.txt' is needed. A mo_selector of the form
+! 'lib nsga2 nsga2_param.txt' (or 'lib spea2 ...', 'lib nsga3 ...') runs the selector in this
+! process instead (pisa_lib_open). The PISA cfg file is written by this program.
+!
+! One line is written to output_file per run with the columns:
+!   optimizer       -- Optimizer or selector name.
+!   problem         -- Problem name.
+!   n_var, n_obj    -- Number of variables and objectives.
+!   n_eval          -- Number of merit evaluations made.
+!   n_eval_target   -- Evaluations needed to reach the target. -1 => Not reached.
+!                        Single objective: merit <= so_target.
+!                        Multi-objective:  Archive average of g - g_min <= mo_target.
+!   best            -- Best merit (single objective) or final archive convergence.
+!   wall_sec        -- Wall clock time of the run.
+!   merit_sec       -- Time spent in the merit function.
+!   select_sec      -- Time waiting on the selector (multi-objective only). This includes
+!                        the polling latency (none with ipc = T). With 'lib' selectors it is
+!                        the time of the selection itself, done in write_state.
+!   overhead_sec    -- wall_sec - merit_sec - select_sec. Time spent in the optimizer itself
+!                        (or in the variator for multi-objective runs).
+!   rss_kb          -- Peak resident memory of this program during the run (-1 if not available).
+!                        The peak is reset before each run (see bench_rss_reset).
+!   select_rss_kb   -- Peak resident memory of the selector process (-1 if not available
+!                        or with 'lib' selectors).
+!
+! Usage:
+!   opti_benchmark {input_file}
+! Default input file is opti_benchmark.in.
+!-
+
+program opti_benchmark
+
+use opti_benchmark_mod
+use, intrinsic :: iso_c_binding
+
+implicit none
+
+interface
+  function opti_c (vec, gen, pop, n_vars, merit, v0, v_del) result (best) bind(c, name = 'opti_')
+    import
+    real(c_double) vec(*), v0(*), v_del(*), best
+    integer(c_int) gen, pop, n_vars
+    type (c_funptr), value :: merit
+  end function
+
+  function opti_shade_c (vec, gen, pop, n_vars, merit, v0, v_del, n_threads) result (best) bind(c, name = 'opti_shade_')
+    import
+    real(c_double) vec(*), v0(*), v_del(*), best
+    integer(c_int) gen, pop, n_vars, n_threads
+    type (c_funptr), value :: merit
+  end function
+
+  function opti_cmaes_c (vec, gen, pop, n_vars, merit, v0, v_del, n_threads, n_restart) result (best) bind(c, name = 'opti_cmaes_')
+    import
+    real(c_double) vec(*), v0(*), v_del(*), best
+    integer(c_int) gen, pop, n_vars, n_threads, n_restart
+    type (c_funptr), value :: merit
+  end function
+
+  subroutine opti_set_seed_c (seed) bind(c, name = 'opti_set_seed_')
+    import
+    integer(c_int) seed
+  end subroutine
+end interface
+
+integer, parameter :: n_max = 20
+
+type (breeder_params_struct) breeder_params
+
+real(rp) so_target, mo_target, poll, v_start, v_start_del
+real(rp), allocatable :: vec(:), v0(:), v_del(:)
+real(rp) t0, wall, merit_best
+
+integer so_dims(n_max), mo_n_obj(n_max)
+integer evals_per_dim, population_per_dim, cmaes_restarts, seed, generations, alpha, lambda
+integer i, j, k, n, iu, ios, n_pop, n_gen, status
+
+logical stop_at_target, ipc, binary, rss_ok
+
+character(40) so_optimizers(n_max), so_problems(n_max), mo_problems(n_max)
+character(100) mo_selectors(n_max)
+character(200) in_file, output_file
+character(20) prefix
+
+namelist / opti_benchmark_params / so_optimizers, so_problems, so_dims, evals_per_dim, population_per_dim, &
+              cmaes_restarts, so_target, stop_at_target, v_start, v_start_del, mo_selectors, mo_problems, &
+              mo_n_obj, generations, alpha, lambda, mo_target, poll, ipc, binary, prefix, breeder_params, seed, output_file
+
+! Defaults
+
+so_optimizers = ''
+so_problems = ''
+so_dims = 0
+evals_per_dim = 10000
+population_per_dim = 10
+cmaes_restarts = 4
+so_target = 1d-8
+stop_at_target = .true.
+v_start = 0
+v_start_del = 5
+
+mo_selectors = ''
+mo_problems = ''
+mo_n_obj = 0
+generations = 250
+alpha = 100
+lambda = 100
+mo_target = 1d-2
+poll = 0.01
+ipc = .false.
+binary = .false.
+prefix = 'BENCH_'
+breeder_params%cross_p = 0.9
+breeder_params%eta = 15
+breeder_params%mutate_p = -1      ! -1 => 1 / n_var
+breeder_params%mutate_delta = 1
+
+seed = 1
+output_file = 'opti_benchmark.dat'
+
+in_file = 'opti_benchmark.in'
+if (command_argument_count() > 0) call get_command_argument(1, in_file)
+
+open (1, file = in_file, status = 'old', iostat = ios)
+if (ios /= 0) then
+  print *, 'CANNOT OPEN INPUT FILE: ', trim(in_file)
+  stop
+endif
+read (1, nml = opti_benchmark_params)
+close (1)
+
+if (mod(lambda, 2) /= 0) then
+  print *, 'LAMBDA MUST BE EVEN FOR THE BREEDER.'
+  stop
+endif
+
+open (newunit = iu, file = output_file)
+write (iu, '(a)') '# optimizer  problem  n_var  n_obj  n_eval  n_eval_target  best  wall_sec  merit_sec  ' // &
+                  'select_sec  overhead_sec  rss_kb  select_rss_kb'
+
+!---------------------------------------------------
+! Single objective
+
+do i = 1, n_max
+  if (so_optimizers(i) == '') exit
+  do j = 1, n_max
+    if (so_problems(j) == '') exit
+    do k = 1, n_max
+      n = so_dims(k)
+      if (n == 0) exit
+
+      if (allocated(vec)) deallocate (vec, v0, v_del)
+      allocate (vec(n), v0(n), v_del(n))
+      v0 = v_start
+      v_del = v_start_del
+      vec = v0
+
+      call reseed_intrinsic(seed)
+      call opti_set_seed_c(seed)
+      call bench_reset(so_problems(j), n, so_target, evals_per_dim * n, stop_at_target)
+
+      n_pop = max(4, population_per_dim * n)
+      n_gen = evals_per_dim * n / n_pop + 1
+      rss_ok = bench_rss_reset()
+      t0 = bench_time()
+
+      select case (so_optimizers(i))
+      case ('opti_de')
+        merit_best = opti_de(vec, n_gen, n_pop, bench_de_merit, v_del, status)
+      case ('opti')
+        merit_best = opti_c(vec, n_gen, n_pop, n, c_funloc(bench_c_merit), v0, v_del)
+      case ('opti_shade')
+        merit_best = opti_shade_c(vec, n_gen, n_pop, n, c_funloc(bench_c_merit), v0, v_del, 1)
+      case ('opti_cmaes')
+        n_pop = 4 + int(3 * log(real(n)))
+        n_gen = evals_per_dim * n / n_pop + 1
+        merit_best = opti_cmaes_c(vec, n_gen, 0, n, c_funloc(bench_c_merit), v0, v_del, 1, cmaes_restarts)
+      case default
+        print *, 'UNKNOWN OPTIMIZER: ', trim(so_optimizers(i))
+        stop
+      end select
+
+      wall = bench_time() - t0
+      call write_record (so_optimizers(i), so_problems(j), n, 1, bench_count%n_eval, bench_count%n_eval_target, &
+                          bench_count%best, wall, bench_count%t_merit, 0.0_rp, self_rss_kb(rss_ok), -1_8)
+    enddo
+  enddo
+enddo
+
+!---------------------------------------------------
+! Multi-objective
+
+do i = 1, n_max
+  if (mo_selectors(i) == '') exit
+  do j = 1, n_max
+    if (mo_problems(j) == '') exit
+    if (mo_problems(j)(1:3) == 'zdt') then
+      call run_mo (mo_selectors(i), mo_problems(j), 2)
+    else
+      do k = 1, n_max
+        if (mo_n_obj(k) == 0) exit
+        call run_mo (mo_selectors(i), mo_problems(j), mo_n_obj(k))
+      enddo
+    endif
+  enddo
+enddo
+
+close (iu)
+print *, 'Results in: ', trim(output_file)
+
+!------------------------------------------------------------------------------------------
+contains
+
+subroutine write_record (optimizer, problem, n_var, n_obj, n_eval, n_eval_target, best, wall, t_merit, t_select, rss, sel_rss)
+
+character(*) optimizer, problem
+integer n_var, n_obj
+integer(8) n_eval, n_eval_target, rss, sel_rss
+real(rp) best, wall, t_merit, t_select
+
+write (iu, '(a, 2x, a, 2i6, 2i12, es14.5, 4es12.4, 2i12)') trim(optimizer), trim(problem), n_var, n_obj, &
+                  n_eval, n_eval_target, best, wall, t_merit, t_select, wall - t_merit - t_select, rss, sel_rss
+flush (iu)
+print '(a, 2x, a, 2i6, 2i12, es14.5, f10.3)', trim(optimizer), trim(problem), n_var, n_obj, &
+                  n_eval, n_eval_target, best, wall
+
+end subroutine write_record
+
+!------------------------------------------------------------------------------------------
+! Peak memory of this program since bench_rss_reset. -1 if the reset failed since VmHWM
+! is then the peak over all earlier runs.
+
+function self_rss_kb (rss_ok) result (rss)
+
+logical rss_ok
+integer(8) rss
+
+rss = -1
+if (rss_ok) rss = bench_rss_kb('self')
+
+end function self_rss_kb
+
+!------------------------------------------------------------------------------------------
+! Run one multi-objective problem with a PISA selector.
+
+subroutine run_mo (selector, problem, n_obj)
+
+type (pop_struct), allocatable :: pop(:), var(:)
+type (pool_struct), allocatable :: pool(:)
+type (breeder_params_struct) bp
+
+real(rp) t_start, t_merit, t_select, t1, conv
+real(rp), allocatable :: g_dist(:)
+
+integer n_obj, n_var, n_alive, nsel, narc, polli, gen, ix, iv, ptr_b, sta
+integer, allocatable :: sel(:), arc(:), var_ix(:)
+integer(8) n_eval, n_eval_target, sel_rss
+
+character(*) selector, problem
+character(20) pid, poll_str, ipc_arg
+character(100) name, lib_name, lib_param
+logical lib, rss_ok
+character(300) cmd
+
+n_var = mo_n_var(problem, n_obj)
+polli = max(1, nint(poll * 1000))
+write (poll_str, '(f8.3)') poll
+
+bp = breeder_params
+if (bp%mutate_p < 0) bp%mutate_p = 1.0_rp / n_var
+
+allocate (pop(alpha+lambda), var(lambda), g_dist(alpha+lambda), pool(lambda), sel(lambda), arc(alpha+lambda), var_ix(lambda))
+do ix = 1, size(pop)
+  allocate (pop(ix)%x(n_var), pop(ix)%x_phys(0), pop(ix)%o(n_obj), pop(ix)%c(0))
+  pop(ix)%name = -1
+enddo
+do ix = 1, lambda
+  allocate (pool(ix)%x(n_var))
+  pool(ix)%name = 0
+enddo
+
+call reseed_intrinsic (seed)
+n_eval = 0
+n_eval_target = -1
+t_merit = 0
+t_select = 0
+rss_ok = bench_rss_reset()
+t_start = bench_time()
+
+! Start the selector.
+
+open (1, file = trim(prefix) // 'cfg')
+write (1, '(a, i0)') 'initial_population_size ', alpha
+write (1, '(a, i0)') 'parent_set_size ', lambda
+write (1, '(a, i0)') 'offspring_set_size ', lambda
+write (1, '(a, i0)') 'objectives ', n_obj
+write (1, '(a, i0)') 'constraints ', 0
+close (1)
+
+lib = (selector(1:4) == 'lib ')
+if (lib) then
+  lib_name = adjustl(selector(5:))
+  lib_param = adjustl(lib_name(index(lib_name, ' '):))
+  lib_name = lib_name(1:index(lib_name, ' ')-1)
+  call pisa_lib_open (prefix, lib_name, lib_param)
+  call write_state (prefix, 0)
+else
+  ipc_arg = ''
+  if (ipc) then
+    call pisa_ipc_open (prefix)
+    ipc_arg = ' ipc'
+  elseif (binary) then
+    pisa_bin_on = .true.
+    ipc_arg = ' bin'
+  endif
+  call write_state (prefix, 0)
+  cmd = "sh -c 'echo $$ > " // trim(prefix) // "pid; exec " // trim(selector) // ' ' // trim(prefix) // &
+                                            ' ' // trim(adjustl(poll_str)) // trim(ipc_arg) // "' &"
+  call execute_command_line (cmd)
+endif
+
+! Initial population
+
+do ix = 1, alpha
+  call random_number(pop(ix)%x)
+  pop(ix)%name = ix
+  call mo_evaluate (problem, pop(ix), g_dist(ix), t_merit, n_eval)
+enddo
+pool(lambda)%name = alpha
+ptr_b = lambda
+
+call write_pop_pisa (pop(1:alpha), trim(prefix) // 'ini')
+t1 = bench_time()
+call write_state (prefix, 1)
+t_select = t_select + bench_time() - t1
+
+! Generation loop
+
+do gen = 1, generations
+  t1 = bench_time()
+  call block_on_pisa_status (polli, prefix)
+  t_select = t_select + bench_time() - t1
+
+  call read_pisa_indexes (prefix, 'sel', nsel, sel)
+  call read_pisa_indexes (prefix, 'arc', narc, arc)
+  call delete_the_dead (pop, arc, narc)
+
+  conv = 0
+  n_alive = 0
+  do ix = 1, size(pop)
+    if (pop(ix)%name == -1) cycle
+    conv = conv + g_dist(ix)
+    n_alive = n_alive + 1
+  enddo
+  conv = conv / max(1, n_alive)
+  if (conv <= mo_target .and. n_eval_target < 0) n_eval_target = n_eval
+  if (gen == generations) exit
+
+  call kangal_breeder (pop, sel(1:nsel), pool, ptr_b, bp)
+
+  do iv = 1, nsel
+    ix = ptr_b - nsel + iv
+    if (ix < 1) ix = ix + lambda
+    call find_empty_pop_slot (pop, var_ix(iv))
+    pop(var_ix(iv))%name = pool(ix)%name
+    pop(var_ix(iv))%x = min(1.0_rp, max(0.0_rp, pool(ix)%x))
+    call mo_evaluate (problem, pop(var_ix(iv)), g_dist(var_ix(iv)), t_merit, n_eval)
+    var(iv) = pop(var_ix(iv))
+  enddo
+
+  call write_pop_pisa (var(1:nsel), trim(prefix) // 'var')
+  t1 = bench_time()
+  call write_state (prefix, 3)
+  t_select = t_select + bench_time() - t1
+enddo
+
+! Shut down the selector.
+
+pid = ''
+if (.not. lib) then
+  open (1, file = trim(prefix) // 'pid', status = 'old', iostat = ios)
+  if (ios == 0) read (1, *, iostat = ios) pid
+  close (1)
+endif
+sel_rss = -1
+if (pid /= '') sel_rss = bench_rss_kb(pid)
+
+call write_state (prefix, 5)
+do
+  sta = poll_state(prefix)
+  if (sta == 7) exit
+  call milli_sleep (polli)
+enddo
+if (lib) then
+  call pisa_lib_close()
+  name = 'lib_' // lib_name
+else
+  if (ipc) call pisa_ipc_close()
+  pisa_bin_on = .false.
+  name = selector(1:index(selector // ' ', ' ')-1)
+  name = name(index(name, '/', back = .true.)+1:)
+endif
+call write_record (name, problem, n_var, n_obj, n_eval, n_eval_target, &
+                    conv, bench_time() - t_start, t_merit, t_select, self_rss_kb(rss_ok), sel_rss)
+
+end subroutine run_mo
+
+!------------------------------------------------------------------------------------------
+! Counted and timed evaluation of one multi-objective individual.
+
+subroutine mo_evaluate (problem, p, g_dist, t_merit, n_eval)
+
+type (pop_struct) p
+real(rp) g_dist, t_merit, t0
+integer(8) n_eval
+character(*) problem
+
+t0 = bench_time()
+call mo_value (problem, p%x, p%o, g_dist)
+t_merit = t_merit + bench_time() - t0
+n_eval = n_eval + 1
+
+end subroutine mo_evaluate
+
+!------------------------------------------------------------------------------------------
+
+subroutine reseed_intrinsic (seed)
+
+integer seed, i, n
+integer, allocatable :: seed_arr(:)
+
+call random_seed(size = n)
+allocate (seed_arr(n))
+do i = 1, n
+  seed_arr(i) = seed * i + 12345
+enddo
+call random_seed(put = seed_arr)
+
+end subroutine reseed_intrinsic
+
+end program
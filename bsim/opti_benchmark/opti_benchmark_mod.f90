@@ -0,0 +1,419 @@
+!+
+! Module opti_benchmark_mod
+!
+! Test problems and bookkeeping for the opti_benchmark program.
+!
+! Single objective problems (minimum = 0):
+!   'rosenbrock', 'rastrigin', 'ackley'
+! Rastrigin and Ackley are shifted so that the minimum is not at the origin.
+!
+! Multi-objective problems (all variables scaled to [0, 1]):
+!   'zdt1' ... 'zdt6'   Two objectives. Standard number of variables.
+!   'dtlz1' ... 'dtlz7' n_obj objectives with n_obj + k - 1 variables. k = 5, 10 or 20.
+! ZDT5 is a binary string problem. Here it is real coded: the unitation of each
+! substring is taken to be nint(n_bit * x).
+!
+! For all multi-objective problems the Pareto front is the set where the distance
+! function g has its minimum value. The convergence of a population is measured
+! by the average of g - g_min.
+!-
+
+module opti_benchmark_mod
+
+use pisa_mod
+use opti_de_mod
+
+implicit none
+
+! Evaluation bookkeeping
+
+type bench_count_struct
+  integer(8) :: n_eval = 0            ! Number of merit evaluations.
+  integer(8) :: n_eval_target = -1    ! Evaluation at which the target was first reached.
+  integer(8) :: max_eval = 0          ! Evaluation budget. 0 => No limit.
+  real(rp) :: best = 1d99             ! Best value seen.
+  real(rp) :: target = 0              ! Target value.
+  real(rp) :: t_merit = 0             ! Time spent in the merit function (sec).
+  logical :: stop_at_target = .true.  ! Signal the optimizer to stop when the target is reached.
+end type
+
+type (bench_count_struct), save :: bench_count
+
+character(40), save :: bench_problem = ''
+integer, save :: bench_n_dim = 0
+
+contains
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!+
+! Function bench_time() result (t)
+!
+! Wall clock time in seconds.
+!-
+
+function bench_time() result (t)
+
+integer(8) count, rate
+real(rp) t
+
+call system_clock(count, rate)
+t = real(count, rp) / rate
+
+end function bench_time
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!+
+! Function bench_rss_kb(pid) result (rss)
+!
+! Peak resident set size (VmHWM) of a process in kB. This is the peak since the
+! process started or, for 'self', since the last bench_rss_reset call.
+!
+! Input:
+!   pid   -- character(*): Process id. 'self' => This process.
+!
+! Output:
+!   rss   -- integer(8): Peak memory. -1 if not available (not Linux, process gone, etc.).
+!-
+
+function bench_rss_kb(pid) result (rss)
+
+character(*) pid
+character(200) line
+integer(8) rss
+integer iu, ios
+
+rss = -1
+open (newunit = iu, file = '/proc/' // trim(pid) // '/status', action = 'read', status = 'old', iostat = ios)
+if (ios /= 0) return
+
+do
+  read (iu, '(a)', iostat = ios) line
+  if (ios /= 0) exit
+  if (line(1:6) /= 'VmHWM:') cycle
+  read (line(7:), *, iostat = ios) rss
+  if (ios /= 0) rss = -1
+  exit
+enddo
+
+close (iu)
+
+end function bench_rss_kb
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!+
+! Function bench_rss_reset() result (ok)
+!
+! Reset the peak resident set size of this process to the current resident set size
+! so that bench_rss_kb('self') gives the peak of the run that follows.
+! This is done by writing 5 to /proc/self/clear_refs (Linux 4.0 and later).
+!
+! Output:
+!   ok    -- logical: True if the reset was done.
+!-
+
+function bench_rss_reset() result (ok)
+
+integer iu, ios
+logical ok
+
+ok = .false.
+open (newunit = iu, file = '/proc/self/clear_refs', action = 'write', status = 'old', iostat = ios)
+if (ios /= 0) return
+write (iu, '(a)', iostat = ios) '5'
+ok = (ios == 0)
+close (iu, iostat = ios)
+ok = (ok .and. ios == 0)
+
+end function bench_rss_reset
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!+
+! Subroutine bench_reset(problem, n_dim, target, max_eval, stop_at_target)
+!
+! Set the problem and zero the counters.
+!-
+
+subroutine bench_reset(problem, n_dim, target, max_eval, stop_at_target)
+
+character(*) problem
+integer n_dim, max_eval
+real(rp) target
+logical stop_at_target
+
+bench_problem = problem
+bench_n_dim = n_dim
+bench_count = bench_count_struct()
+bench_count%target = target
+bench_count%max_eval = max_eval
+bench_count%stop_at_target = stop_at_target
+
+end subroutine bench_reset
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!+
+! Function so_value(problem, x) result (f)
+!
+! Single objective test function value. The minimum is 0.
+!-
+
+function so_value(problem, x) result (f)
+
+character(*) problem
+real(rp) x(:), z(size(x)), f
+integer i, n
+
+n = size(x)
+do i = 1, n
+  z(i) = x(i) - 2 * sin(1.7_rp * i)
+enddo
+
+select case (problem)
+case ('rosenbrock')
+  f = 0
+  do i = 1, n-1
+    f = f + 100 * (x(i+1) - x(i)**2)**2 + (1 - x(i))**2
+  enddo
+
+case ('rastrigin')
+  f = 10 * n + sum(z**2 - 10 * cos(twopi * z))
+
+case ('ackley')
+  f = -20 * exp(-0.2_rp * sqrt(sum(z**2) / n)) - exp(sum(cos(twopi * z)) / n) + 20 + exp(1.0_rp)
+  f = max(f, 0.0_rp)
+
+case default
+  print *, 'UNKNOWN SINGLE OBJECTIVE PROBLEM: ', trim(problem)
+  stop
+end select
+
+end function so_value
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!+
+! Function bench_eval(x, end_flag) result (f)
+!
+! Counted and timed evaluation of bench_problem.
+! end_flag is set to 1 when the target is reached (if bench_count%stop_at_target)
+! or when the evaluation budget is used up.
+!-
+
+function bench_eval(x, end_flag) result (f)
+
+real(rp) x(:), f, t0
+integer end_flag
+
+t0 = bench_time()
+f = so_value(bench_problem, x)
+bench_count%t_merit = bench_count%t_merit + bench_time() - t0
+
+bench_count%n_eval = bench_count%n_eval + 1
+bench_count%best = min(bench_count%best, f)
+if (f <= bench_count%target .and. bench_count%n_eval_target < 0) bench_count%n_eval_target = bench_count%n_eval
+
+if (bench_count%stop_at_target .and. bench_count%n_eval_target > 0) end_flag = 1
+if (bench_count%max_eval > 0 .and. bench_count%n_eval >= bench_count%max_eval) end_flag = 1
+
+end function bench_eval
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+! Merit function for opti_de.
+
+function bench_de_merit(vec, status, iter_count) result (merit)
+
+real(rp) vec(:), merit
+integer status, iter_count
+
+iter_count = iter_count + 1
+merit = bench_eval(vec, status)
+
+end function bench_de_merit
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+! Merit function for the C opti routines.
+
+function bench_c_merit(vec, end_flag) result (merit) bind(c)
+
+use, intrinsic :: iso_c_binding
+
+real(c_double) vec(*), merit
+integer(c_int) end_flag
+integer flag
+
+flag = end_flag
+merit = bench_eval(vec(1:bench_n_dim), flag)
+end_flag = flag
+
+end function bench_c_merit
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!+
+! Function mo_n_var(problem, n_obj) result (n_var)
+!
+! Standard number of variables for a multi-objective problem.
+!-
+
+function mo_n_var(problem, n_obj) result (n_var)
+
+character(*) problem
+integer n_obj, n_var
+
+select case (problem)
+case ('zdt1', 'zdt2', 'zdt3');  n_var = 30
+case ('zdt4', 'zdt6');          n_var = 10
+case ('zdt5');                  n_var = 11
+case ('dtlz1');                 n_var = n_obj + 4
+case ('dtlz7');                 n_var = n_obj + 19
+case default;                   n_var = n_obj + 9
+end select
+
+end function mo_n_var
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!+
+! Subroutine mo_value(problem, x, f, g_dist)
+!
+! Multi-objective test function values (all objectives minimized).
+!
+! Input:
+!   problem   -- character(*): 'zdt1', ..., 'dtlz7'.
+!   x(:)      -- real(rp): Variables in [0, 1].
+!
+! Output:
+!   f(:)      -- real(rp): Objectives. The size of f sets the number of DTLZ objectives.
+!   g_dist    -- real(rp): g - g_min. Zero on the Pareto front.
+!-
+
+subroutine mo_value(problem, x, f, g_dist)
+
+character(*) problem
+real(rp) x(:), f(:), g_dist
+real(rp) g, h, theta(size(f)), xx(size(x))
+integer i, n, m, k
+
+n = size(x)
+m = size(f)
+k = n - m + 1
+
+select case (problem)
+case ('zdt1', 'zdt2', 'zdt3')
+  f(1) = x(1)
+  g = 1 + 9 * sum(x(2:n)) / (n - 1)
+  h = f(1) / g
+  if (problem == 'zdt1') f(2) = g * (1 - sqrt(h))
+  if (problem == 'zdt2') f(2) = g * (1 - h**2)
+  if (problem == 'zdt3') f(2) = g * (1 - sqrt(h) - h * sin(10 * pi * f(1)))
+  g_dist = g - 1
+
+case ('zdt4')
+  xx(2:n) = 10 * x(2:n) - 5
+  f(1) = x(1)
+  g = 1 + 10 * (n - 1) + sum(xx(2:n)**2 - 10 * cos(4 * pi * xx(2:n)))
+  f(2) = g * (1 - sqrt(f(1) / g))
+  g_dist = g - 1
+
+case ('zdt5')
+  f(1) = 1 + nint(30 * x(1))
+  g = 0
+  do i = 2, n
+    if (nint(5 * x(i)) < 5) then
+      g = g + 2 + nint(5 * x(i))
+    else
+      g = g + 1
+    endif
+  enddo
+  f(2) = g / f(1)
+  g_dist = g - (n - 1)
+
+case ('zdt6')
+  f(1) = 1 - exp(-4 * x(1)) * sin(6 * pi * x(1))**6
+  g = 1 + 9 * (sum(x(2:n)) / (n - 1))**0.25_rp
+  f(2) = g * (1 - (f(1) / g)**2)
+  g_dist = g - 1
+
+case ('dtlz1', 'dtlz3')
+  g = 100 * (k + sum((x(m:n) - 0.5_rp)**2 - cos(20 * pi * (x(m:n) - 0.5_rp))))
+  if (problem == 'dtlz1') then
+    do i = 1, m
+      f(i) = 0.5_rp * (1 + g) * product(x(1:m-i))
+      if (i > 1) f(i) = f(i) * (1 - x(m-i+1))
+    enddo
+  else
+    theta(1:m-1) = x(1:m-1) * pi / 2
+    call dtlz_sphere(g, theta, f)
+  endif
+  g_dist = g
+
+case ('dtlz2', 'dtlz4')
+  g = sum((x(m:n) - 0.5_rp)**2)
+  if (problem == 'dtlz2') then
+    theta(1:m-1) = x(1:m-1) * pi / 2
+  else
+    theta(1:m-1) = x(1:m-1)**100 * pi / 2
+  endif
+  call dtlz_sphere(g, theta, f)
+  g_dist = g
+
+case ('dtlz5', 'dtlz6')
+  if (problem == 'dtlz5') then
+    g = sum((x(m:n) - 0.5_rp)**2)
+  else
+    g = sum(x(m:n)**0.1_rp)
+  endif
+  theta(1) = x(1) * pi / 2
+  theta(2:m-1) = pi / (4 * (1 + g)) * (1 + 2 * g * x(2:m-1))
+  call dtlz_sphere(g, theta, f)
+  g_dist = g
+
+case ('dtlz7')
+  g = 1 + 9 * sum(x(m:n)) / k
+  f(1:m-1) = x(1:m-1)
+  h = m - sum(f(1:m-1) / (1 + g) * (1 + sin(3 * pi * f(1:m-1))))
+  f(m) = (1 + g) * h
+  g_dist = g - 1
+
+case default
+  print *, 'UNKNOWN MULTI-OBJECTIVE PROBLEM: ', trim(problem)
+  stop
+end select
+
+end subroutine mo_value
+
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+!-------------------------------------------------------------------------
+! Spherical DTLZ front: f = (1 + g) * (unit vector with angles theta(1:m-1)).
+
+subroutine dtlz_sphere(g, theta, f)
+
+real(rp) g, theta(:), f(:)
+integer i, m
+
+m = size(f)
+do i = 1, m
+  f(i) = (1 + g) * product(cos(theta(1:m-i)))
+  if (i > 1) f(i) = f(i) * sin(theta(m-i+1))
+enddo
+
+end subroutine dtlz_sphere
+
+end module
@@ -0,0 +1,163 @@
+//+
+// Weak-strong beam-beam engine. See beambeam_engine.h.
+//-
+
+#include <cmath>
+#include <algorithm>
+#include "bbi_kick_batch.h"
+#include "beambeam_engine.h"
+
+#ifdef _OPENMP
+#define OMP_PRAGMA(directive) _Pragma(#directive)
+#else
+#define OMP_PRAGMA(directive)
+#endif
+
+using namespace std;
+
+//--------------------------------------------------------------------
+// Gaussian slices with equal charge. See bbi_slice_calc.f90.
+
+void Beambeam_engine::set_gaussian_slices(int n_slice, double sig_x, double sig_y, double sig_z,
+                                          double x_center, double y_center, double z_offset) {
+  slice.resize(n_slice);
+  z_slice.resize(n_slice);
+
+  for (int i = 0; i < n_slice; i++) {
+    CPP_strong_beam& sb = slice[i];
+    sb.ix_slice = i + 1;
+    sb.x_center = x_center;  sb.y_center = y_center;
+    sb.x_sigma = sig_x;      sb.y_sigma = sig_y;
+    sb.dx = 0;               sb.dy = 0;
+
+    if (n_slice == 1) {
+      z_slice[i] = z_offset;
+      continue;
+    }
+
+    // Invert the normal distribution: P(z_norm) = (i + 0.5) / n_slice.
+
+    double p = (i + 0.5) / n_slice;
+    double lo = -5, hi = 5;
+    while (hi - lo > 1e-12) {
+      double z = (lo + hi) / 2;
+      if (0.5 * erfc(-z / sqrt(2.0)) < p) lo = z; else hi = z;
+    }
+    z_slice[i] = sig_z * (lo + hi) / 2 + z_offset;
+  }
+}
+
+//--------------------------------------------------------------------
+// See strong_beam_sigma_calc.f90. The slice sigmas are taken to be the sigmas at the IP.
+
+void Beambeam_engine::sigma_calc(double s, double sigma[2], double dsigma_ds[2]) const {
+  double beta0[2] = {beta_a, beta_b}, alpha0[2] = {alpha_a, alpha_b};
+
+  for (int i = 0; i < 2; i++) {
+    if (beta0[i] == 0) {
+      sigma[i] = 1;
+      dsigma_ds[i] = 0;
+      continue;
+    }
+    double gamma0 = (1 + alpha0[i] * alpha0[i]) / beta0[i];
+    double beta = beta0[i] - 2 * alpha0[i] * s + gamma0 * s * s;
+    sigma[i] = sqrt(beta / beta0[i]);   // Relative to the IP sigma
+    dsigma_ds[i] = -(alpha0[i] - s * gamma0) * sigma[i] / beta;
+  }
+}
+
+//--------------------------------------------------------------------
+
+void Beambeam_engine::track(Bunch_soa& bunch) const {
+  const long block = 256;
+  long n_part = bunch.size();
+  long n_block = (n_part + block - 1) / block;
+
+  OMP_PRAGMA(omp parallel for schedule(dynamic))
+  for (long ib = 0; ib < n_block; ib++) {
+    long i0 = ib * block;
+    track_block(bunch, i0, min(block, n_part - i0));
+  }
+}
+
+//--------------------------------------------------------------------
+// Track particles i0 to i0+n-1 through all slices.
+
+void Beambeam_engine::track_block(Bunch_soa& bunch, long i0, long n) const {
+  int n_slice = slice.size();
+  vector<double> s_now(n, 0), dx(n), dy(n), nk_x(n), nk_y(n);
+  vector<double> dnk_xx(n), dnk_xy(n), dnk_yx(n), dnk_yy(n);
+  vector<double> sig_x(n), sig_y(n), dsig_x(n), dsig_y(n);
+  vector<long> ix(n);
+
+  // Only live particles are tracked.
+
+  long m = 0;
+  for (long i = 0; i < n; i++) {
+    if (bunch.alive(i0 + i)) ix[m++] = i0 + i;
+  }
+  if (m == 0) return;
+
+  for (int is = 0; is < n_slice; is++) {
+    const CPP_strong_beam& sb = slice[is];
+    bool hourglass = (beta_a != 0 || beta_b != 0);
+
+    // Drift to the collision point with the slice.
+
+    for (long j = 0; j < m; j++) {
+      long ip = ix[j];
+      double s_coll = 0.5 * (bunch.z[ip] + z_slice[is]);
+      double ds = s_coll - s_now[j];
+      double p_rel = 1 + bunch.pz[ip];
+      double pz_s = sqrt(p_rel * p_rel - bunch.px[ip] * bunch.px[ip] - bunch.py[ip] * bunch.py[ip]);
+      bunch.x[ip] += ds * bunch.px[ip] / pz_s;
+      bunch.y[ip] += ds * bunch.py[ip] / pz_s;
+      bunch.z[ip] -= ds * (p_rel / pz_s - 1);
+      s_now[j] = s_coll;
+
+      double sig[2] = {1, 1}, dsig[2] = {0, 0};
+      if (hourglass) sigma_calc(s_coll, sig, dsig);
+      sig_x[j] = sb.x_sigma * sig[0];   dsig_x[j] = sb.x_sigma * dsig[0];
+      sig_y[j] = sb.y_sigma * sig[1];   dsig_y[j] = sb.y_sigma * dsig[1];
+      dx[j] = bunch.x[ip] - sb.x_center;
+      dy[j] = bunch.y[ip] - sb.y_center;
+    }
+
+    // Kick
+
+    bbi_kick_batch(&dx[0], &dy[0], &sig_x[0], &sig_y[0], m, &nk_x[0], &nk_y[0],
+                   &dnk_xx[0], &dnk_xy[0], &dnk_yx[0], &dnk_yy[0], use_w_table);
+
+    for (long j = 0; j < m; j++) {
+      long ip = ix[j];
+      double coef = -strength / (2 * Bmad::PI * (sig_x[j] + sig_y[j])) / n_slice;  // bbi_const / n_slice
+      double kx = nk_x[j] * coef, ky = nk_y[j] * coef;
+      double px_old = bunch.px[ip], py_old = bunch.py[ip];
+      double p_rel = 1 + bunch.pz[ip];
+      double e_factor = 0.25 / p_rel;
+
+      bunch.pz[ip] += e_factor * (kx * (kx + 2 * px_old) + ky * (ky + 2 * py_old)) +
+                      0.5 * coef * (dnk_xx[j] * dsig_x[j] * sig_x[j] + dnk_yy[j] * dsig_y[j] * sig_y[j]);
+
+      double pc = bunch.p0c[ip] * (1 + bunch.pz[ip]);
+      double new_beta = pc / sqrt(pc * pc + mc2 * mc2);
+      bunch.z[ip] *= new_beta / bunch.beta[ip];
+      bunch.beta[ip] = new_beta;
+
+      bunch.px[ip] = px_old + kx;
+      bunch.py[ip] = py_old + ky;
+    }
+  }
+
+  // Drift back to the IP.
+
+  for (long j = 0; j < m; j++) {
+    long ip = ix[j];
+    double ds = -s_now[j];
+    double p_rel = 1 + bunch.pz[ip];
+    double pz_s = sqrt(p_rel * p_rel - bunch.px[ip] * bunch.px[ip] - bunch.py[ip] * bunch.py[ip]);
+    bunch.x[ip] += ds * bunch.px[ip] / pz_s;
+    bunch.y[ip] += ds * bunch.py[ip] / pz_s;
+    bunch.z[ip] -= ds * (p_rel / pz_s - 1);
+  }
+}
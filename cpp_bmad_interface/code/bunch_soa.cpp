@@ -0,0 +1,62 @@
+//+
+// Bunch_soa methods. See bunch_soa.h.
+//-
+
+#include "bunch_soa.h"
+
+//--------------------------------------------------------------------
+
+void Bunch_soa::resize(size_t n) {
+  x.resize(n);  px.resize(n);
+  y.resize(n);  py.resize(n);
+  z.resize(n);  pz.resize(n);
+  charge.resize(n);
+  beta.resize(n);
+  p0c.resize(n);
+  state.resize(n, Bmad::ALIVE);
+}
+
+//--------------------------------------------------------------------
+
+int Bunch_soa::n_alive() const {
+  int n = 0;
+  for (size_t i = 0; i < size(); i++) {
+    if (alive(i)) n++;
+  }
+  return n;
+}
+
+//--------------------------------------------------------------------
+
+void Bunch_soa::load(const CPP_bunch& bunch) {
+  size_t n = bunch.particle.size();
+  resize(n);
+
+  for (size_t i = 0; i < n; i++) {
+    const CPP_coord& p = bunch.particle[i];
+    x[i] = p.vec[0];  px[i] = p.vec[1];
+    y[i] = p.vec[2];  py[i] = p.vec[3];
+    z[i] = p.vec[4];  pz[i] = p.vec[5];
+    charge[i] = p.charge;
+    beta[i]   = p.beta;
+    p0c[i]    = p.p0c;
+    state[i]  = p.state;
+  }
+}
+
+//--------------------------------------------------------------------
+// Only the coordinates that the engines can change are copied back.
+
+void Bunch_soa::store(CPP_bunch& bunch) const {
+  size_t n = bunch.particle.size();
+  if (n > size()) n = size();
+
+  for (size_t i = 0; i < n; i++) {
+    CPP_coord& p = bunch.particle[i];
+    p.vec[0] = x[i];  p.vec[1] = px[i];
+    p.vec[2] = y[i];  p.vec[3] = py[i];
+    p.vec[4] = z[i];  p.vec[5] = pz[i];
+    p.beta   = beta[i];
+    p.state  = state[i];
+  }
+}
@@ -0,0 +1,875 @@
+//+
+// CSR engines. See csr_engine.h.
+//-
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include "csr_engine.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#define OMP_PRAGMA(directive) _Pragma(#directive)
+#else
+#define OMP_PRAGMA(directive)
+#endif
+
+using namespace std;
+
+//--------------------------------------------------------------------
+//--------------------------------------------------------------------
+// Csr1d_engine
+
+Csr1d_engine::Csr1d_engine(const CPP_space_charge_common& sc_com) :
+  n_bin(sc_com.n_bin),
+  particle_bin_span(sc_com.particle_bin_span),
+  sc_min_in_bin(sc_com.sc_min_in_bin),
+  lsc_sigma_cutoff(sc_com.lsc_sigma_cutoff),
+  dz_slice(0),
+  z_min(0)
+  {}
+
+//--------------------------------------------------------------------
+// Contribution to the charge in a bin [zb0, zb1] from a particle with a triangular
+// longitudinal shape. Same as particle_overlap_in_bin in csr_and_space_charge_mod.f90.
+
+double Csr1d_engine::overlap_in_bin(double zp_center, double dz_particle, double zb0, double zb1) const {
+  double zp0 = zp_center - dz_particle / 2;
+  double zp1 = zp_center + dz_particle / 2;
+  double dz2 = dz_particle * dz_particle;
+  double overlap = 0;
+
+  // Left triangular half of the particle
+
+  double z1 = max(zp0, zb0);
+  double z2 = min(zp_center, zb1);
+  if (z2 > z1) overlap = 2 * ((z2 - zp0) * (z2 - zp0) - (z1 - zp0) * (z1 - zp0)) / dz2;
+
+  // Right triangular half
+
+  z1 = max(zp_center, zb0);
+  z2 = min(zp1, zb1);
+  if (z2 > z1) overlap += 2 * ((z1 - zp1) * (z1 - zp1) - (z2 - zp1) * (z2 - zp1)) / dz2;
+
+  return overlap;
+}
+
+//--------------------------------------------------------------------
+// Parallel version of csr_bin_particles.
+// Each thread accumulates into its own bin arrays which are then summed.
+
+bool Csr1d_engine::bin_particles(const Bunch_soa& bunch) {
+  long n_part = bunch.size();
+  int span = particle_bin_span + 2;
+
+  int n_bin_eff = n_bin - 2 - (particle_bin_span + 1);
+  if (n_bin_eff < 1) {
+    cerr << "ERROR IN CSR1D_ENGINE: NUMBER OF CSR BINS TOO SMALL: " << n_bin << endl;
+    cerr << "      MUST BE GREATER THAN 3 + PARTICLE_BIN_SPAN." << endl;
+    return false;
+  }
+
+  double z_maxval = -HUGE_VAL, z_minval = HUGE_VAL;
+
+  OMP_PRAGMA(omp parallel for reduction(max:z_maxval) reduction(min:z_minval))
+  for (long ip = 0; ip < n_part; ip++) {
+    if (!bunch.alive(ip)) continue;
+    if (bunch.z[ip] > z_maxval) z_maxval = bunch.z[ip];
+    if (bunch.z[ip] < z_minval) z_minval = bunch.z[ip];
+  }
+
+  double dz = z_maxval - z_minval;
+  if (!(dz > 0)) {
+    cerr << "ERROR IN CSR1D_ENGINE: LONGITUDINAL WIDTH OF BEAM IS ZERO!" << endl;
+    return false;
+  }
+
+  dz_slice = 1.0000001 * dz / n_bin_eff;    // to prevent round off problems
+  z_min = (z_maxval + z_minval) / 2 - n_bin * dz_slice / 2;
+  double dz_particle = particle_bin_span * dz_slice;
+
+  z_center.assign(n_bin, 0);
+  charge.assign(n_bin, 0);
+  n_particle.assign(n_bin, 0);
+  x0.assign(n_bin, 0);
+  y0.assign(n_bin, 0);
+  sig_x.assign(n_bin, 0);
+  sig_y.assign(n_bin, 0);
+  dcharge_density_dz.assign(n_bin, 0);
+  edge_dcharge_density_dz.assign(n_bin, 0);
+  kick_csr.assign(n_bin, 0);
+
+  for (int ib = 0; ib < n_bin; ib++) z_center[ib] = z_min + (ib + 0.5) * dz_slice;
+
+  // Charge and transverse center in each bin
+
+  OMP_PRAGMA(omp parallel)
+  {
+    vector<double> n_loc(n_bin, 0), q_loc(n_bin, 0), x_loc(n_bin, 0), y_loc(n_bin, 0);
+
+    OMP_PRAGMA(omp for nowait)
+    for (long ip = 0; ip < n_part; ip++) {
+      if (!bunch.alive(ip)) continue;
+      double zp = bunch.z[ip];
+      long ix0 = lround((zp - dz_particle / 2 - z_min) / dz_slice) - 1;
+      for (int j = 0; j < span; j++) {
+        long ib = ix0 + j;
+        if (ib < 0 || ib >= n_bin) continue;
+        double zb0 = z_min + ib * dz_slice;
+        double f = overlap_in_bin(zp, dz_particle, zb0, zb0 + dz_slice);
+        if (f == 0) continue;
+        double q = f * bunch.charge[ip];
+        n_loc[ib] += f;
+        q_loc[ib] += q;
+        x_loc[ib] += bunch.x[ip] * q;
+        y_loc[ib] += bunch.y[ip] * q;
+      }
+    }
+
+    OMP_PRAGMA(omp critical)
+    for (int ib = 0; ib < n_bin; ib++) {
+      n_particle[ib] += n_loc[ib];
+      charge[ib] += q_loc[ib];
+      x0[ib] += x_loc[ib];
+      y0[ib] += y_loc[ib];
+    }
+  }
+
+  double dz2 = dz_slice * dz_slice;
+
+  for (int ib = 0; ib < n_bin; ib++) {
+    if (ib != 0) edge_dcharge_density_dz[ib] = (charge[ib] - charge[ib-1]) / dz2;
+    if (ib == 0)
+      dcharge_density_dz[ib] = (charge[ib+1] - charge[ib]) / dz2;
+    else if (ib == n_bin - 1)
+      dcharge_density_dz[ib] = (charge[ib] - charge[ib-1]) / dz2;
+    else
+      dcharge_density_dz[ib] = (charge[ib+1] - charge[ib-1]) / (2 * dz2);
+
+    if (charge[ib] == 0) continue;
+    x0[ib] /= charge[ib];
+    y0[ib] /= charge[ib];
+  }
+
+  // Sigmas. Abs(x-x0) is used instead of (x-x0)^2 to lessen the effect of non-Gaussian tails.
+
+  OMP_PRAGMA(omp parallel)
+  {
+    vector<double> sx_loc(n_bin, 0), sy_loc(n_bin, 0);
+
+    OMP_PRAGMA(omp for nowait)
+    for (long ip = 0; ip < n_part; ip++) {
+      if (!bunch.alive(ip)) continue;
+      double zp = bunch.z[ip];
+      long ix0 = lround((zp - dz_particle / 2 - z_min) / dz_slice) - 1;
+      for (int j = 0; j < span; j++) {
+        long ib = ix0 + j;
+        if (ib < 0 || ib >= n_bin) continue;
+        double zb0 = z_min + ib * dz_slice;
+        double q = overlap_in_bin(zp, dz_particle, zb0, zb0 + dz_slice) * bunch.charge[ip];
+        sx_loc[ib] += fabs(bunch.x[ip] - x0[ib]) * q;
+        sy_loc[ib] += fabs(bunch.y[ip] - y0[ib]) * q;
+      }
+    }
+
+    OMP_PRAGMA(omp critical)
+    for (int ib = 0; ib < n_bin; ib++) {
+      sig_x[ib] += sx_loc[ib];
+      sig_y[ib] += sy_loc[ib];
+    }
+  }
+
+  double charge_tot = 0, sig_x_ave = 0, sig_y_ave = 0;
+  double f = sqrt(Bmad::PI / 2);  // Corrects for |x - x0| being used instead of (x - x0)^2.
+
+  for (int ib = 0; ib < n_bin; ib++) {
+    if (n_particle[ib] < sc_min_in_bin) continue;
+    sig_x[ib] = f * sig_x[ib] / charge[ib];
+    sig_y[ib] = f * sig_y[ib] / charge[ib];
+    charge_tot += charge[ib];
+    // As csr_bin_particles, which assigns rather than sums the averages.
+    sig_x_ave = sig_x[ib] * charge[ib];
+    sig_y_ave = sig_y[ib] * charge[ib];
+  }
+
+  if (charge_tot == 0) {   // Not enough particles for calc
+    sig_x.assign(n_bin, 1);
+    sig_y.assign(n_bin, 1);
+    return true;
+  }
+
+  sig_x_ave /= charge_tot;
+  sig_y_ave /= charge_tot;
+
+  // At the ends, for bins where there are not enough particles to calculate sigma, use
+  // the sigmas of the nearest bin that has valid sigmas.
+
+  for (int ib = n_bin/2 - 1; ib < n_bin; ib++) {
+    if (n_particle[ib] < sc_min_in_bin) {
+      sig_x[ib] = sig_x[ib-1];
+      sig_y[ib] = sig_y[ib-1];
+    } else {
+      sig_x[ib] = max(sig_x[ib], sig_x_ave * lsc_sigma_cutoff);
+      sig_y[ib] = max(sig_y[ib], sig_y_ave * lsc_sigma_cutoff);
+    }
+  }
+
+  for (int ib = n_bin/2 - 1; ib >= 0; ib--) {
+    if (n_particle[ib] < sc_min_in_bin) {
+      sig_x[ib] = sig_x[ib+1];
+      sig_y[ib] = sig_y[ib+1];
+    } else {
+      sig_x[ib] = max(sig_x[ib], sig_x_ave * lsc_sigma_cutoff);
+      sig_y[ib] = max(sig_y[ib], sig_y_ave * lsc_sigma_cutoff);
+    }
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+// Steady state source/kick geometry in a bend of radius rho = 1/g_bend.
+// The source point is an angle phi behind the kick point. With L = chord length and
+// Ls = arc length, the particle separation is z = (Ls - L) + L / (2 gamma^2).
+
+static double one_minus_sinc_half(double phi) {
+  // (phi - 2 sin(phi/2)) computed without cancellation for small phi.
+  if (phi < 1e-2) {
+    double p2 = phi * phi;
+    return phi * p2 / 24 * (1 - p2 / 80 * (1 - p2 / 168));
+  }
+  return phi - 2 * sin(phi / 2);
+}
+
+static double steady_state_phi(double z, double rho, double gamma2) {
+  double lo = 0, hi = Bmad::PI;
+  double phi = pow(24 * z / rho, 1.0/3.0);
+  if (phi > hi) phi = hi / 2;
+
+  for (int i = 0; i < 100; i++) {
+    double f = rho * (one_minus_sinc_half(phi) + sin(phi / 2) / gamma2) - z;
+    if (f > 0) hi = phi; else lo = phi;
+    double df = rho * (1 - cos(phi / 2) + cos(phi / 2) / (2 * gamma2));
+    double phi_new = phi - f / df;
+    if (!(phi_new > lo && phi_new < hi)) phi_new = (lo + hi) / 2;
+    if (fabs(phi_new - phi) < 1e-15 * phi) return phi_new;
+    phi = phi_new;
+  }
+
+  return phi;
+}
+
+// I_csr with kick_factor = 1. See I_csr in csr_and_space_charge_mod.f90.
+
+static double steady_state_i_csr(double z, double rho, double gamma2) {
+  double phi = steady_state_phi(z, rho, gamma2);
+  double L = 2 * rho * sin(phi / 2);
+  double dL = rho * one_minus_sinc_half(phi);
+  double theta = phi / 2;
+  return -2 * (dL / z + gamma2 * theta * theta / (1 + gamma2 * theta * theta)) / L;
+}
+
+//--------------------------------------------------------------------
+// The I_csr(z) table is log spaced in z and interpolated linearly in log(-I_csr) which is
+// nearly exact since I_csr ~ z^(-1/3) in steady state. Points outside of the table are
+// computed directly.
+
+const vector<double>& Csr1d_engine::steady_state_kernel(int ix_ele, double g_bend, double gamma) {
+  const int n_per_decade = 200;
+  double gamma2 = gamma * gamma;
+
+  Kernel_table& tab = kernel_cache[ix_ele];
+
+  if (tab.i_csr.empty() || tab.g_bend != g_bend || tab.gamma != gamma) {
+    tab.g_bend = g_bend;
+    tab.gamma = gamma;
+    tab.dz_kernel = -1;
+    tab.i_csr.clear();
+
+    if (g_bend != 0) {
+      double rho = 1 / fabs(g_bend);
+      double z_lo = 1e-4 * dz_slice;
+      double z_hi = rho * (Bmad::PI - 2 + 1 / gamma2);   // z at phi = pi
+      if (z_lo <= 0 || z_lo >= z_hi) z_lo = 1e-10 * z_hi;
+      int n_tab = int(n_per_decade * log10(z_hi / z_lo)) + 2;
+      tab.log_z0 = log(z_lo);
+      tab.dlog_z = log(z_hi / z_lo) / (n_tab - 1);
+      tab.i_csr.resize(n_tab);
+
+      OMP_PRAGMA(omp parallel for)
+      for (int i = 0; i < n_tab; i++) {
+        double z = exp(tab.log_z0 + i * tab.dlog_z);
+        tab.i_csr[i] = log(-steady_state_i_csr(z, rho, gamma2));
+      }
+    }
+  }
+
+  if (tab.dz_kernel == dz_slice && int(tab.kernel.size()) == n_bin) return tab.kernel;
+
+  tab.dz_kernel = dz_slice;
+  tab.kernel.assign(n_bin, 0);
+  if (g_bend == 0) return tab.kernel;
+
+  double rho = 1 / fabs(g_bend);
+  int n_tab = tab.i_csr.size();
+  vector<double> i_csr(n_bin + 1, 0);
+
+  OMP_PRAGMA(omp parallel for)
+  for (int k = 1; k <= n_bin; k++) {
+    double z = k * dz_slice;
+    double u = (log(z) - tab.log_z0) / tab.dlog_z;
+    int iu = int(floor(u));
+    if (iu < 0 || iu >= n_tab - 1) {
+      i_csr[k] = steady_state_i_csr(z, rho, gamma2);
+    } else {
+      double r = u - iu;
+      i_csr[k] = -exp((1 - r) * tab.i_csr[iu] + r * tab.i_csr[iu+1]);
+    }
+  }
+
+  // First bin uses the analytic integral from z = 0. The rest use the trapezoidal rule.
+
+  double phi = steady_state_phi(dz_slice, rho, gamma2);
+  double Ls = rho * phi;
+  tab.kernel[0] = -((g_bend * Ls / 2) * (g_bend * Ls / 2) - log(2 * gamma2 * dz_slice / Ls) / gamma2);
+
+  for (int k = 2; k <= n_bin; k++) {
+    tab.kernel[k-1] = (i_csr[k] + i_csr[k-1]) * dz_slice / 2;
+  }
+
+  return tab.kernel;
+}
+
+//--------------------------------------------------------------------
+
+void Csr1d_engine::calc_kicks(const vector<double>& kernel, double coef) {
+  if (int(kernel.size()) < n_bin) {
+    cerr << "ERROR IN CSR1D_ENGINE: KERNEL ARRAY TOO SMALL: " << kernel.size() << endl;
+    return;
+  }
+  calc_kicks(&kernel[0], coef);
+}
+
+void Csr1d_engine::calc_kicks(const double* kernel, double coef) {
+  kick_csr.assign(n_bin, 0);
+
+  OMP_PRAGMA(omp parallel for schedule(dynamic, 16))
+  for (int i = 0; i < n_bin; i++) {
+    double sum = 0;
+    for (int j = 0; j <= i; j++) sum += kernel[i-j] * edge_dcharge_density_dz[j];
+    kick_csr[i] = coef * sum;
+  }
+}
+
+//--------------------------------------------------------------------
+// A weighted average is used so that the kick varies smoothly with z.
+
+void Csr1d_engine::apply_kicks(Bunch_soa& bunch) const {
+  long n_part = bunch.size();
+
+  OMP_PRAGMA(omp parallel for)
+  for (long ip = 0; ip < n_part; ip++) {
+    if (!bunch.alive(ip)) continue;
+    double zp = bunch.z[ip];
+    int i0 = int((zp - z_center[0]) / dz_slice);
+    if (i0 < 0 || i0 >= n_bin - 1) continue;
+    double r1 = (zp - z_center[i0]) / dz_slice;
+    bunch.pz[ip] += (1 - r1) * kick_csr[i0] + r1 * kick_csr[i0+1];
+  }
+}
+
+//--------------------------------------------------------------------
+//--------------------------------------------------------------------
+// Csr3d_engine
+
+Csr3d_engine::Csr3d_engine(const CPP_space_charge_common& sc_com) :
+  nx(sc_com.csr3d_mesh_size[0]),
+  ny(sc_com.csr3d_mesh_size[1]),
+  nz(sc_com.csr3d_mesh_size[2]),
+  green_valid(false)
+{
+  nx2 = 2 * nx;  ny2 = 2 * ny;  nz2 = 2 * nz;
+  size_t n2 = size_t(nx2) * ny2 * nz2;
+
+  for (int i = 0; i < 3; i++) {
+    delta[i] = r_min[i] = green_delta[i] = 0;
+    wake[i].assign(size_t(nx) * ny * nz, 0);
+  }
+  density.assign(size_t(nx) * ny * nz, 0);
+
+#ifdef NO_USE_FFTW
+  for (int i = 0; i < 3; i++) green_fft[i] = new csr_complex[n2];
+  work = new csr_complex[n2];
+  density_fft = new csr_complex[n2];
+
+#else
+  for (int i = 0; i < 3; i++) green_fft[i] = fftw_alloc_complex(n2);
+  work = fftw_alloc_complex(n2);
+  density_fft = fftw_alloc_complex(n2);
+
+#ifdef _OPENMP
+  static bool threads_init = false;
+  if (!threads_init) {
+    fftw_init_threads();
+    threads_init = true;
+  }
+  fftw_plan_with_nthreads(omp_get_max_threads());
+#endif
+
+  // Plans are made in place on work and are reused with fftw_execute_dft on the other
+  // (identically allocated) arrays.
+
+  plan_forward  = fftw_plan_dft_3d(nz2, ny2, nx2, work, work, FFTW_FORWARD, FFTW_MEASURE);
+  plan_backward = fftw_plan_dft_3d(nz2, ny2, nx2, work, work, FFTW_BACKWARD, FFTW_MEASURE);
+#endif
+}
+
+//--------------------------------------------------------------------
+
+Csr3d_engine::~Csr3d_engine() {
+#ifdef NO_USE_FFTW
+  delete[] work;
+  delete[] density_fft;
+  for (int i = 0; i < 3; i++) delete[] green_fft[i];
+#else
+  fftw_destroy_plan(plan_forward);
+  fftw_destroy_plan(plan_backward);
+  fftw_free(work);
+  fftw_free(density_fft);
+  for (int i = 0; i < 3; i++) fftw_free(green_fft[i]);
+#endif
+}
+
+//--------------------------------------------------------------------
+// Unnormalized in place 3D FFT with the sign convention of FFTW: direction = -1 is
+// FFTW_FORWARD and +1 is FFTW_BACKWARD.
+
+#ifdef NO_USE_FFTW
+
+// Built in 1D transform: radix 2 for power of 2 lengths (the default mesh sizes) and a
+// direct sum otherwise.
+
+static void fft_1d(vector< complex<double> >& a, int direction) {
+  int n = a.size();
+
+  if (n & (n - 1)) {
+    vector< complex<double> > b(n);
+    for (int k = 0; k < n; k++) {
+      for (int j = 0; j < n; j++) b[k] += a[j] * polar(1.0, direction * 2 * M_PI * ((long(j) * k) % n) / n);
+    }
+    a.swap(b);
+    return;
+  }
+
+  for (int i = 1, j = 0; i < n; i++) {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) swap(a[i], a[j]);
+  }
+
+  for (int len = 2; len <= n; len <<= 1) {
+    for (int i = 0; i < n; i += len) {
+      for (int j = 0; j < len / 2; j++) {
+        complex<double> w = polar(1.0, direction * 2 * M_PI * j / len);
+        complex<double> u = a[i+j], v = a[i+j+len/2] * w;
+        a[i+j] = u + v;
+        a[i+j+len/2] = u - v;
+      }
+    }
+  }
+}
+
+void Csr3d_engine::fft(csr_complex* a, int direction) {
+  int n[3] = {nx2, ny2, nz2};
+  size_t stride[3] = {1, size_t(nx2), size_t(nx2) * ny2};
+  size_t n2 = size_t(nx2) * ny2 * nz2;
+
+  for (int ax = 0; ax < 3; ax++) {
+    long n_line = n2 / n[ax];
+    size_t s = stride[ax];
+
+    OMP_PRAGMA(omp parallel)
+    {
+      vector< complex<double> > line(n[ax]);
+
+      OMP_PRAGMA(omp for)
+      for (long il = 0; il < n_line; il++) {
+        size_t i0 = (il / s) * s * n[ax] + il % s;   // First element of line il.
+        for (int i = 0; i < n[ax]; i++) line[i] = complex<double>(a[i0+i*s][0], a[i0+i*s][1]);
+        fft_1d(line, direction);
+        for (int i = 0; i < n[ax]; i++) {
+          a[i0+i*s][0] = line[i].real();
+          a[i0+i*s][1] = line[i].imag();
+        }
+      }
+    }
+  }
+}
+
+#else
+
+void Csr3d_engine::fft(csr_complex* a, int direction) {
+  fftw_execute_dft(direction < 0 ? plan_forward : plan_backward, a, a);
+}
+
+#endif
+
+//--------------------------------------------------------------------
+// Cloud-in-cell deposition. The mesh spacing is quantized upward to a power of 2^(1/16)
+// and the mesh is centered on the bunch.
+
+bool Csr3d_engine::deposit(const Bunch_soa& bunch) {
+  long n_part = bunch.size();
+  if (n_part == 0) return false;
+  const double* r[3] = {&bunch.x[0], &bunch.y[0], &bunch.z[0]};
+  int n_mesh[3] = {nx, ny, nz};
+  double lo[3], hi[3];
+
+  for (int i = 0; i < 3; i++) {
+    double lo_i = HUGE_VAL, hi_i = -HUGE_VAL;
+    OMP_PRAGMA(omp parallel for reduction(max:hi_i) reduction(min:lo_i))
+    for (long ip = 0; ip < n_part; ip++) {
+      if (!bunch.alive(ip)) continue;
+      if (r[i][ip] < lo_i) lo_i = r[i][ip];
+      if (r[i][ip] > hi_i) hi_i = r[i][ip];
+    }
+    lo[i] = lo_i;  hi[i] = hi_i;
+  }
+
+  if (lo[0] > hi[0]) return false;  // No live particles
+
+  for (int i = 0; i < 3; i++) {
+    double d = (hi[i] - lo[i]) / (n_mesh[i] - 1);
+    if (d == 0) d = 1e-10;
+    d *= 1 + 2e-6;   // Small padding to protect against indexing errors
+    delta[i] = pow(2.0, ceil(16 * log2(d)) / 16);
+    r_min[i] = (hi[i] + lo[i]) / 2 - delta[i] * (n_mesh[i] - 1) / 2;
+  }
+
+  size_t n_cell = size_t(nx) * ny * nz;
+  density.assign(n_cell, 0);
+
+  OMP_PRAGMA(omp parallel)
+  {
+    vector<double> rho_loc(n_cell, 0);
+
+    OMP_PRAGMA(omp for nowait)
+    for (long ip = 0; ip < n_part; ip++) {
+      if (!bunch.alive(ip)) continue;
+      double u = (bunch.x[ip] - r_min[0]) / delta[0];
+      double v = (bunch.y[ip] - r_min[1]) / delta[1];
+      double w = (bunch.z[ip] - r_min[2]) / delta[2];
+      int i = min(int(u), nx - 2), j = min(int(v), ny - 2), k = min(int(w), nz - 2);
+      double fu = u - i, fv = v - j, fw = w - k;
+      double q = bunch.charge[ip];
+
+      for (int dk = 0; dk < 2; dk++) {
+        double wk = dk ? fw : 1 - fw;
+        for (int dj = 0; dj < 2; dj++) {
+          double wj = dj ? fv : 1 - fv;
+          size_t ix = (size_t(k + dk) * ny + (j + dj)) * nx + i;
+          rho_loc[ix]   += q * wk * wj * (1 - fu);
+          rho_loc[ix+1] += q * wk * wj * fu;
+        }
+      }
+    }
+
+    OMP_PRAGMA(omp critical)
+    for (size_t ic = 0; ic < n_cell; ic++) density[ic] += rho_loc[ic];
+  }
+
+  double vol = delta[0] * delta[1] * delta[2];
+  for (size_t ic = 0; ic < n_cell; ic++) density[ic] /= vol;
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+// See csr3d_steady_state_solver in csr3d_mod.f90.
+
+void Csr3d_engine::solve(double gamma, double rho) {
+  // 1/(4 pi eps0) as in csr3d_mod, where c^2 is formed from a default (single precision) real literal.
+  const double fpei = double(299792458.0f * 299792458.0f) * 1.00000000055e-7;
+  size_t n2 = size_t(nx2) * ny2 * nz2;
+  double dz = delta[2];
+
+  // d/dz density -> zero padded complex array. The end point stencils are those of csr3d_mod,
+  // whose (3/2) and (1/2) coefficients are integer divisions (1 and 0).
+
+  for (size_t i = 0; i < n2; i++) density_fft[i][0] = density_fft[i][1] = 0;
+
+  OMP_PRAGMA(omp parallel for)
+  for (int k = 0; k < nz; k++) {
+    for (int j = 0; j < ny; j++) {
+      for (int i = 0; i < nx; i++) {
+        #define RHO(kk) density[(size_t(kk) * ny + j) * nx + i]
+        double d;
+        if (k == 0)
+          d = (-RHO(0) + 2 * RHO(1)) / dz;
+        else if (k == nz - 1)
+          d = (-2 * RHO(nz-2) + RHO(nz-1)) / dz;
+        else
+          d = (RHO(k+1) - RHO(k-1)) / (2 * dz);
+        #undef RHO
+        density_fft[(size_t(k) * ny2 + j) * nx2 + i][0] = d;
+      }
+    }
+  }
+
+  fft(density_fft, -1);
+
+  if (!green_valid || gamma != green_gamma || rho != green_rho ||
+      delta[0] != green_delta[0] || delta[1] != green_delta[1] || delta[2] != green_delta[2]) {
+    calc_green_fft(gamma, rho);
+  }
+
+  double factor = fpei / fabs(rho) * delta[0] * delta[1] * delta[2] / n2;
+
+  for (int ic = 0; ic < 3; ic++) {
+    const csr_complex* g = green_fft[ic];
+
+    OMP_PRAGMA(omp parallel for)
+    for (long i = 0; i < long(n2); i++) {
+      double re = density_fft[i][0] * g[i][0] - density_fft[i][1] * g[i][1];
+      double im = density_fft[i][0] * g[i][1] + density_fft[i][1] * g[i][0];
+      work[i][0] = re;  work[i][1] = im;
+    }
+
+    fft(work, +1);
+
+    // Extract field. The output is shifted by (nx-1, ny-1, nz-1).
+
+    OMP_PRAGMA(omp parallel for)
+    for (int k = 0; k < nz; k++) {
+      for (int j = 0; j < ny; j++) {
+        for (int i = 0; i < nx; i++) {
+          size_t iw = (size_t(k + nz - 1) * ny2 + (j + ny - 1)) * nx2 + (i + nx - 1);
+          wake[ic][(size_t(k) * ny + j) * nx + i] = factor * work[iw][0];
+        }
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+// See get_cgrn_csr3d in csr3d_mod.f90.
+
+void Csr3d_engine::calc_green_fft(double gamma, double rho) {
+  double dx = delta[0] / rho, dy = delta[1] / fabs(rho), dz = delta[2] / fabs(2 * rho);
+  double xmin = (-nx2/2 + 1) * dx, ymin = (-ny2/2 + 1) * dy, zmin = (-nz2/2 + 1) * dz;
+
+  for (int ic = 0; ic < 3; ic++) {
+    csr_complex* g = green_fft[ic];
+    double sgn = (ic == 0 && rho < 0) ? -1 : 1;
+
+    OMP_PRAGMA(omp parallel for)
+    for (int k = 0; k < nz2; k++) {
+      double z = k * dz + zmin;
+      for (int j = 0; j < ny2; j++) {
+        double y = j * dy + ymin;
+        for (int i = 0; i < nx2; i++) {
+          double x = i * dx + xmin;
+          size_t ix = (size_t(k) * ny2 + j) * nx2 + i;
+          g[ix][0] = sgn * csr3d_psi0(x, y, z, gamma, ic + 1, fabs(dx), dy);
+          g[ix][1] = 0;
+        }
+      }
+    }
+
+    fft(g, -1);
+  }
+
+  green_valid = true;
+  green_gamma = gamma;
+  green_rho = rho;
+  for (int i = 0; i < 3; i++) green_delta[i] = delta[i];
+}
+
+//--------------------------------------------------------------------
+
+void Csr3d_engine::interpolate(double x, double y, double z, double w[3]) const {
+  double u = (x - r_min[0]) / delta[0];
+  double v = (y - r_min[1]) / delta[1];
+  double t = (z - r_min[2]) / delta[2];
+  w[0] = w[1] = w[2] = 0;
+  if (u < 0 || v < 0 || t < 0 || u > nx - 1 || v > ny - 1 || t > nz - 1) return;
+
+  int i = min(int(u), nx - 2), j = min(int(v), ny - 2), k = min(int(t), nz - 2);
+  double fu = u - i, fv = v - j, ft = t - k;
+
+  for (int dk = 0; dk < 2; dk++) {
+    double wk = dk ? ft : 1 - ft;
+    for (int dj = 0; dj < 2; dj++) {
+      double wj = dj ? fv : 1 - fv;
+      size_t ix = (size_t(k + dk) * ny + (j + dj)) * nx + i;
+      for (int ic = 0; ic < 3; ic++) {
+        w[ic] += wk * wj * ((1 - fu) * wake[ic][ix] + fu * wake[ic][ix+1]);
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+// See track1_bunch_csr3d in csr_and_space_charge_mod.f90.
+
+void Csr3d_engine::apply_kicks(Bunch_soa& bunch, double kick_factor, double mc2) const {
+  long n_part = bunch.size();
+
+  OMP_PRAGMA(omp parallel for)
+  for (long ip = 0; ip < n_part; ip++) {
+    if (!bunch.alive(ip)) continue;
+    double w[3];
+    interpolate(bunch.x[ip], bunch.y[ip], bunch.z[ip], w);
+
+    double f = kick_factor / (bunch.p0c[ip] * bunch.beta[ip]);
+    double p1 = 1 + bunch.pz[ip];
+    double pz0 = sqrt(p1 * p1 - bunch.px[ip] * bunch.px[ip] - bunch.py[ip] * bunch.py[ip]);
+    bunch.px[ip] += w[0] * f;
+    bunch.py[ip] += w[1] * f;
+    double ps = w[2] * f + pz0;
+    bunch.pz[ip] = sqrt(bunch.px[ip] * bunch.px[ip] + bunch.py[ip] * bunch.py[ip] + ps * ps) - 1;
+
+    double pc = bunch.p0c[ip] * (1 + bunch.pz[ip]);
+    bunch.beta[ip] = pc / sqrt(pc * pc + mc2 * mc2);
+  }
+}
+
+//--------------------------------------------------------------------
+//--------------------------------------------------------------------
+// Green function components. Ported from csr3d_mod.f90.
+
+// Carlson symmetric elliptic integrals R_F and R_D.
+
+static double carlson_rf(double x, double y, double z) {
+  for (int i = 0; i < 100; i++) {
+    double lam = sqrt(x*y) + sqrt(y*z) + sqrt(z*x);
+    x = (x + lam) / 4;  y = (y + lam) / 4;  z = (z + lam) / 4;
+    double mu = (x + y + z) / 3;
+    double dx = 1 - x/mu, dy = 1 - y/mu, dz = 1 - z/mu;
+    if (max(fabs(dx), max(fabs(dy), fabs(dz))) < 1e-4) {
+      double e2 = dx*dy - dz*dz, e3 = dx*dy*dz;
+      return (1 - e2/10 + e3/14 + e2*e2/24 - 3*e2*e3/44) / sqrt(mu);
+    }
+  }
+  return 1 / sqrt((x + y + z) / 3);
+}
+
+static double carlson_rd(double x, double y, double z) {
+  double sum = 0, fac = 1;
+  for (int i = 0; i < 100; i++) {
+    double lam = sqrt(x*y) + sqrt(y*z) + sqrt(z*x);
+    sum += fac / (sqrt(z) * (z + lam));
+    fac /= 4;
+    x = (x + lam) / 4;  y = (y + lam) / 4;  z = (z + lam) / 4;
+    double mu = (x + y + 3*z) / 5;
+    double dx = 1 - x/mu, dy = 1 - y/mu, dz = 1 - z/mu;
+    if (max(fabs(dx), max(fabs(dy), fabs(dz))) < 1e-4) {
+      double ea = dx*dy, eb = dz*dz, ec = ea - eb, ed = ea - 6*eb, ee = ed + ec + ec;
+      double s = 1 + ed * (-3.0/14 + 9.0/88*ed - 4.5/26*dz*ee) +
+                 dz * (ee/6 + dz * (-9.0/22*ec + 3.0/26*dz*ea));
+      return 3 * sum + fac * s / (mu * sqrt(mu));
+    }
+  }
+  return 3 * sum;
+}
+
+// Incomplete elliptic integrals F(phi|m) and E(phi|m). Valid for |phi| <= pi/2 and any m < 1/sin^2(phi).
+
+static void ellipinc(double phi, double m, double& F, double& E) {
+  double s = sin(phi), c = cos(phi);
+  double q = 1 - m * s * s;
+  double rf = carlson_rf(c*c, q, 1);
+  F = s * rf;
+  E = s * rf - m * s * s * s * carlson_rd(c*c, q, 1) / 3;
+}
+
+//--------------------------------------------------------------------
+
+double csr3d_alpha(double x, double y, double z, double gamma) {
+  double beta2 = 1 - 1 / (gamma * gamma);
+
+  if (z == 0) {  // Quadratic solution
+    double b = 3 * (1 - beta2 - beta2*x) / beta2 / (1+x);
+    double c = -3 * (x*x + y*y) / (4 * (1+x));
+    return sqrt((-b + sqrt(b*b - 4*c)) / 2);
+  }
+
+  // Quartic solution
+
+  double eta = -6 * z / (beta2 * (1+x));
+  double nu = 3 * (1/beta2 - 1 - x) / (1+x);
+  double zeta = 0.75 * (4 * z*z / beta2 - x*x - y*y) / (1+x);
+
+  double temp = eta*eta/16 - zeta * nu/6 + nu*nu*nu/216;
+  double t2 = zeta/3 + nu*nu/36;
+  double omega = temp + sqrt(temp*temp - t2*t2*t2);
+  double omega3 = pow(omega, 1.0/3.0);
+  double m = -nu/3 + t2 / omega3 + omega3;
+
+  double arg1 = sqrt(2 * fabs(m));
+  double arg2 = -2 * (m + nu);
+  double arg3 = 2 * eta / arg1;
+
+  if (z >= 0) return (arg1 + sqrt(fabs(arg2 - arg3))) / 2;
+  return (-arg1 + sqrt(fabs(arg2 + arg3))) / 2;
+}
+
+//--------------------------------------------------------------------
+
+double csr3d_psi(double x, double y, double z, double gamma, int icomp) {
+  double beta2 = 1 - 1 / (gamma * gamma);
+  double beta = sqrt(beta2);
+
+  double alp = csr3d_alpha(x, y, z, gamma);
+  double kap = 2 * (alp - z) / beta;
+
+  if (icomp == 3) {
+    if (x == 0 && y == 0 && z == 0) return 0;
+    return (cos(2*alp) - 1/(1+x)) / (kap - beta*(1+x)*sin(2*alp));
+  }
+
+  double sin2a = sin(2*alp), cos2a = cos(2*alp);
+  double kap2 = kap*kap, sin2a2 = sin2a*sin2a;
+  double x2 = x*x, y2 = y*y, y4 = y2*y2;
+  double xp = x + 1, xp2 = xp*xp;
+  double xy2 = x2 + y2, xy = sqrt(xy2);
+
+  double f1 = 2 + 2*x + x2;
+  double f2 = (2+x) * (2+x);
+  double arg2 = -4 * xp / xy2;
+  double F, E;
+  ellipinc(alp, arg2, F, E);
+
+  double den = kap2 - beta2*xp2*sin2a2;
+
+  if (icomp == 1) {
+    return f1*F / (xp*xy) - (x2*f2 + y2*f1)*E / (xp*(y2+f2)*xy)
+         + (kap2 - 2*beta2*xp2 + beta2*xp*f1*cos2a) / (beta*xp*den)
+         + kap*(y4 - x2*f2 - 2*beta2*y2*xp2)*sin2a / (xy2*(y2 + f2)*den)
+         + kap*beta2*xp*(x2*f2 + y2*f1)*sin2a*cos2a / (xy2*(y2+f2)*den)
+         - (2/beta2) * F/xy;
+  }
+
+  double g = y4 + x2*f2 + 2*y2*f1;
+  return y * (F/xy - (x*(2+x)+y2)*E / ((y2+f2)*xy)
+              - beta*(1-xp*cos2a) / den
+              + kap*xp*(-(2+beta2)*y2 + (-2+beta2)*x*(2+x)) * sin2a / (g*den)
+              + kap*beta2*xp2*(y2 + x*(2+x))*sin2a*cos2a / (g*den));
+}
+
+//--------------------------------------------------------------------
+// Same as csr3d_psi but handles the singularities along the coordinate axes.
+
+double csr3d_psi0(double x, double y, double z, double gamma, int icomp, double dx, double dy) {
+  if (icomp == 3) {
+    if (x == 0 && y == 0 && z == 0) return 0;
+    return csr3d_psi(x, y, z, gamma, icomp);
+  }
+
+  if (x == 0 && y == 0)
+    return (csr3d_psi(-dx/2, y, z, gamma, icomp) + csr3d_psi(dx/2, y, z, gamma, icomp)) / 2;
+  if (y == 0 && z == 0)
+    return (csr3d_psi(x, -dy/2, z, gamma, icomp) + csr3d_psi(x, dy/2, z, gamma, icomp)) / 2;
+  return csr3d_psi(x, y, z, gamma, icomp);
+}
@@ -0,0 +1,92 @@
+//+
+// IBS rate engine. See ibs_engine.h.
+//-
+
+#include <cmath>
+#include <iostream>
+#include "ibs_engine.h"
+
+using namespace std;
+
+//--------------------------------------------------------------------
+
+Ibs_engine::Ibs_engine(int formula_in, double coulomb_log_in, double n_part_in, double mc2_in, double charge_in) :
+  formula(formula_in),
+  coulomb_log(coulomb_log_in),
+  n_part(n_part_in),
+  mc2(mc2_in),
+  charge(charge_in)
+  {}
+
+//--------------------------------------------------------------------
+
+Ibs_optics Ibs_engine::optics(const CPP_ele& ele) const {
+  Ibs_optics op;
+  op.gamma = ele.value[Bmad::E_TOT] / mc2;
+  op.rbeta = sqrt(1 - 1 / (op.gamma * op.gamma));
+  op.classical_radius = Bmad::C_LIGHT * Bmad::C_LIGHT * Bmad::E_CHARGE * 1e-7 * fabs(charge) / mc2;
+  op.sigma_p = ele.z.sigma_p;   op.sigma_z = ele.z.sigma;
+  op.emit_a = ele.a.emit;       op.emit_b = ele.b.emit;
+  op.beta_a = ele.a.beta;       op.beta_b = ele.b.beta;
+  op.alpha_a = ele.a.alpha;     op.alpha_b = ele.b.alpha;
+  op.eta_a = ele.a.eta;         op.eta_b = ele.b.eta;
+  op.etap_a = ele.a.etap;       op.etap_b = ele.b.etap;
+  return op;
+}
+
+//--------------------------------------------------------------------
+
+Ibs_rates Ibs_engine::rates1(const CPP_ele& ele, double coulomb_log_ele) const {
+  return calc.rates1(formula, optics(ele), coulomb_log_ele, n_part);
+}
+
+//--------------------------------------------------------------------
+
+void Ibs_engine::rates(const CPP_branch& branch, vector<Ibs_rates>& rates, const vector<double>* coulomb_log_ele) const {
+  int n_ele = branch.n_ele_track;
+  rates.assign(n_ele + 1, Ibs_rates());
+
+  // Zero length elements are skipped.
+
+  vector<int> ix;
+  vector<Ibs_optics> op;
+  vector<double> cl;
+  for (int i = 1; i <= n_ele; i++) {
+    const CPP_ele& ele = branch.ele[i];
+    if (ele.value[Bmad::L] == 0) continue;
+    ix.push_back(i);
+    op.push_back(optics(ele));
+    cl.push_back(coulomb_log_ele ? (*coulomb_log_ele)[i] : coulomb_log);
+  }
+
+  if (ix.empty()) return;
+
+  vector<Ibs_rates> r(ix.size());
+  int n_out_of_range = calc.rates(formula, ix.size(), &op[0], &cl[0], n_part, &r[0]);
+  for (size_t j = 0; j < ix.size(); j++) rates[ix[j]] = r[j];
+
+  if (n_out_of_range > 0) {
+    cerr << "CRITICAL WARNING: interpolation range exceeded for " << n_out_of_range << " elements" << endl;
+  }
+}
+
+//--------------------------------------------------------------------
+
+Ibs_rates Ibs_engine::rates1turn(const CPP_branch& branch, const vector<double>* coulomb_log_ele) const {
+  vector<Ibs_rates> r;
+  rates(branch, r, coulomb_log_ele);
+
+  Ibs_rates sum;
+  for (int i = 1; i <= branch.n_ele_track; i++) {
+    double len = branch.ele[i].value[Bmad::L];
+    sum.inv_Ta += r[i].inv_Ta * len;
+    sum.inv_Tb += r[i].inv_Tb * len;
+    sum.inv_Tz += r[i].inv_Tz * len;
+  }
+
+  double total_length = branch.param.total_length;
+  sum.inv_Ta /= total_length;
+  sum.inv_Tb /= total_length;
+  sum.inv_Tz /= total_length;
+  return sum;
+}
@@ -0,0 +1,53 @@
+//+
+// C++ weak-strong beam-beam engine.
+//
+// This is a C++ counterpart to the beam-beam kick of track_a_beambeam.f90 and bbi_kick.f90
+// for tracking a whole weak bunch (as a Bunch_soa) through a strong beam. The strong beam is
+// described by a set of slices. Each slice is a CPP_strong_beam (x_center, y_center, x_sigma, y_sigma
+// at the IP) plus the longitudinal position of the slice. The slices are shared by all particles so the
+// particle-slice distance, which track_a_beambeam records in the dx and dy components, is not stored.
+//
+// For each slice, each particle is drifted to the point where it meets the slice and the Bassetti-Erskine
+// kick is applied using the strong beam sigmas at that point (hourglass effect). After the last slice the
+// particles are drifted back to the IP. Crossing angles, element offsets and spin tracking, which
+// track_a_beambeam handles, are not included.
+//
+// Particles are processed in blocks in parallel. The kick for a block is computed by bbi_kick_batch
+// (sim_utils/special_functions/bbi_kick_batch.cpp), a C++ version of bbi_kick.f90. The Faddeeva function
+// evaluations are done with Faddeeva::w_batch or, if use_w_table is set, with the table driven Faddeeva::w_fast.
+//-
+
+#ifndef BEAMBEAM_ENGINE
+
+#include <vector>
+#include "bunch_soa.h"
+#include "bbi_kick_batch.h"
+
+class Beambeam_engine {
+public:
+  vector<CPP_strong_beam> slice;  // Strong beam slices.
+  vector<double> z_slice;         // Slice positions. Positive z_slice is the tail of the strong beam.
+  double strength;                // = strong_beam_strength * classical_radius_factor / p0c.
+  double beta_a, alpha_a;         // Strong beam Twiss at the IP for the hourglass calc. 
+  double beta_b, alpha_b;         //   beta = 0 => sigmas do not vary with s.
+  double mc2;                     // Weak beam particle mass in eV.
+  bool use_w_table;               // Use Faddeeva::w_fast?
+
+  Beambeam_engine() : strength(0), beta_a(0), alpha_a(0), beta_b(0), alpha_b(0), mc2(0), use_w_table(false) {}
+
+  // Set Gaussian slices like bbi_slice_calc.f90.
+  void set_gaussian_slices(int n_slice, double sig_x, double sig_y, double sig_z, 
+                           double x_center = 0, double y_center = 0, double z_offset = 0);
+
+  // Strong beam sigmas and their derivatives at s (distance from the IP).
+  void sigma_calc(double s, double sigma[2], double dsigma_ds[2]) const;
+
+  // Track the bunch through the strong beam. Particles start and end at the IP.
+  void track(Bunch_soa& bunch) const;
+
+private:
+  void track_block(Bunch_soa& bunch, long i0, long n) const;
+};
+
+#define BEAMBEAM_ENGINE
+#endif
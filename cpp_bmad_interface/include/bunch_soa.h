@@ -0,0 +1,38 @@
+//+
+// Struct-of-arrays form of a bunch.
+//
+// CPP_bunch holds an array of CPP_coord, one per particle, which is convenient for bookkeeping
+// but scatters the phase space coordinates across memory. The collective effect engines
+// (CSR, beam-beam, etc.) work on a Bunch_soa instead so that loops over particles run over
+// contiguous arrays and parallelize cleanly.
+//
+// Use load() to fill from a CPP_bunch and store() to copy the phase space coordinates back.
+//-
+
+#ifndef BUNCH_SOA
+
+#include <vector>
+#include "cpp_bmad_classes.h"
+
+class Bunch_soa {
+public:
+  vector<double> x, px, y, py, z, pz;   // Phase space coordinates. Same as CPP_coord::vec.
+  vector<double> charge;                // Macroparticle charge.
+  vector<double> beta;                  // Particle velocity / c.
+  vector<double> p0c;                   // Reference momentum.
+  vector<int> state;                    // Bmad::ALIVE, etc.
+
+  Bunch_soa() {}
+  Bunch_soa(const CPP_bunch& bunch) {load(bunch);}
+
+  size_t size() const {return z.size();}
+  bool alive(size_t i) const {return state[i] == Bmad::ALIVE;}
+  int n_alive() const;
+
+  void resize(size_t n);
+  void load(const CPP_bunch& bunch);
+  void store(CPP_bunch& bunch) const;
+};
+
+#define BUNCH_SOA
+#endif
@@ -0,0 +1,140 @@
+//+
+// C++ coherent synchrotron radiation (CSR) engines.
+//
+// These are C++ counterparts to the CSR calculation in csr_and_space_charge_mod.f90 and
+// csr3d_mod.f90 and use the same CPP_space_charge_common parameters (n_bin, particle_bin_span,
+// sc_min_in_bin, csr3d_mesh_size). Both engines work on a Bunch_soa.
+//
+// Csr1d_engine:
+//   One dimensional (line charge) CSR. Particles are binned in parallel with the same triangular
+//   particle shape used by csr_bin_particles. The kick is the convolution of the binned charge
+//   density derivative with a kernel table (the kick1(1:n_bin)%I_int_csr array of the Fortran code).
+//   The kernel can be supplied by the caller or, for the body of a bend, taken from a steady state
+//   table which is computed once per bend and cached so that successive slices through the
+//   same bend only need to interpolate it.
+//
+// Csr3d_engine:
+//   Three dimensional steady state CSR using the integrated Green function method of csr3d_mod.f90.
+//   FFTW plans are created once per engine and reused every step. As with fft_interface_mod.f90,
+//   defining NO_USE_FFTW builds without FFTW and uses a built in FFT instead. The FFT of the Green functions
+//   is cached and only recomputed when gamma, rho or the mesh spacing change. To make this cache
+//   effective, the mesh spacing is quantized upward in steps of 2^(1/16) so that it does not
+//   change on every step as the bunch evolves.
+//-
+
+#ifndef CSR_ENGINE
+
+#include <map>
+#include <vector>
+#include "bunch_soa.h"
+
+#ifdef NO_USE_FFTW
+typedef double csr_complex[2];
+#else
+#include <fftw3.h>
+typedef fftw_complex csr_complex;
+#endif
+
+//--------------------------------------------------------------------
+// One dimensional CSR
+
+class Csr1d_engine {
+public:
+  int n_bin;                // Number of bins.
+  int particle_bin_span;    // Particle width in bins.
+  int sc_min_in_bin;        // Minimum number of particles in a bin for sigma calc.
+  double lsc_sigma_cutoff;  // Cutoff for small sigmas.
+  double dz_slice;          // Bin width.
+  double z_min;             // Left edge of first bin.
+
+  // Bin arrays. Index 0 corresponds to csr%slice(1) in the Fortran code.
+
+  vector<double> z_center, charge, n_particle, x0, y0, sig_x, sig_y;
+  vector<double> dcharge_density_dz, edge_dcharge_density_dz;
+  vector<double> kick_csr;
+
+  Csr1d_engine(const CPP_space_charge_common& sc_com);
+
+  // Binning. Returns false if the binning could not be done.
+  bool bin_particles(const Bunch_soa& bunch);
+
+  // Kernel for the body of a bend with bending strength g_bend = 1/rho.
+  // The returned array has n_bin elements: kernel[k-1] = I_int_csr for a source k bins ahead.
+  // The table for a given (ix_ele, g_bend, gamma) is cached.
+  const vector<double>& steady_state_kernel(int ix_ele, double g_bend, double gamma);
+
+  // Kick calc: kick_csr(i) = coef * Sum_j kernel(i-j) * edge_dcharge_density_dz(j)
+  void calc_kicks(const vector<double>& kernel, double coef);
+  void calc_kicks(const double* kernel, double coef);
+
+  // Apply kick_csr to the particles.
+  void apply_kicks(Bunch_soa& bunch) const;
+
+  void clear_kernel_cache() {kernel_cache.clear();}
+
+private:
+  struct Kernel_table {
+    double g_bend, gamma;
+    double log_z0, dlog_z;       // Log spaced z grid.
+    vector<double> i_csr;        // I_csr(z) with kick_factor = 1.
+    vector<double> kernel;       // Last evaluated kernel.
+    double dz_kernel;            // dz_slice for the last evaluated kernel.
+  };
+
+  map<int, Kernel_table> kernel_cache;
+
+  double overlap_in_bin(double zp_center, double dz_particle, double zb0, double zb1) const;
+};
+
+//--------------------------------------------------------------------
+// Three dimensional steady state CSR
+
+class Csr3d_engine {
+public:
+  int nx, ny, nz;             // Mesh size from CPP_space_charge_common::csr3d_mesh_size.
+  double delta[3];            // Mesh spacing.
+  double r_min[3];            // Mesh lower bounds.
+  vector<double> density;     // Charge density. Index = (k*ny + j)*nx + i.
+  vector<double> wake[3];     // Wx, Wy, Ws in V/m. Same indexing as density.
+
+  Csr3d_engine(const CPP_space_charge_common& sc_com);
+  ~Csr3d_engine();
+
+  // Deposit particles on the mesh. Returns false if there are no live particles.
+  bool deposit(const Bunch_soa& bunch);
+
+  // Compute the wake for the present density.
+  void solve(double gamma, double rho);
+
+  // Kick particles. mc2 is the particle rest mass in eV.
+  void apply_kicks(Bunch_soa& bunch, double kick_factor, double mc2) const;
+
+private:
+  int nx2, ny2, nz2;
+  csr_complex* work;
+  csr_complex* density_fft;
+  csr_complex* green_fft[3];
+#ifndef NO_USE_FFTW
+  fftw_plan plan_forward, plan_backward;
+#endif
+
+  bool green_valid;
+  double green_gamma, green_rho, green_delta[3];
+
+  Csr3d_engine(const Csr3d_engine&);            // Not copyable.
+  Csr3d_engine& operator=(const Csr3d_engine&);
+
+  void calc_green_fft(double gamma, double rho);
+  void fft(csr_complex* a, int direction);   // In place 3D FFT. direction = -1 (forward) or +1.
+  void interpolate(double x, double y, double z, double w[3]) const;
+};
+
+// Green function components from csr3d_mod.f90. Coordinates are scaled:
+// x -> x/rho, y -> y/rho, z -> z/(2*rho). icomp = 1, 2, 3 for Wx, Wy, Ws.
+
+double csr3d_alpha(double x, double y, double z, double gamma);
+double csr3d_psi(double x, double y, double z, double gamma, int icomp);
+double csr3d_psi0(double x, double y, double z, double gamma, int icomp, double dx, double dy);
+
+#define CSR_ENGINE
+#endif
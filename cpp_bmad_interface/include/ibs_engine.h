@@ -0,0 +1,46 @@
+//+
+// C++ intrabeam scattering (IBS) rate engine.
+//
+// This is a C++ counterpart to the ibs1 / ibs_rates1turn routines of ibs_mod.f90. The optics for each
+// element are taken from CPP_ele::a, CPP_ele::b (beta, alpha, eta, etap, emit) and CPP_ele::z (sigma, sigma_p).
+// The rates are computed by Ibs_rates_calc (bmad/multiparticle/ibs_rates_calc.cpp). ibs_mod.f90 uses this
+// only when ibs_sim_params%fixed_quadrature is set.
+//-
+
+#ifndef IBS_ENGINE
+
+#include <vector>
+#include "cpp_bmad_classes.h"
+#include "ibs_rates_calc.h"
+
+class Ibs_engine {
+public:
+  int formula;           // Ibs_rates_calc::BJMT, etc.
+  double coulomb_log;    // Coulomb log used if not given per element.
+  double n_part;         // Number of particles in the bunch.
+  double mc2;            // Particle mass in eV.
+  double charge;         // Particle charge in units of e.
+
+  Ibs_engine(int formula_in, double coulomb_log_in, double n_part_in, double mc2_in, double charge_in = -1);
+
+  // Rates for a single element.
+  Ibs_rates rates1(const CPP_ele& ele, double coulomb_log_ele) const;
+  Ibs_rates rates1(const CPP_ele& ele) const {return rates1(ele, coulomb_log);}
+
+  // Rates for elements 1 through n_ele_track of a branch. rates[0] is not used.
+  // Zero length elements get zero rates like ibs1. If coulomb_log_ele is non-null, 
+  // coulomb_log_ele[i] is used for element i.
+  void rates(const CPP_branch& branch, vector<Ibs_rates>& rates, const vector<double>* coulomb_log_ele = 0) const;
+
+  // Length weighted average of the rates. Same as ibs_rates1turn with granularity < 0.
+  Ibs_rates rates1turn(const CPP_branch& branch, const vector<double>* coulomb_log_ele = 0) const;
+
+  // Beam parameters of an element.
+  Ibs_optics optics(const CPP_ele& ele) const;
+
+private:
+  Ibs_rates_calc calc;
+};
+
+#define IBS_ENGINE
+#endif
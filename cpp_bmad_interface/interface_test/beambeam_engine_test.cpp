@@ -0,0 +1,51 @@
+//+
+// C++ side of the Beambeam_engine vs bbi_kick.f90 comparison. See beambeam_engine_test_mod.f90.
+//-
+
+#include "beambeam_engine.h"
+
+//--------------------------------------------------------------------
+// Track n particles through a Gaussian strong beam of n_slice slices.
+// vec uses the Fortran layout vec(6,n) and is overwritten with the tracked coordinates.
+// sig = [sig_x, sig_y, sig_z], twiss = [beta_a, alpha_a, beta_b, alpha_b].
+
+extern "C" void beambeam_engine_track_test (const int& n, double* vec, double* beta, const double& p0c,
+                                            const double& mc2, const int& n_slice, const double* sig,
+                                            const double* twiss, const double& strength) {
+  Beambeam_engine engine;
+  engine.set_gaussian_slices(n_slice, sig[0], sig[1], sig[2]);
+  engine.strength = strength;
+  engine.beta_a = twiss[0];  engine.alpha_a = twiss[1];
+  engine.beta_b = twiss[2];  engine.alpha_b = twiss[3];
+  engine.mc2 = mc2;
+
+  Bunch_soa bunch;
+  bunch.resize(n);
+  for (int i = 0; i < n; i++) {
+    const double* v = vec + 6 * i;
+    bunch.x[i] = v[0];  bunch.px[i] = v[1];
+    bunch.y[i] = v[2];  bunch.py[i] = v[3];
+    bunch.z[i] = v[4];  bunch.pz[i] = v[5];
+    bunch.beta[i] = beta[i];
+    bunch.p0c[i] = p0c;
+  }
+
+  engine.track(bunch);
+
+  for (int i = 0; i < n; i++) {
+    double* v = vec + 6 * i;
+    v[0] = bunch.x[i];  v[1] = bunch.px[i];
+    v[2] = bunch.y[i];  v[3] = bunch.py[i];
+    v[4] = bunch.z[i];  v[5] = bunch.pz[i];
+    beta[i] = bunch.beta[i];
+  }
+}
+
+//--------------------------------------------------------------------
+// Slice positions as computed by Beambeam_engine::set_gaussian_slices.
+
+extern "C" void beambeam_engine_slice_test (const int& n_slice, const double& sig_z, double* z_slice) {
+  Beambeam_engine engine;
+  engine.set_gaussian_slices(n_slice, 1, 1, sig_z);
+  for (int i = 0; i < n_slice; i++) z_slice[i] = engine.z_slice[i];
+}
@@ -0,0 +1,246 @@
+!+
+! Checks of bbi_kick.f90 and of its C++ version used by the Beambeam_engine
+! (sim_utils/special_functions/bbi_kick_batch.cpp and cpp_bmad_interface/code/beambeam_engine.cpp).
+!
+! The kick nk from bbi_kick is compared with a direct integration of the field of a Gaussian beam,
+! the derivatives dnk are compared with finite differences of nk, the C++ kick is compared with
+! bbi_kick, and the tracking of the C++ engine is compared with a particle by particle loop using
+! the kick formulas of track_a_beambeam.f90.
+!-
+
+module beambeam_engine_test_mod
+
+use precision_def
+use, intrinsic :: iso_c_binding
+
+implicit none
+
+interface
+  subroutine bbi_kick_c (x, y, sigma, nk, dnk) bind(c)
+    import c_double
+    real(c_double), value :: x, y
+    real(c_double) sigma(2), nk(2), dnk(2,2)
+  end subroutine
+
+  subroutine beambeam_engine_track_test (n, vec, beta, p0c, mc2, n_slice, sig, twiss, strength) bind(c)
+    import c_int, c_double
+    integer(c_int) n, n_slice
+    real(c_double) vec(6,*), beta(*), p0c, mc2, sig(3), twiss(4), strength
+  end subroutine
+
+  subroutine beambeam_engine_slice_test (n_slice, sig_z, z_slice) bind(c)
+    import c_int, c_double
+    integer(c_int) n_slice
+    real(c_double) sig_z, z_slice(*)
+  end subroutine
+end interface
+
+contains
+
+!------------------------------------------------------------------------
+!+
+! Subroutine beambeam_engine_test (ok)
+!
+! Input:
+!   ok    -- logical: Set False if any check fails.
+!-
+
+subroutine beambeam_engine_test (ok)
+
+integer, parameter :: n_part = 50, n_slice = 5
+real(rp), parameter :: pi = 3.14159265358979323846264338327950288419716939937510_rp
+real(rp), parameter :: sigs(2,4) = reshape([1e-3_rp, 2e-4_rp, 2e-4_rp, 1e-3_rp, 5e-4_rp, 5e-4_rp, 3e-4_rp, 2.9e-4_rp], [2,4])
+real(rp), parameter :: pts(2,6) = reshape([0.1_rp, 0.2_rp, -1.0_rp, 0.5_rp, 2.0_rp, -3.0_rp, &
+                                           -0.3_rp, -4.0_rp, 7.0_rp, 0.02_rp, 12.0_rp, 9.0_rp], [2,6])
+
+real(rp) sigma(2), x, y, nk(2), dnk(2,2), nk_int(2), nk_p(2), nk_m(2), d_fd, h, diff_nk, diff_dnk
+real(rp) nk_c(2), dnk_c(2,2), diff_c
+real(rp) vec0(6,n_part), vec_c(6,n_part), vec_f(6,n_part), beta_c(n_part), beta_f(n_part)
+real(rp) sig(3), twiss(4), strength, p0c, mc2, z_slice(n_slice), diff_vec(6), scale(6)
+real(rp) s_now, s_coll, p_rel, sigma_s(2), dsigma_ds(2), bbi_const, px_old, py_old
+real(rp) e_factor, pc, beta0, gamma0, bet, r
+integer i, j, k, ip, is
+logical ok
+
+!
+
+ok = .true.
+
+! nk vs integration of the field, the C++ kick vs bbi_kick and dnk vs finite differences.
+
+diff_nk = 0;  diff_dnk = 0;  diff_c = 0
+
+do i = 1, size(sigs, 2)
+  sigma = sigs(:,i)
+  do j = 1, size(pts, 2)
+    x = pts(1,j) * sigma(1);  y = pts(2,j) * sigma(2)
+    call bbi_kick (x, y, sigma, nk, dnk)
+    nk_int = field_integral (x, y, sigma)
+    diff_nk = max(diff_nk, maxval(abs(nk - nk_int)) / max(maxval(abs(nk_int)), 1.0_rp))
+
+    call bbi_kick_c (x, y, sigma, nk_c, dnk_c)
+    diff_c = max(diff_c, maxval(abs(nk_c - nk)) / max(maxval(abs(nk)), 1.0_rp), &
+                         maxval(abs(dnk_c - dnk)) / max(maxval(abs(dnk)), 1.0_rp))
+
+    do k = 1, 2
+      h = 1e-5_rp * sigma(k)
+      if (k == 1) then
+        call bbi_kick (x+h, y, sigma, nk_p, dnk)
+        call bbi_kick (x-h, y, sigma, nk_m, dnk)
+      else
+        call bbi_kick (x, y+h, sigma, nk_p, dnk)
+        call bbi_kick (x, y-h, sigma, nk_m, dnk)
+      endif
+      call bbi_kick (x, y, sigma, nk, dnk)
+      do ip = 1, 2
+        d_fd = (nk_p(ip) - nk_m(ip)) / (2 * h)
+        diff_dnk = max(diff_dnk, abs(dnk(ip,k) - d_fd) * sigma(k) / max(maxval(abs(nk)), 1.0_rp))
+      enddo
+    enddo
+  enddo
+enddo
+
+if (diff_nk > 1e-10_rp) then
+  print '(a, es10.2)', 'bbi_kick: nk differs from the field integral by (relative): ', diff_nk
+  ok = .false.
+endif
+
+if (diff_dnk > 1e-6_rp) then
+  print '(a, es10.2)', 'bbi_kick: dnk differs from finite differences by (relative): ', diff_dnk
+  ok = .false.
+endif
+
+if (diff_c > 1e-12_rp) then
+  print '(a, es10.2)', 'bbi_kick_batch: Kick differs from bbi_kick by (relative): ', diff_c
+  ok = .false.
+endif
+
+! Engine tracking vs a particle by particle loop. The loop uses the kick formulas of
+! track_a_beambeam with the collision point and drifts of the engine.
+
+sig = [2e-4_rp, 3e-5_rp, 5e-3_rp]
+twiss = [0.1_rp, 0.2_rp, 0.02_rp, -0.1_rp]
+p0c = 5e9_rp
+mc2 = 0.51099895e6_rp
+strength = 1e10_rp * 2.8179403262e-15_rp * mc2 / p0c
+call beambeam_engine_slice_test (n_slice, sig(3), z_slice)
+
+do ip = 1, n_part
+  r = real(ip, rp) / n_part
+  vec0(:,ip) = [3 * sig(1) * sin(7 * r), 1e-5_rp * cos(3 * r), 4 * sig(2) * cos(11 * r), &
+                2e-6_rp * sin(5 * r), 2 * sig(3) * sin(13 * r), 1e-3_rp * cos(17 * r)]
+  pc = p0c * (1 + vec0(6,ip))
+  beta_c(ip) = pc / sqrt(pc**2 + mc2**2)
+enddo
+
+vec_c = vec0
+beta_f = beta_c
+call beambeam_engine_track_test (n_part, vec_c, beta_c, p0c, mc2, n_slice, sig, twiss, strength)
+
+vec_f = vec0
+do ip = 1, n_part
+  s_now = 0
+  do is = 1, n_slice
+    s_coll = 0.5_rp * (vec_f(5,ip) + z_slice(is))
+    call drift (vec_f(:,ip), s_coll - s_now)
+    s_now = s_coll
+
+    do k = 1, 2
+      beta0 = twiss(2*k-1)
+      gamma0 = (1 + twiss(2*k)**2) / beta0
+      bet = beta0 - 2 * twiss(2*k) * s_coll + gamma0 * s_coll**2
+      sigma_s(k) = sig(k) * sqrt(bet / beta0)
+      dsigma_ds(k) = -(twiss(2*k) - s_coll * gamma0) * sigma_s(k) / bet
+    enddo
+    bbi_const = -strength / (2 * pi * (sigma_s(1) + sigma_s(2)))
+
+    px_old = vec_f(2,ip)
+    py_old = vec_f(4,ip)
+    p_rel = 1 + vec_f(6,ip)
+    call bbi_kick (vec_f(1,ip), vec_f(3,ip), sigma_s, nk, dnk)
+    nk = nk * bbi_const / n_slice
+    dnk = dnk * bbi_const / n_slice
+
+    e_factor = 0.25_rp / p_rel
+    vec_f(6,ip) = vec_f(6,ip) + e_factor * (nk(1) * (nk(1) + 2 * px_old) + nk(2) * (nk(2) + 2 * py_old)) + &
+                          0.5_rp * (dnk(1,1) * dsigma_ds(1) * sigma_s(1) + dnk(2,2) * dsigma_ds(2) * sigma_s(2))
+    pc = p0c * (1 + vec_f(6,ip))
+    vec_f(5,ip) = vec_f(5,ip) * (pc / sqrt(pc**2 + mc2**2)) / beta_f(ip)
+    beta_f(ip) = pc / sqrt(pc**2 + mc2**2)
+
+    vec_f(2,ip) = px_old + nk(1)
+    vec_f(4,ip) = py_old + nk(2)
+  enddo
+  call drift (vec_f(:,ip), -s_now)
+enddo
+
+! The change in z and pz is small compared to their values so the scale has a floor for round off.
+
+scale = maxval(abs(vec_f - vec0), 2) + 1e-6_rp * maxval(abs(vec0), 2)
+do k = 1, 6
+  diff_vec(k) = maxval(abs(vec_c(k,:) - vec_f(k,:))) / scale(k)
+enddo
+
+if (any(diff_vec > 1e-9_rp)) then
+  print '(a, 6es10.2)', 'Beambeam_engine: Tracking differs from bbi_kick loop by (relative): ', diff_vec
+  ok = .false.
+endif
+
+!---------------------------------
+contains
+
+subroutine drift (v, ds)
+real(rp) v(6), ds, p_rel, pz_s
+p_rel = 1 + v(6)
+pz_s = sqrt(p_rel**2 - v(2)**2 - v(4)**2)
+v(1) = v(1) + ds * v(2) / pz_s
+v(3) = v(3) + ds * v(4) / pz_s
+v(5) = v(5) - ds * (p_rel / pz_s - 1)
+end subroutine drift
+
+end subroutine beambeam_engine_test
+
+!------------------------------------------------------------------------
+!+
+! Function field_integral (x, y, sigma) result (nk)
+!
+! Normalized kick (see bbi_kick) from the integral form of the field of a Gaussian beam:
+!   nk(1) = -4 pi (sig_x + sig_y) x Integral[0,Inf] dq exp(-x^2/(2 sig_x^2 + q) - y^2/(2 sig_y^2 + q)) /
+!                                                    ((2 sig_x^2 + q)^(3/2) (2 sig_y^2 + q)^(1/2))
+! and similarly for nk(2). Integrated with Simpson's rule after the change of variable q = c t / (1 - t).
+!-
+
+function field_integral (x, y, sigma) result (nk)
+
+integer, parameter :: n_int = 20000
+real(rp), parameter :: pi = 3.14159265358979323846264338327950288419716939937510_rp
+real(rp) x, y, sigma(2), nk(2), c, t, q, dq_dt, ax, ay, f, w
+integer i
+
+!
+
+c = 2 * sigma(1) * sigma(2) + x**2 + y**2
+nk = 0
+
+do i = 1, n_int - 1
+  t = real(i, rp) / n_int
+  q = c * t / (1 - t)
+  dq_dt = c / (1 - t)**2
+  ax = 2 * sigma(1)**2 + q
+  ay = 2 * sigma(2)**2 + q
+  f = exp(-x**2 / ax - y**2 / ay) / sqrt(ax * ay) * dq_dt
+  w = 2 + 2 * mod(i, 2)
+  nk = nk + w * f * [1 / ax, 1 / ay]
+enddo
+
+! The t = 1 end point has the limit f * [1/ax, 1/ay] -> 1/c. The t = 0 end point is f at q = 0.
+
+ax = 2 * sigma(1)**2;  ay = 2 * sigma(2)**2
+f = exp(-x**2 / ax - y**2 / ay) / sqrt(ax * ay) * c
+nk = nk + f * [1 / ax, 1 / ay] + [1 / c, 1 / c]
+
+nk = -4 * pi * (sigma(1) + sigma(2)) * [x, y] * nk / (3 * n_int)
+
+end function field_integral
+
+end module
@@ -0,0 +1,42 @@
+//+
+// C++ side of the Csr3d_engine vs csr3d_mod.f90 comparison. See csr_engine_test_mod.f90.
+//-
+
+#include "csr_engine.h"
+
+//--------------------------------------------------------------------
+// Steady state wake of a given density on an n(1) x n(2) x n(3) mesh.
+// density and wake use the Fortran layout: density(nx,ny,nz) and wake(nx,ny,nz,3).
+
+extern "C" void csr3d_engine_wake_test (const int* n, const double* density, const double* delta,
+                                        const double& gamma, const double& rho, double* wake) {
+  CPP_space_charge_common sc_com;
+  for (int i = 0; i < 3; i++) sc_com.csr3d_mesh_size[i] = n[i];
+
+  Csr3d_engine engine(sc_com);
+  size_t n_cell = size_t(n[0]) * n[1] * n[2];
+  for (size_t ic = 0; ic < n_cell; ic++) engine.density[ic] = density[ic];
+  for (int i = 0; i < 3; i++) engine.delta[i] = delta[i];
+
+  engine.solve(gamma, rho);
+
+  for (int ic = 0; ic < 3; ic++) {
+    for (size_t i = 0; i < n_cell; i++) wake[ic * n_cell + i] = engine.wake[ic][i];
+  }
+}
+
+//--------------------------------------------------------------------
+
+extern "C" double csr3d_psi0_test (const double& x, const double& y, const double& z, const double& gamma,
+                                   const int& icomp, const double& dx, const double& dy) {
+  return csr3d_psi0(x, y, z, gamma, icomp, dx, dy);
+}
+
+extern "C" double csr3d_psi_test (const double& x, const double& y, const double& z, const double& gamma,
+                                  const int& icomp) {
+  return csr3d_psi(x, y, z, gamma, icomp);
+}
+
+extern "C" double csr3d_alpha_test (const double& x, const double& y, const double& z, const double& gamma) {
+  return csr3d_alpha(x, y, z, gamma);
+}
@@ -0,0 +1,123 @@
+!+
+! Comparison of the C++ Csr3d_engine (cpp_bmad_interface/code/csr_engine.cpp) with csr3d_mod.f90.
+!
+! The Green function components are compared point by point and the steady state wake of a
+! Gaussian bunch is compared over the whole mesh.
+!-
+
+module csr_engine_test_mod
+
+use csr3d_mod
+use, intrinsic :: iso_c_binding
+
+implicit none
+
+integer, parameter, private :: dp = c_double
+
+interface
+  subroutine csr3d_engine_wake_test (n, density, delta, gamma, rho, wake) bind(c)
+    import c_int, c_double
+    integer(c_int) n(3)
+    real(c_double) density(*), delta(3), gamma, rho, wake(*)
+  end subroutine
+
+  function csr3d_psi0_test (x, y, z, gamma, icomp, dx, dy) result (val) bind(c)
+    import c_int, c_double
+    real(c_double) x, y, z, gamma, dx, dy, val
+    integer(c_int) icomp
+  end function
+
+  function csr3d_psi_test (x, y, z, gamma, icomp) result (val) bind(c)
+    import c_int, c_double
+    real(c_double) x, y, z, gamma, val
+    integer(c_int) icomp
+  end function
+
+  function csr3d_alpha_test (x, y, z, gamma) result (val) bind(c)
+    import c_double
+    real(c_double) x, y, z, gamma, val
+  end function
+end interface
+
+contains
+
+!------------------------------------------------------------------------
+!+
+! Subroutine csr_engine_test (ok)
+!
+! Input:
+!   ok    -- logical: Set False if the C++ and Fortran results differ.
+!-
+
+subroutine csr_engine_test (ok)
+
+real(dp), allocatable :: density(:,:,:), wake_f(:,:,:,:), wake_c(:,:,:,:)
+real(dp) delta(3), gamma, rho, x, y, z, dx, dy, f_val, c_val, diff, scale
+real(dp), parameter :: sig(3) = [1e-3_dp, 5e-4_dp, 2e-3_dp], tol = 1e-8_dp
+integer n(3), i, j, k, ic, ix
+logical ok
+
+!
+
+ok = .true.
+gamma = 1e3_dp
+rho = 10
+
+! Green function components at points on and off the axes (psi0 averages across the
+! singular axes).
+
+diff = 0
+do ix = -3, 3
+  x = 1e-4_dp * ix;  y = 0.7e-4_dp * (ix + 1);  z = -2e-4_dp * (ix - 1)
+  dx = 1e-5_dp;  dy = 2e-5_dp
+  if (mod(ix, 2) == 0) y = 0
+  if (mod(ix, 3) == 0) z = 0
+  do ic = 1, 3
+    f_val = psi0(x, y, z, gamma, ic, dx, dy, 0.0_dp)
+    c_val = csr3d_psi0_test(x, y, z, gamma, ic, dx, dy)
+    diff = max(diff, abs(f_val - c_val) / max(abs(f_val), 1.0_dp))
+    if (x /= 0 .or. y /= 0 .or. z /= 0) then
+      f_val = psi(x, y, z, gamma, ic)
+      c_val = csr3d_psi_test(x, y, z, gamma, ic)
+      diff = max(diff, abs(f_val - c_val) / max(abs(f_val), 1.0_dp))
+    endif
+  enddo
+  f_val = alpha(x, y, z, gamma)
+  c_val = csr3d_alpha_test(x, y, z, gamma)
+  diff = max(diff, abs(f_val - c_val) / max(abs(f_val), 1.0_dp))
+enddo
+
+if (diff > tol) then
+  print '(a, es10.2)', 'Csr3d_engine: Green function differs from csr3d_mod by: ', diff
+  ok = .false.
+endif
+
+! Wake of a Gaussian bunch.
+
+n = [16, 16, 32]
+delta = 6 * sig / (n - 1)
+allocate (density(n(1), n(2), n(3)), wake_f(n(1), n(2), n(3), 3), wake_c(n(1), n(2), n(3), 3))
+
+do k = 1, n(3);  do j = 1, n(2);  do i = 1, n(1)
+  x = (i - (n(1) + 1) / 2.0_dp) * delta(1)
+  y = (j - (n(2) + 1) / 2.0_dp) * delta(2)
+  z = (k - (n(3) + 1) / 2.0_dp) * delta(3)
+  density(i,j,k) = exp(-(x/sig(1))**2/2 - (y/sig(2))**2/2 - (z/sig(3))**2/2)
+enddo;  enddo;  enddo
+density = density / (sum(density) * product(delta))
+
+call csr3d_steady_state_solver(density, gamma, rho, delta, wake_f, normalize = .false.)
+call csr3d_engine_wake_test(n, density, delta, gamma, rho, wake_c)
+
+do ic = 1, 3
+  scale = maxval(abs(wake_f(:,:,:,ic)))
+  diff = maxval(abs(wake_f(:,:,:,ic) - wake_c(:,:,:,ic))) / scale
+  if (diff > tol) then
+    print '(a, i0, a, es10.2)', 'Csr3d_engine: Wake component ', ic, ' differs from csr3d_mod by (relative): ', diff
+    ok = .false.
+  endif
+enddo
+
+end subroutine csr_engine_test
+
+end module
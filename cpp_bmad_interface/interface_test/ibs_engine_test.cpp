@@ -0,0 +1,28 @@
+//+
+// C++ side of the Ibs_engine vs ibs_rates_mod.f90 comparison. See ibs_engine_test_mod.f90.
+//-
+
+#include "ibs_engine.h"
+
+//--------------------------------------------------------------------
+// Rates for an element with
+//   v = [E_tot, sigma_p, sigma_z, emit_a, emit_b, beta_a, beta_b, alpha_a, alpha_b, eta_a, eta_b, etap_a, etap_b]
+// rates = [inv_Ta, inv_Tb, inv_Tz].
+
+extern "C" void ibs_engine_rates1_test (const int& formula, const double* v, const double& mc2, const double& charge,
+                                        const double& coulomb_log, const double& n_part, double* rates) {
+  CPP_ele ele;
+  ele.value[Bmad::E_TOT] = v[0];
+  ele.z.sigma_p = v[1];   ele.z.sigma = v[2];
+  ele.a.emit = v[3];      ele.b.emit = v[4];
+  ele.a.beta = v[5];      ele.b.beta = v[6];
+  ele.a.alpha = v[7];     ele.b.alpha = v[8];
+  ele.a.eta = v[9];       ele.b.eta = v[10];
+  ele.a.etap = v[11];     ele.b.etap = v[12];
+
+  Ibs_engine engine(formula, coulomb_log, n_part, mc2, charge);
+  Ibs_rates r = engine.rates1(ele);
+  rates[0] = r.inv_Ta;
+  rates[1] = r.inv_Tb;
+  rates[2] = r.inv_Tz;
+}
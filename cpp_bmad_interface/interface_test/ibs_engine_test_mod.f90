@@ -0,0 +1,109 @@
+!+
+! Comparison of the IBS rates computed by Ibs_rates_calc (bmad/multiparticle/ibs_rates_calc.cpp), which
+! is used by the C++ Ibs_engine and optionally by ibs_mod, with the GSL based routines of ibs_rates_mod.f90
+! (bjmt1, bane1, mpxx1, mpzt1 and cimp1).
+!-
+
+module ibs_engine_test_mod
+
+use ibs_rates_mod
+use, intrinsic :: iso_c_binding
+
+implicit none
+
+interface
+  subroutine ibs_engine_rates1_test (formula, v, mc2, charge, coulomb_log, n_part, rates) bind(c)
+    import c_int, c_double
+    integer(c_int) formula
+    real(c_double) v(13), mc2, charge, coulomb_log, n_part, rates(3)
+  end subroutine
+end interface
+
+contains
+
+!------------------------------------------------------------------------
+!+
+! Subroutine ibs_engine_test (ok)
+!
+! Input:
+!   ok    -- logical: Set False if the rates differ.
+!-
+
+subroutine ibs_engine_test (ok)
+
+integer, parameter :: n_set = 5
+character(4), parameter :: formula(5) = ['bjmt', 'bane', 'mpxx', 'mpzt', 'cimp']
+
+! [E_tot, sigma_p, sigma_z, emit_a, emit_b, beta_a, beta_b, alpha_a, alpha_b, eta_a, eta_b, etap_a, etap_b]
+
+real(rp), parameter :: sets(13, n_set) = reshape([ &
+    5e9_rp, 1e-3_rp, 5e-3_rp, 1e-9_rp, 1e-11_rp, 10.0_rp, 5.0_rp, 0.5_rp, -0.3_rp, 0.2_rp, 0.0_rp, 0.01_rp, 0.0_rp, &
+    1e8_rp, 5e-4_rp, 3e-3_rp, 1e-8_rp, 1e-9_rp, 3.0_rp, 8.0_rp, -1.2_rp, 0.7_rp, 0.5_rp, 0.01_rp, -0.1_rp, 0.002_rp, &
+    2e9_rp, 8e-4_rp, 1e-2_rp, 2e-9_rp, 2e-12_rp, 20.0_rp, 2.0_rp, 0.0_rp, 0.0_rp, 1.0_rp, 0.001_rp, 0.2_rp, -0.001_rp, &
+    1e9_rp, 1e-3_rp, 1e-3_rp, 1e-8_rp, 1e-8_rp, 5.0_rp, 5.0_rp, 0.0_rp, 0.0_rp, 0.0_rp, 0.0_rp, 0.0_rp, 0.0_rp, &
+    3e9_rp, 1e-3_rp, 4e-3_rp, 5e-10_rp, 5e-12_rp, 1.0_rp, 30.0_rp, 2.0_rp, -4.0_rp, 0.05_rp, 0.0_rp, 0.05_rp, 0.0_rp], &
+    [13, n_set])
+
+type (branch_struct), target :: branch
+type (ele_struct) ele
+type (ibs_struct) r_gsl, r_calc(1)
+real(rp) optics(ibs_n_optics$, 1), r_cpp(3), v(13), coulomb_log, n_part, diff_gsl, diff_cpp, scale
+integer is, f
+logical ok
+
+!
+
+ok = .true.
+branch%param%particle = electron$
+ele%branch => branch
+coulomb_log = 15
+n_part = 1e10
+
+diff_gsl = 0;  diff_cpp = 0
+
+do is = 1, n_set
+  v = sets(:,is)
+  ele%value(e_tot$) = v(1)
+  ele%z%sigma_p = v(2);  ele%z%sigma = v(3)
+  ele%a%emit = v(4);     ele%b%emit = v(5)
+  ele%a%beta = v(6);     ele%b%beta = v(7)
+  ele%a%alpha = v(8);    ele%b%alpha = v(9)
+  ele%a%eta = v(10);     ele%b%eta = v(11)
+  ele%a%etap = v(12);    ele%b%etap = v(13)
+  call ibs_optics_calc (ele, optics(:,1))
+
+  do f = 1, size(formula)
+    select case (formula(f))
+    case ('bjmt');  call bjmt1 (ele, coulomb_log, r_gsl, n_part)
+    case ('bane');  call bane1 (ele, coulomb_log, r_gsl, n_part)
+    case ('mpxx');  call mpxx1 (ele, coulomb_log, r_gsl, n_part)
+    case ('mpzt');  call mpzt1 (ele, coulomb_log, r_gsl, n_part)
+    case ('cimp');  call cimp1 (ele, coulomb_log, r_gsl, n_part)
+    end select
+
+    call ibs_rates_calc (formula(f), optics, [coulomb_log], n_part, r_calc)
+    call ibs_engine_rates1_test (f, v, mass_of(electron$), -1.0_rp, coulomb_log, n_part, r_cpp)
+
+    scale = max(abs(r_gsl%inv_Ta), abs(r_gsl%inv_Tb), abs(r_gsl%inv_Tz))
+    diff_gsl = max(diff_gsl, abs(r_calc(1)%inv_Ta - r_gsl%inv_Ta) / scale, &
+                   abs(r_calc(1)%inv_Tb - r_gsl%inv_Tb) / scale, abs(r_calc(1)%inv_Tz - r_gsl%inv_Tz) / scale)
+    diff_cpp = max(diff_cpp, abs(r_calc(1)%inv_Ta - r_cpp(1)) / scale, &
+                   abs(r_calc(1)%inv_Tb - r_cpp(2)) / scale, abs(r_calc(1)%inv_Tz - r_cpp(3)) / scale)
+  enddo
+enddo
+
+! The GSL routines integrate to a relative accuracy of 1e-7.
+
+if (diff_gsl > 1e-6_rp) then
+  print '(a, es10.2)', 'ibs_rates_calc: Rates differ from the GSL routines by (relative): ', diff_gsl
+  ok = .false.
+endif
+
+if (diff_cpp > 1e-12_rp) then
+  print '(a, es10.2)', 'Ibs_engine: Rates differ from ibs_rates_calc by (relative): ', diff_cpp
+  ok = .false.
+endif
+
+end subroutine ibs_engine_test
+
+end module
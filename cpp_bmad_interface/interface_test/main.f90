@@ -2,6 +2,9 @@
 program cpp_bmad_interface_test
 
 use bmad_cpp_test_mod
+use csr_engine_test_mod
+use beambeam_engine_test_mod
+use ibs_engine_test_mod
 
 logical ok, all_ok
 
@@ -101,6 +104,9 @@ call test1_f_beam(ok); if (.not. ok) all_ok = .false.
 call test1_f_aperture_point(ok); if (.not. ok) all_ok = .false.
 call test1_f_aperture_param(ok); if (.not. ok) all_ok = .false.
 call test1_f_aperture_scan(ok); if (.not. ok) all_ok = .false.
+call csr_engine_test(ok); if (.not. ok) all_ok = .false.
+call beambeam_engine_test(ok); if (.not. ok) all_ok = .false.
+call ibs_engine_test(ok); if (.not. ok) all_ok = .false.
 
 print *
 if (all_ok) then
@@ -2049,11 +2049,18 @@ if not os.path.exists(params.test_dir):
     sys.exit ('DIRECTORY DOES NOT EXIST: ' + params.test_dir)
 f_test = open(params.test_dir + '/main.f90', 'w')
 
+extra_tests = getattr(params, 'extra_tests', [])
+
 f_test.write('''
 program cpp_bmad_interface_test
 
 use bmad_cpp_test_mod
+''')
+
+for test in extra_tests:
+  f_test.write ('use ' + test[0] + '\n')
 
+f_test.write('''
 logical ok, all_ok
 
 !
@@ -2064,6 +2071,9 @@ all_ok = .true.
 for struct in struct_definitions:
   f_test.write ('call test1_f_' + struct.short_name + '(ok); if (.not. ok) all_ok = .false.\n')
 
+for test in extra_tests:
+  f_test.write ('call ' + test[1] + '(ok); if (.not. ok) all_ok = .false.\n')
+
 f_test.write('''
 print *
 if (all_ok) then
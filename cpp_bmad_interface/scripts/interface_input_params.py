@@ -14,6 +14,15 @@ conversion_use_statements = ['use bmad_struct']
 equality_use_statements = ['use bmad_struct']
 test_use_statements = []
 
+# Hand written tests in the test directory that are run after the structure tests:
+# (module name, subroutine name). The subroutine has a single logical ok argument.
+
+extra_tests = [
+    ('csr_engine_test_mod', 'csr_engine_test'),
+    ('beambeam_engine_test_mod', 'beambeam_engine_test'),
+    ('ibs_engine_test_mod', 'ibs_engine_test'),
+]
+
 # List of structures to setup interfaces for.
 # List must be in ordered such that if struct A is a component of struct B,
 # then A must be before B in the list.
@@ -0,0 +1,390 @@
+//+
+// C++ side of the APISA selector tests. See apisa_test.f90.
+//-
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "nd_sort.hpp"
+#include "dominance.hpp"
+#include "spea2_selector.hpp"
+
+using namespace std;
+
+// Random numbers in [0, 1) from a 64 bit linear congruential generator so the
+// populations are the same on every platform.
+
+static unsigned long long test_rng;
+
+static double test_uniform() {
+  test_rng = test_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (test_rng >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Constraint dominance as in ApisaSelector::con_dominates: Feasible individuals are compared by
+// Pareto dominance, a feasible individual dominates an infeasible one and two infeasible
+// individuals are compared by their violated constraints.
+
+static bool test_con_dominates(const double* fa, const double* ca, const double* fb, const double* cb,
+                               int dim, int con) {
+  bool a_feasible = true, b_feasible = true;
+  for (int j = 0; j < con; j++) {
+    if (ca[j] < 0) a_feasible = false;
+    if (cb[j] < 0) b_feasible = false;
+  }
+
+  if (a_feasible && b_feasible) {
+    bool better = false;
+    for (int d = 0; d < dim; d++) {
+      if (fa[d] > fb[d]) return false;
+      if (fa[d] < fb[d]) better = true;
+    }
+    return better;
+  }
+  if (a_feasible) return true;
+  if (b_feasible) return false;
+
+  bool better = false;
+  for (int j = 0; j < con; j++) {
+    if (ca[j] >= 0 && cb[j] >= 0) continue;
+    if (ca[j] < cb[j]) return false;
+    if (ca[j] > cb[j]) better = true;
+  }
+  return better;
+}
+
+// Random population. The objectives and constraints are random or, with n_level > 0, take a few
+// values so there are ties and duplicate points. About a third of the constraint values are violated.
+
+static void test_population(int size, int dim, int con, int n_level, vector<double>& f_data,
+                            vector<double>& c_data, vector<double*>& f, vector<double*>& c) {
+  f_data.resize(size * dim);
+  c_data.resize(size * con + 1);
+  f.resize(size + 1);
+  c.resize(size + 1);
+  for (int i = 0; i < size; i++) {
+    f[i] = &f_data[i * dim];
+    c[i] = &c_data[i * con];
+    for (int d = 0; d < dim; d++) {
+      f[i][d] = test_uniform();
+      if (n_level > 0) f[i][d] = int(n_level * f[i][d]);
+    }
+    for (int j = 0; j < con; j++) {
+      double u = test_uniform();
+      c[i][j] = (n_level > 0) ? int(3 * u) - 1 : 1.5 * u - 0.5;
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+// Compares nd_sort with peeling off the non-dominated individuals one front at a time.
+// n_front is the number of fronts from nd_sort and n_diff the number of individuals
+// whose front differs.
+
+extern "C" void apisa_nd_sort_test (const int& size, const int& dim, const int& con, const int& n_level,
+                                    const int& seed, int& n_front, int& n_diff) {
+  test_rng = (unsigned long long)seed;
+
+  vector<double> f_data, c_data;
+  vector<double*> f, c;
+  test_population(size, dim, con, n_level, f_data, c_data, f, c);
+
+  vector<int> rank(size + 1), rank_peel(size + 1, -1);
+  n_front = nd_sort(size, dim, con, &f[0], &c[0], &rank[0]);
+
+  int n_left = size;
+  for (int front = 0; n_left > 0; front++) {
+    vector<int> members;
+    for (int i = 0; i < size; i++) {
+      if (rank_peel[i] >= 0) continue;
+      bool dominated = false;
+      for (int k = 0; k < size && !dominated; k++) {
+        if (k == i || rank_peel[k] >= 0) continue;
+        dominated = test_con_dominates(f[k], c[k], f[i], c[i], dim, con);
+      }
+      if (!dominated) members.push_back(i);
+    }
+    for (size_t m = 0; m < members.size(); m++) rank_peel[members[m]] = front;
+    n_left -= int(members.size());
+  }
+
+  n_diff = 0;
+  for (int i = 0; i < size; i++) {
+    if (rank[i] != rank_peel[i]) n_diff++;
+  }
+}
+
+//--------------------------------------------------------------------
+// Compares the SPEA2 strength and raw fitness from strength_fitness with the N^2 double loop:
+// The strength of i is the number of individuals that i dominates and the raw fitness the sum of
+// the strengths of the individuals that dominate i.
+// n_nondominated is the number with raw fitness 0 and n_diff the number of individuals
+// whose strength or raw fitness differs.
+
+extern "C" void apisa_strength_test (const int& size, const int& dim, const int& con, const int& n_level,
+                                     const int& seed, int& n_nondominated, int& n_diff) {
+  test_rng = (unsigned long long)seed;
+
+  vector<double> f_data, c_data;
+  vector<double*> f, c;
+  test_population(size, dim, con, n_level, f_data, c_data, f, c);
+
+  vector<int> strength(size + 1), raw(size + 1);
+  strength_fitness(size, dim, con, &f[0], &c[0], &strength[0], &raw[0]);
+
+  vector<int> strength_loop(size + 1, 0), raw_loop(size + 1, 0);
+  for (int i = 0; i < size; i++) {
+    for (int j = 0; j < size; j++) {
+      if (test_con_dominates(f[i], c[i], f[j], c[j], dim, con)) strength_loop[i]++;
+    }
+  }
+  for (int i = 0; i < size; i++) {
+    for (int j = 0; j < size; j++) {
+      if (test_con_dominates(f[j], c[j], f[i], c[i], dim, con)) raw_loop[i] += strength_loop[j];
+    }
+  }
+
+  n_nondominated = 0;
+  n_diff = 0;
+  for (int i = 0; i < size; i++) {
+    if (raw[i] == 0) n_nondominated++;
+    if (strength[i] != strength_loop[i] || raw[i] != raw_loop[i]) n_diff++;
+  }
+}
+
+//--------------------------------------------------------------------
+// SPEA2 environmental selection as done by the original aspea2 (before the k-d tree): dense distance
+// matrix, neighbors ordered by distance and then by index, one deletion at a time. The random
+// numbers are the same as those of ApisaSelector::irand.
+
+struct Spea2Reference {
+  int alpha, dim, kth_param;
+  unsigned long long rng;
+  vector<vector<double> > f;
+  vector<int> id;
+
+  int size, kth;
+  vector<int> fitness, copies;
+  vector<char> alive;
+  vector<double> dist;
+  vector<vector<int> > nn;
+
+  int irand(int range) {
+    rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    return int(range * ((rng >> 11) * (1.0 / 9007199254740992.0)));
+  }
+
+  int get_nn(int i, int k) {
+    if (nn[i].empty()) {
+      vector<pair<double, int> > d;
+      for (int j = 0; j < size; j++) {
+        if (j != i) d.push_back(make_pair(dist[i * size + j], j));
+      }
+      sort(d.begin(), d.end());
+      nn[i].push_back(i);
+      for (size_t m = 0; m < d.size(); m++) nn[i].push_back(d[m].second);
+    }
+    return nn[i][k];
+  }
+
+  // Distance to the k-th neighbor, -1 if that neighbor has been deleted.
+  double get_nnd(int i, int k) {
+    int j = get_nn(i, k);
+    return (copies[j] == 0) ? -1 : dist[i * size + j];
+  }
+
+  void truncate_nondominated() {
+    int n_nondominated = 0;
+    for (int i = 0; i < size; i++) {
+      if (fitness[i] > 0) {alive[i] = 0; copies[i] = 0;}
+      else n_nondominated++;
+    }
+
+    while (n_nondominated > alpha) {
+      vector<int> marked;
+      int max_copies = 0;
+      for (int i = 0; i < size; i++) {
+        if (copies[i] > max_copies) {marked.clear(); max_copies = copies[i];}
+        if (copies[i] == max_copies) marked.push_back(i);
+      }
+
+      int count = marked.size();
+      if (count > max_copies) {
+        vector<int> neighbor(count, kth);
+        while (count > max_copies) {
+          double min_dist = 1e99;
+          int count2 = 0;
+          for (int i = 0; i < count; i++) {
+            double my_dist = -1;
+            while (my_dist == -1 && neighbor[i] < size) {
+              my_dist = get_nnd(marked[i], neighbor[i]);
+              neighbor[i]++;
+            }
+            if (my_dist < min_dist) {count2 = 0; min_dist = my_dist;}
+            if (my_dist == min_dist) {
+              marked[count2] = marked[i];
+              neighbor[count2] = neighbor[i];
+              count2++;
+            }
+          }
+          count = count2;
+          if (min_dist == -1) break;
+        }
+      }
+
+      int del = marked[irand(count)];
+      alive[del] = 0;
+      for (int i = 0; i < count; i++) {
+        if (dist[del * size + marked[i]] == 0) copies[marked[i]]--;
+      }
+      copies[del] = 0;
+      n_nondominated--;
+    }
+  }
+
+  void truncate_dominated() {
+    vector<int> sorted_fitness(fitness);
+    sort(sorted_fitness.begin(), sorted_fitness.end());
+    int j = sorted_fitness[alpha - 1];
+    int num = 0, num_better = 0;
+    for (int i = 0; i < size; i++) {
+      if (fitness[i] <= j) num++;
+      if (fitness[i] < j) num_better++;
+    }
+
+    if (num == alpha) {
+      for (int i = 0; i < size; i++) {
+        if (fitness[i] > j) alive[i] = 0;
+      }
+      return;
+    }
+
+    int free_spaces = alpha - num_better, fill_level = 0;
+    vector<int> best(free_spaces);
+    for (int i = 0; i < size; i++) {
+      if (fitness[i] > j) {
+        alive[i] = 0;
+      } else if (fitness[i] == j) {
+        if (fill_level < free_spaces) {
+          best[fill_level++] = i;
+        } else if (get_nnd(i, kth) <= get_nnd(best[free_spaces - 1], kth)) {
+          alive[i] = 0;
+          continue;
+        } else {
+          alive[best[free_spaces - 1]] = 0;
+          best[free_spaces - 1] = i;
+        }
+        for (int k = fill_level - 1; k > 0; k--) {
+          if (get_nnd(best[k], kth) <= get_nnd(best[k - 1], kth)) break;
+          swap(best[k], best[k - 1]);
+        }
+      }
+    }
+  }
+
+  // Truncates the population f, id to alpha individuals.
+  void environmental_selection() {
+    size = f.size();
+    kth = (kth_param > 0) ? kth_param : int(sqrt(double(size)));
+
+    fitness.assign(size, 0);
+    vector<int> strength(size, 0);
+    for (int i = 0; i < size; i++) {
+      for (int j = 0; j < size; j++) {
+        if (test_con_dominates(&f[i][0], 0, &f[j][0], 0, dim, 0)) strength[i]++;
+      }
+    }
+    int n_nondominated = 0;
+    for (int i = 0; i < size; i++) {
+      for (int j = 0; j < size; j++) {
+        if (test_con_dominates(&f[j][0], 0, &f[i][0], 0, dim, 0)) fitness[i] += strength[j];
+      }
+      if (fitness[i] == 0) n_nondominated++;
+    }
+
+    dist.assign(size * size, 0);
+    copies.assign(size, 0);
+    for (int i = 0; i < size; i++) {
+      for (int j = 0; j < size; j++) {
+        double sum = 0;
+        for (int d = 0; d < dim; d++) sum += (f[i][d] - f[j][d]) * (f[i][d] - f[j][d]);
+        dist[i * size + j] = sqrt(sum);
+        if (sum == 0) copies[i]++;
+      }
+    }
+    nn.assign(size, vector<int>());
+    alive.assign(size, 1);
+
+    if (n_nondominated > alpha) truncate_nondominated();
+    else if (size > alpha) truncate_dominated();
+
+    vector<vector<double> > f_new;
+    vector<int> id_new;
+    for (int i = 0; i < size; i++) {
+      if (!alive[i]) continue;
+      f_new.push_back(f[i]);
+      id_new.push_back(id[i]);
+    }
+    f.swap(f_new);
+    id.swap(id_new);
+  }
+};
+
+//--------------------------------------------------------------------
+// Compares the archive of Spea2Selector over n_gen generations with Spea2Reference.
+// The objectives are on an integer grid with n_level steps so there are many duplicate points and
+// equal distances. With on_plane, all points have the same objective sum, so they are all
+// non-dominated and truncate_nondominated (copies, then truncate_distinct) is used. Otherwise
+// most are dominated and truncate_dominated is used with ties in fitness and distance.
+// kth = 0 uses the square root of the population size.
+// n_archive is the final archive size and n_diff the number of generations in which the
+// archives differ.
+
+extern "C" void apisa_spea2_truncation_test (const int& alpha, const int& lambda, const int& dim,
+                                             const int& n_level, const int& on_plane, const int& kth,
+                                             const int& n_gen, const int& seed, int& n_archive, int& n_diff) {
+  const int tournament = 2;
+  test_rng = (unsigned long long)seed;
+
+  Spea2Selector selector(alpha, lambda, lambda, dim, 0, seed, tournament, kth);
+  Spea2Reference ref;
+  ref.alpha = alpha;
+  ref.dim = dim;
+  ref.kth_param = kth;
+  ref.rng = (unsigned long long)seed;
+  ref.irand(1);
+
+  int next_id = 0;
+  n_diff = 0;
+
+  for (int gen = 0; gen <= n_gen; gen++) {
+    int n = (gen == 0) ? alpha : lambda;
+    vector<double> f(n * dim);
+    vector<int> index(n);
+    for (int i = 0; i < n; i++) {
+      double sum = 0;
+      for (int d = 0; d < dim; d++) {
+        f[i * dim + d] = int(n_level * test_uniform());
+        sum += f[i * dim + d];
+      }
+      if (on_plane) {
+        f[i * dim + dim - 1] = n_level * (dim - 1) - (sum - f[i * dim + dim - 1]);
+      }
+      index[i] = next_id++;
+      ref.f.push_back(vector<double>(&f[i * dim], &f[i * dim] + dim));
+      ref.id.push_back(index[i]);
+    }
+
+    if (gen == 0) selector.select_initial(n, &index[0], &f[0], 0);
+    else selector.select_normal(n, &index[0], &f[0], 0);
+
+    ref.environmental_selection();
+    for (int i = 0; i < lambda * tournament; i++) ref.irand(1);   // Mating selection.
+
+    vector<int> archive(selector.archive_size());
+    if (archive.size() > 0) selector.archive(&archive[0]);
+    if (archive != ref.id) n_diff++;
+    n_archive = archive.size();
+  }
+}
@@ -0,0 +1,90 @@
+!+
+! Program apisa_test
+!
+! This program is part of the Bmad regression testing suite.
+!
+! Tests of the APISA multi-objective selectors (bsim/apisa/common):
+!   nd_sort    -- Non-dominated sorting is checked against peeling off one front at a time.
+!                 The populations cover the sweeps for 1, 2, 3 and more objectives,
+!                 tied and duplicate points, and infeasible individuals.
+!   strength   -- SPEA2 strength and raw fitness (strength_fitness) are checked against
+!                 the N^2 double loop over the same populations.
+!   spea2      -- The SPEA2 archive is checked against the original dense distance matrix
+!                 truncation over several generations, with duplicate points and equal
+!                 distances on an integer grid.
+!-
+
+program apisa_test
+
+use, intrinsic :: iso_c_binding
+
+implicit none
+
+interface
+  subroutine apisa_nd_sort_test (size, dim, con, n_level, seed, n_front, n_diff) bind(c)
+    import c_int
+    integer(c_int) size, dim, con, n_level, seed, n_front, n_diff
+  end subroutine
+
+  subroutine apisa_strength_test (size, dim, con, n_level, seed, n_nondominated, n_diff) bind(c)
+    import c_int
+    integer(c_int) size, dim, con, n_level, seed, n_nondominated, n_diff
+  end subroutine
+
+  subroutine apisa_spea2_truncation_test (alpha, lambda, dim, n_level, on_plane, kth, n_gen, seed, &
+                                                                           n_archive, n_diff) bind(c)
+    import c_int
+    integer(c_int) alpha, lambda, dim, n_level, on_plane, kth, n_gen, seed, n_archive, n_diff
+  end subroutine
+end interface
+
+integer, parameter :: sizes(4) = [1, 2, 60, 400], dims(6) = [1, 2, 3, 4, 5, 8]
+integer is, id, con, lev, n_front, n_diff, n_nondominated, n_archive, ip, kth
+character(40) name
+
+!
+
+open (1, file = 'output.now')
+
+do is = 1, size(sizes)
+  do id = 1, size(dims)
+    do con = 0, 2, 2
+      do lev = 0, 4, 4
+        call apisa_nd_sort_test (sizes(is), dims(id), con, lev, 1000*is + 10*id + con + lev, n_front, n_diff)
+        write (name, '(a, 4(a, i0))') 'nd_sort', ':N', sizes(is), ':M', dims(id), ':C', con, ':L', lev
+        write (1, '(3a, 2i6)') '"', trim(name), '" ABS 0', n_front, n_diff
+      enddo
+    enddo
+  enddo
+enddo
+
+do is = 1, size(sizes)
+  do id = 1, size(dims)
+    do con = 0, 2, 2
+      do lev = 0, 4, 4
+        call apisa_strength_test (sizes(is), dims(id), con, lev, 2000*is + 10*id + con + lev, n_nondominated, n_diff)
+        write (name, '(a, 4(a, i0))') 'strength', ':N', sizes(is), ':M', dims(id), ':C', con, ':L', lev
+        write (1, '(3a, 2i6)') '"', trim(name), '" ABS 0', n_nondominated, n_diff
+      enddo
+    enddo
+  enddo
+enddo
+
+! Cases: Points in a box (truncate_dominated), points on a plane with few distinct points
+! (truncate_nondominated removing copies) and with more distinct points than the archive holds
+! (truncate_distinct after the copies are gone).
+
+do id = 2, 3
+  do ip = 1, 3
+    lev = merge(6, merge(50, 12, id == 2), ip < 3)
+    do kth = 0, 3, 3
+      call apisa_spea2_truncation_test (40, 40, id, lev, min(ip-1, 1), kth, 6, 3000 + 10*id + ip + kth, n_archive, n_diff)
+      write (name, '(a, 4(a, i0))') 'spea2', ':M', id, ':P', min(ip-1, 1), ':L', lev, ':K', kth
+      write (1, '(3a, 2i6)') '"', trim(name), '" ABS 0', n_archive, n_diff
+    enddo
+  enddo
+enddo
+
+close (1)
+
+end program
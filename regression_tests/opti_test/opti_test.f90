@@ -0,0 +1,139 @@
+!+
+! Program opti_test
+!
+! This program is part of the Bmad regression testing suite.
+!
+! Tests of the C optimizers in sim_utils/optimizers/opti.cpp: convergence of the
+! DE (opti_, opti_async_), SHADE and CMA-ES optimizers, independence of the result from
+! the number of threads and from the use of worker processes, checkpoint and resume,
+! and the merit cache.
+!-
+
+program opti_test
+
+use opti_test_mod
+
+implicit none
+
+real(rp) v0(n_dim), v_del(n_dim), vec(n_dim), vec2(n_dim), merit, merit2
+integer(c_long) hits, misses, n_entries
+integer(8) n0
+integer iu
+
+character(*), parameter :: ckpt_file = 'opti_test.ckpt', cache_file = 'opti_test.cache'
+
+!
+
+open (1, file = 'output.now')
+
+call delete_file (ckpt_file)
+call delete_file (cache_file)
+
+v0 = 0
+v_del = 3
+
+! Convergence. The merit functions stop the optimizers at the target.
+
+merit_target = 1e-8_rp
+
+call opti_set_seed_c(1)
+merit = opti_c(vec, 2000, 40, n_dim, c_funloc(sphere_merit), v0, v_del)
+write (1, '(a, l1, a)') '"opti:sphere" STR "', merit < merit_target, '"'
+
+call opti_set_seed_c(1)
+merit = opti_shade_c(vec, 2000, 40, n_dim, c_funloc(sphere_merit), v0, v_del, 1)
+write (1, '(a, l1, a)') '"opti_shade:sphere" STR "', merit < merit_target, '"'
+
+call opti_set_seed_c(1)
+merit = opti_cmaes_c(vec, 2000, 0, n_dim, c_funloc(ellipsoid_merit), v0, v_del, 1, 0)
+write (1, '(a, l1, a)') '"opti_cmaes:ellipsoid" STR "', merit < merit_target, '"'
+
+! The result of opti_async_ depends upon the order in which the evaluations finish.
+
+call opti_set_seed_c(1)
+merit = opti_async_c(vec, 2000, 40, n_dim, c_funloc(sphere_merit), v0, v_del, 4)
+write (1, '(a, l1, a)') '"opti_async:sphere" STR "', merit < merit_target, '"'
+
+! The synchronous mode result does not depend upon the number of threads or
+! the use of worker processes.
+
+merit_target = -1
+
+call opti_set_seed_c(2)
+merit = opti_parallel_c(vec, 50, 20, n_dim, c_funloc(rastrigin_merit), v0, v_del, 1)
+call opti_set_seed_c(2)
+merit2 = opti_parallel_c(vec2, 50, 20, n_dim, c_funloc(rastrigin_merit), v0, v_del, 4)
+write (1, '(a, l1, a)') '"opti_parallel:threads" STR "', merit == merit2 .and. all(vec == vec2), '"'
+
+call opti_procs_setup_c(2, c_null_funptr)
+call opti_set_seed_c(2)
+merit2 = opti_parallel_c(vec2, 50, 20, n_dim, c_funloc(rastrigin_merit), v0, v_del, 1)
+call opti_procs_setup_c(0, c_null_funptr)
+write (1, '(a, l1, a)') '"opti_parallel:procs" STR "', merit == merit2 .and. all(vec == vec2), '"'
+
+! A run stopped and resumed from its checkpoint is the same as an uninterrupted run.
+
+call opti_set_seed_c(3)
+merit = opti_c(vec, 120, 20, n_dim, c_funloc(rastrigin_merit), v0, v_del)
+
+call opti_checkpoint_setup_c(ckpt_file // c_null_char, 10)
+call opti_set_seed_c(3)
+merit2 = opti_c(vec2, 60, 20, n_dim, c_funloc(rastrigin_merit), v0, v_del)
+merit2 = opti_resume_c(vec2, 120, 20, n_dim, c_funloc(rastrigin_merit), ckpt_file // c_null_char, 1)
+call opti_checkpoint_setup_c(c_null_char, 0)
+write (1, '(a, l1, a)') '"opti_resume" STR "', merit == merit2 .and. all(vec == vec2), '"'
+call delete_file (ckpt_file)
+
+call opti_set_seed_c(3)
+merit = opti_shade_c(vec, 120, 20, n_dim, c_funloc(rastrigin_merit), v0, v_del, 1)
+
+call opti_checkpoint_setup_c(ckpt_file // c_null_char, 10)
+call opti_set_seed_c(3)
+merit2 = opti_shade_c(vec2, 60, 20, n_dim, c_funloc(rastrigin_merit), v0, v_del, 1)
+merit2 = opti_shade_resume_c(vec2, 120, 20, n_dim, c_funloc(rastrigin_merit), ckpt_file // c_null_char, 1)
+call opti_checkpoint_setup_c(c_null_char, 0)
+write (1, '(a, l1, a)') '"opti_shade_resume" STR "', merit == merit2 .and. all(vec == vec2), '"'
+call delete_file (ckpt_file)
+
+call opti_set_seed_c(3)
+merit = opti_cmaes_c(vec, 1000, 0, n_dim, c_funloc(rastrigin_merit), v0, v_del, 1, 2)
+
+call opti_checkpoint_setup_c(ckpt_file // c_null_char, 7)
+call opti_set_seed_c(3)
+merit2 = opti_cmaes_c(vec2, 300, 0, n_dim, c_funloc(rastrigin_merit), v0, v_del, 1, 2)
+merit2 = opti_cmaes_resume_c(vec2, 1000, n_dim, c_funloc(rastrigin_merit), ckpt_file // c_null_char, 1, 2)
+call opti_checkpoint_setup_c(c_null_char, 0)
+write (1, '(a, l1, a)') '"opti_cmaes_resume" STR "', merit == merit2 .and. all(vec == vec2), '"'
+call delete_file (ckpt_file)
+
+! Merit cache. The second run gets all its merit values from the cache file.
+
+call opti_cache_setup_c(1, 0.0_rp, 100000, cache_file // c_null_char)
+call opti_set_seed_c(4)
+n0 = n_eval
+merit = opti_c(vec, 50, 20, n_dim, c_funloc(rastrigin_merit), v0, v_del)
+call opti_cache_stats_c(hits, misses, n_entries)
+write (1, '(a, l1, a)') '"opti_cache:first" STR "', misses == n_eval - n0 .and. n_entries > 0, '"'
+
+call opti_set_seed_c(4)
+n0 = n_eval
+merit2 = opti_c(vec2, 50, 20, n_dim, c_funloc(rastrigin_merit), v0, v_del)
+call opti_cache_stats_c(hits, misses, n_entries)
+write (1, '(a, l1, a)') '"opti_cache:second" STR "', n_eval == n0 .and. misses == 0 .and. &
+                                                       merit == merit2 .and. all(vec == vec2), '"'
+call opti_cache_setup_c(0, 0.0_rp, 0, c_null_char)
+call delete_file (cache_file)
+
+close (1)
+
+!------------------------------------------------------------------------
+contains
+
+subroutine delete_file (file)
+character(*) file
+integer ios
+open (newunit = iu, file = file, iostat = ios)
+if (ios == 0) close (iu, status = 'delete')
+end subroutine delete_file
+
+end program
@@ -0,0 +1,184 @@
+!+
+! Module opti_test_mod
+!
+! Interfaces to the C optimizers of sim_utils/optimizers/opti.cpp and the merit
+! functions used by the opti_test program.
+!-
+
+module opti_test_mod
+
+use precision_def
+use, intrinsic :: iso_c_binding
+
+implicit none
+
+integer, parameter :: n_dim = 8
+
+real(rp), save :: merit_target = -1     ! end_flag is set when the merit is below this.
+integer(8), save :: n_eval = 0          ! Number of merit evaluations (in this process).
+
+interface
+  function opti_c (vec, gen, pop, n_vars, merit, v0, v_del) result (best) bind(c, name = 'opti_')
+    import
+    real(c_double) vec(*), v0(*), v_del(*), best
+    integer(c_int) gen, pop, n_vars
+    type (c_funptr), value :: merit
+  end function
+
+  function opti_parallel_c (vec, gen, pop, n_vars, merit, v0, v_del, n_threads) result (best) bind(c, name = 'opti_parallel_')
+    import
+    real(c_double) vec(*), v0(*), v_del(*), best
+    integer(c_int) gen, pop, n_vars, n_threads
+    type (c_funptr), value :: merit
+  end function
+
+  function opti_async_c (vec, gen, pop, n_vars, merit, v0, v_del, n_threads) result (best) bind(c, name = 'opti_async_')
+    import
+    real(c_double) vec(*), v0(*), v_del(*), best
+    integer(c_int) gen, pop, n_vars, n_threads
+    type (c_funptr), value :: merit
+  end function
+
+  function opti_shade_c (vec, gen, pop, n_vars, merit, v0, v_del, n_threads) result (best) bind(c, name = 'opti_shade_')
+    import
+    real(c_double) vec(*), v0(*), v_del(*), best
+    integer(c_int) gen, pop, n_vars, n_threads
+    type (c_funptr), value :: merit
+  end function
+
+  function opti_cmaes_c (vec, gen, pop, n_vars, merit, v0, v_del, n_threads, n_restart) result (best) bind(c, name = 'opti_cmaes_')
+    import
+    real(c_double) vec(*), v0(*), v_del(*), best
+    integer(c_int) gen, pop, n_vars, n_threads, n_restart
+    type (c_funptr), value :: merit
+  end function
+
+  function opti_resume_c (vec, gen, pop, n_vars, merit, file, n_threads) result (best) bind(c, name = 'opti_resume_')
+    import
+    real(c_double) vec(*), best
+    integer(c_int) gen, pop, n_vars, n_threads
+    type (c_funptr), value :: merit
+    character(kind = c_char) file(*)
+  end function
+
+  function opti_shade_resume_c (vec, gen, pop, n_vars, merit, file, n_threads) result (best) bind(c, name = 'opti_shade_resume_')
+    import
+    real(c_double) vec(*), best
+    integer(c_int) gen, pop, n_vars, n_threads
+    type (c_funptr), value :: merit
+    character(kind = c_char) file(*)
+  end function
+
+  function opti_cmaes_resume_c (vec, gen, n_vars, merit, file, n_threads, n_restart) result (best) &
+                                                                            bind(c, name = 'opti_cmaes_resume_')
+    import
+    real(c_double) vec(*), best
+    integer(c_int) gen, n_vars, n_threads, n_restart
+    type (c_funptr), value :: merit
+    character(kind = c_char) file(*)
+  end function
+
+  subroutine opti_set_seed_c (seed) bind(c, name = 'opti_set_seed_')
+    import
+    integer(c_int) seed
+  end subroutine
+
+  subroutine opti_checkpoint_setup_c (file, every) bind(c, name = 'opti_checkpoint_setup_')
+    import
+    character(kind = c_char) file(*)
+    integer(c_int) every
+  end subroutine
+
+  subroutine opti_cache_setup_c (enable, tol, max_entries, file) bind(c, name = 'opti_cache_setup_')
+    import
+    integer(c_int) enable, max_entries
+    real(c_double) tol
+    character(kind = c_char) file(*)
+  end subroutine
+
+  subroutine opti_cache_stats_c (hits, misses, n_entries) bind(c, name = 'opti_cache_stats_')
+    import
+    integer(c_long) hits, misses, n_entries
+  end subroutine
+
+  subroutine opti_procs_setup_c (n_procs, init) bind(c, name = 'opti_procs_setup_')
+    import
+    integer(c_int) n_procs
+    type (c_funptr), value :: init
+  end subroutine
+end interface
+
+contains
+
+!------------------------------------------------------------------------
+! The minimum of each merit function is 0 at x(i) = shift(i).
+
+function shift (i) result (s)
+integer i
+real(rp) s
+s = 0.8_rp * sin(1.7_rp * i + 0.3_rp)
+end function shift
+
+!------------------------------------------------------------------------
+
+function sphere_merit (vec, end_flag) result (merit) bind(c)
+
+real(c_double) vec(*), merit
+integer(c_int) end_flag
+integer i
+
+merit = 0
+do i = 1, n_dim
+  merit = merit + (vec(i) - shift(i))**2
+enddo
+call count_eval (merit, end_flag)
+
+end function sphere_merit
+
+!------------------------------------------------------------------------
+
+function ellipsoid_merit (vec, end_flag) result (merit) bind(c)
+
+real(c_double) vec(*), merit
+integer(c_int) end_flag
+integer i
+
+merit = 0
+do i = 1, n_dim
+  merit = merit + 1e6_rp**(real(i-1, rp) / (n_dim-1)) * (vec(i) - shift(i))**2
+enddo
+call count_eval (merit, end_flag)
+
+end function ellipsoid_merit
+
+!------------------------------------------------------------------------
+
+function rastrigin_merit (vec, end_flag) result (merit) bind(c)
+
+real(rp), parameter :: twopi = 6.283185307179586476925286766559_rp
+real(c_double) vec(*), merit
+integer(c_int) end_flag
+integer i
+
+merit = 10 * n_dim
+do i = 1, n_dim
+  merit = merit + (vec(i) - shift(i))**2 - 10 * cos(twopi * (vec(i) - shift(i)))
+enddo
+call count_eval (merit, end_flag)
+
+end function rastrigin_merit
+
+!------------------------------------------------------------------------
+
+subroutine count_eval (merit, end_flag)
+
+real(rp) merit
+integer(c_int) end_flag
+
+!$omp atomic
+n_eval = n_eval + 1
+if (merit < merit_target) end_flag = 1
+
+end subroutine count_eval
+
+end module
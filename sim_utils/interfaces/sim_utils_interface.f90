@@ -202,12 +202,27 @@ function factorial(n) result (fact)
   integer n
 end function
 
+subroutine faddeeva_batch(z_re, z_im, w_re, w_im)
+  import
+  implicit none
+  real(rp), contiguous :: z_re(:), z_im(:), w_re(:), w_im(:)
+end subroutine
+
 subroutine faddeeva_function(z, w, dw)
   import
   implicit none
   real(rp) z(2), w(2), dw(2,2)
 end subroutine
 
+subroutine faddeeva_table_setup (enable, relerr, file_name, err_flag)
+  import
+  implicit none
+  logical enable
+  logical, optional :: err_flag
+  real(rp), optional :: relerr
+  character(*), optional :: file_name
+end subroutine
+
 subroutine fff_sub(line, error)
   implicit none
   character(*) line
@@ -32,6 +32,134 @@ function merit (vec, end_flag) result (this_merit)
   ...
 end function
 
+Parallel evaluation:
+  Opti::Optimize normally evaluates one trial strand at a time and replaces the
+  parent as soon as the trial is evaluated. In "synchronous" mode all population
+  trial strands of a generation are built first, evaluated together, and then
+  selection is done. The trials can be evaluated either with a batch merit function
+  or by running the ordinary merit function over a pool of threads (OpenMP).
+
+  opti_batch_(vec, gen, pop, n_vars, batch_merit, v0, v_del)
+  opti_parallel_(vec, gen, pop, n_vars, merit, v0, v_del, n_threads)
+
+  n_threads     -- Integer: Number of threads. 0 => Use OpenMP default.
+
+The batch merit function prototype is:
+
+subroutine batch_merit (vecs, n_vec, n_vars, merits, end_flag) bind(c)
+  real(c_double) vecs(n_vars, n_vec)  ! Input: trial strands.
+  integer(c_int), value :: n_vec      ! Input: Number of strands.
+  integer(c_int), value :: n_vars     ! Input: Number of genes per strand.
+  real(c_double) merits(n_vec)        ! Output: Merit values.
+  integer(c_int) end_flag             ! Output: Set = 1 to terminate optimization.
+  ...
+end subroutine
+
+The merit function used with opti_parallel_ must be thread safe.
+
+Asynchronous mode:
+  opti_async_(vec, gen, pop, n_vars, merit, v0, v_del, n_threads)
+  is a steady state version of opti_parallel_ for merit functions whose evaluation
+  time varies. Each thread takes a new trial as soon as it is done with the last and
+  a trial replaces its parent as soon as it is evaluated. The result depends upon
+  the order in which evaluations complete so is not reproducible. A thread that
+  finds no trial available sleeps until another thread returns a result.
+  With checkpointing, a checkpoint is written after every "every" * pop evaluations.
+
+  For workers that are not threads (other processes, etc.) use the completion
+  driven interface:
+    opt = opti_async_create_(gen, pop, n_vars, v0, v_del, max_in_flight)
+    ticket = opti_async_ask_(opt, vec)   ! ticket >= 0: Evaluate vec.
+                                          ! -1: Nothing available now. -2: Done.
+    call opti_async_tell_(opt, ticket, merit, end_flag)
+    this_merit = opti_async_best_(opt, vec)
+    call opti_async_destroy_(opt)
+  These calls are not thread safe.
+
+Adaptive DE:
+  opti_shade_(vec, gen, pop, n_vars, merit, v0, v_del, n_threads)
+  uses SHADE (success-history based parameter adaptation with an external archive
+  and current-to-pbest/1 mutation) in place of the fixed CR and F of opti_.
+  Generations are synchronous. n_threads = 1 evaluates serially.
+
+  With checkpointing (see below), opti_shade_ runs are resumed with
+  opti_shade_resume_(vec, gen, pop, n_vars, merit, file, n_threads)
+  which continues up to generation gen. The checkpoint holds the history memory and
+  the archive as well as the strands so the result is bit for bit the same as that
+  of an uninterrupted run.
+
+CMA-ES:
+  opti_cmaes_(vec, gen, pop, n_vars, merit, v0, v_del, n_threads, n_restart)
+  uses the covariance matrix adaptation evolution strategy which is better suited
+  for smooth but ill-conditioned problems.
+  pop           -- Integer: Population (lambda). 0 => Default 4 + 3 ln(n_vars).
+  n_threads     -- Integer: Number of threads used to evaluate a population. 1 => Serial.
+  n_restart     -- Integer: Maximum number of IPOP restarts (population doubled each time).
+  At most gen * pop merit evaluations are made. The merit function end_flag is honored.
+  gen and n_vars must be positive, pop must not be negative and all v_del must be positive.
+  The covariance update uses the BLAS routine dsyrk.
+
+  With checkpointing (see below), opti_cmaes_ runs are resumed with
+  opti_cmaes_resume_(vec, gen, n_vars, merit, file, n_threads, n_restart)
+  which continues up to gen * (initial pop) merit evaluations. The result is bit for
+  bit the same as that of an uninterrupted run.
+
+Process pool:
+  opti_procs_setup_(n_procs, init)
+  n_procs       -- Integer: Number of worker processes. 0 => Use threads (default).
+  init          -- Subroutine init(worker_index): Called in each worker after it starts.
+                     May be null.
+  With n_procs > 0, opti_parallel_, opti_shade_, opti_cmaes_ and the resume routines evaluate
+  merit functions in forked worker processes instead of threads so the merit function
+  does not need to be thread safe. Workers are forked at the start of each optimization,
+  before the optimizer starts any threads, so they see the caller's state (lattice, etc.)
+  at that time. A worker that crashes or times out is restarted and its trial retried.
+  Not available on Windows.
+
+  opti_procs_timeout_(timeout)
+  timeout       -- Real(8): Seconds a worker may take for one merit evaluation before it
+                     is killed and restarted. 0 => No limit (default).
+
+Merit cache:
+  opti_cache_setup_(enable, tol, max_entries, file)
+  enable        -- Integer: 0 => No cache (default).
+  tol           -- Real(8): Genes are quantized with this tolerance to form the cache key.
+                     0 => Exact match.
+  max_entries   -- Integer: Maximum number of cached values. Least recently used are dropped.
+  file          -- Character: Null terminated file name to load the cache from at the
+                     start of a run and save it to at the end. "" => No file.
+  opti_cache_stats_(hits, misses, n_entries) returns the cache statistics of the last
+  run (Integer(8)).
+  Each run has its own cache so values are only shared between runs through the file.
+  Delete the file if the merit function changes. The end_flag set by the merit function
+  is cached with the value (except with opti_batch_ where end_flag is not per strand).
+
+Checkpoint and restart:
+  opti_checkpoint_setup_(file, every)
+  file          -- Character: Null terminated checkpoint file name. "" => No checkpointing.
+  every         -- Integer: Write a checkpoint every this many generations. A checkpoint
+                     is also written at the end of the run.
+  Checkpoints are written for opti_, opti_batch_, opti_parallel_, opti_async_, opti_shade_,
+  opti_cmaes_ and the Mini/Maxi routines.
+  The file is written by a background thread to file.tmp and then renamed.
+
+  opti_resume_(vec, gen, pop, n_vars, merit, file, n_threads)
+  continues the run saved in file up to generation gen. The result is bit for bit the
+  same as that of an uninterrupted run. Runs made with opti_batch_, opti_parallel_ or
+  opti_async_ are resumed in synchronous mode using n_threads threads (a resumed
+  opti_async_ run is not the same as an uninterrupted one). opti_shade_ and opti_cmaes_
+  checkpoints have their own formats and are resumed with opti_shade_resume_ and
+  opti_cmaes_resume_.
+
+Random numbers:
+  A counter based generator (Philox) is used with an independent stream for each
+  strand in each generation. For a given seed the result is reproducible and
+  does not depend upon the number of threads used. To set the seed use:
+
+  opti_set_seed_(seed)
+
+  seed          -- Integer: Seed used by subsequent optimizations. Default is 0.
+
 */
 
 
@@ -44,8 +172,37 @@ end function
 #define _OPTI_H_
 
 #include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
+#include <condition_variable>
+#include <cstring>
 #include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <stdint.h>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#define OMP_PRAGMA(directive) _Pragma(#directive)
+#else
+#define OMP_PRAGMA(directive)
+#endif
+
+#if !defined(_WIN32)
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#endif
 
 // #elif defined(CESR_WINCVF)
 // #include <math.h>
@@ -56,9 +213,62 @@ end function
 using namespace std;
 
 typedef double (*EvalFunc) (double *, int&);
+typedef void (*BatchEvalFunc) (const double *, int, int, double *, int&);
+
+// Philox4x32-10 counter based random number generator.
+// Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11.
+//
+// The output is a pure function of (seed, stream, position) so every strand in
+// every generation gets its own independent stream. The results of a run
+// thus depend only upon the seed and not upon the number of threads.
+
+class Philox{
+ uint32_t ctr[4], key[2], out[4];
+ int n_out;              // Number of unused words in out.
+ void Round(uint32_t c[4], uint32_t k[2]){
+  uint64_t p0 = uint64_t(0xD2511F53u) * c[0];
+  uint64_t p1 = uint64_t(0xCD9E8D57u) * c[2];
+  uint32_t c1 = c[1], c3 = c[3];
+  c[0] = uint32_t(p1 >> 32) ^ c1 ^ k[0];
+  c[1] = uint32_t(p1);
+  c[2] = uint32_t(p0 >> 32) ^ c3 ^ k[1];
+  c[3] = uint32_t(p0);
+ }
+ void Block(){
+  uint32_t k[2] = {key[0], key[1]};
+  for(int i=0; i<4; i++) out[i] = ctr[i];
+  for(int r=0; r<10; r++){
+   if (r > 0) {k[0] += 0x9E3779B9u; k[1] += 0xBB67AE85u;}
+   Round(out, k);
+  }
+  if (++ctr[0] == 0) ctr[1]++;
+  n_out = 4;
+ }
+public:
+ Philox(uint64_t seed = 0, uint64_t stream = 0) {Init(seed, stream);}
+ void Init(uint64_t seed, uint64_t stream){
+  key[0] = uint32_t(seed);   key[1] = uint32_t(seed >> 32);
+  ctr[0] = 0;                ctr[1] = 0;
+  ctr[2] = uint32_t(stream); ctr[3] = uint32_t(stream >> 32);
+  n_out = 0;
+ }
+ uint32_t Next(){
+  if (n_out == 0) Block();
+  return out[4 - n_out--];
+ }
+ // Uniform in [0, 1) with 53 random bits.
+ double Uniform(){
+  uint32_t a = Next() >> 5, b = Next() >> 6;
+  return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+ }
+ // Uniform integer in [0, limit) without modulo bias.
+ int Int(int limit){
+  uint32_t n = uint32_t(limit), threshold = (0u - n) % n, r;
+  do {r = Next();} while (r < threshold);
+  return int(r % n);
+ }
+};
 
-inline int RandInt(int limit) {return rand()%limit;}
-inline double UniRand() {return double(rand())/RAND_MAX;}
 
 class Strand;
 class GenePool;
@@ -73,42 +283,55 @@ public:
 protected:
  int length;
  double cost;
+ bool own;          // False if gene points into the storage of a GenePool.
+ void View(double *g, int len){
+  if(own && gene) delete [] gene;
+  gene = g;
+  length = len;
+  own = false;
+ }
 public:
- Strand() : gene(0), length(0) {}
- Strand(int len) : length(len) {gene = new double[length];}
- Strand(Strand &s0) : length(s0.length){
+ Strand() : gene(0), length(0), cost(0), own(false) {}
+ Strand(int len) : length(len), cost(0), own(true) {gene = new double[length];}
+ Strand(const Strand &s0) : length(s0.length), own(true){
   gene = new double[length];
   this->operator=(s0);
  }
- Strand(double *v, int len) : length(len) {
+ Strand(Strand &&s0) : gene(s0.gene), length(s0.length), cost(s0.cost), own(s0.own){
+  s0.gene = 0;
+  s0.length = 0;
+  s0.own = false;
+ }
+ Strand(double *v, int len) : length(len), cost(0), own(true) {
   gene = new double[length];
   for(int i=0; i<len; i++) gene[i] = v[i];
  }
- ~Strand() {if(gene) delete [] gene;}
+ ~Strand() {if(own && gene) delete [] gene;}
  int Length(){ return length; }
  void Length(int len){
-  if(length>0) delete [] gene;
+  if(own && gene) delete [] gene;
   length = len;
   gene = new double[length];
+  own = true;
  }
  double& Cost() {return cost;}
- void Init(double delta){
-  for(int i=0; i<length; i++) gene[i] = 2.0*delta*(UniRand()-0.5);
+ void Init(Philox& r, double delta){
+  for(int i=0; i<length; i++) gene[i] = 2.0*delta*(r.Uniform()-0.5);
  }
- void Init(double offset, double delta){
-  for(int i=0; i<length; i++) gene[i] = 2.0*delta*(UniRand()-0.5) + offset;
+ void Init(Philox& r, double offset, double delta){
+  for(int i=0; i<length; i++) gene[i] = 2.0*delta*(r.Uniform()-0.5) + offset;
  }
- void Init(Strand& s, double delta){
-  for(int i=0; i<length; i++) gene[i] = s.gene[i] + 2.0*delta*(UniRand()-0.5);
+ void Init(Philox& r, Strand& s, double delta){
+  for(int i=0; i<length; i++) gene[i] = s.gene[i] + 2.0*delta*(r.Uniform()-0.5);
  }
- void Init(double v[], double delta){
-  for(int i=0; i<length; i++) gene[i] = v[i] + 2.0*delta*(UniRand()-0.5);
+ void Init(Philox& r, double v[], double delta){
+  for(int i=0; i<length; i++) gene[i] = v[i] + 2.0*delta*(r.Uniform()-0.5);
  }
- void Init(double v0[], double vdel[]){
+ void Init(Philox& r, double v0[], double vdel[]){
   for(int i=0; i<length; i++)
-   gene[i] = v0[i] + 2.0*vdel[i]*(UniRand()-0.5);
+   gene[i] = v0[i] + 2.0*vdel[i]*(r.Uniform()-0.5);
  }
- Strand& operator=(Strand& s){
+ Strand& operator=(const Strand& s){
   cost = s.cost;
   for(int i=0; i<length; i++) gene[i] = s.gene[i];
   return *this;
@@ -118,68 +341,236 @@ public:
  friend class Opti;
  friend class Mini;
  friend class Maxi;
+ friend class AdaptiveOpti;
+ friend class CmaesOpti;
 };    
 
 
+// The genes of all strands are stored in a single population x length matrix
+// (row i = strand[i].gene) whose start is aligned to a cache line.
+
 class GenePool{
 public:
  Strand *strand;
 protected:
  int population, length;
+ uint64_t seed;     // Random number seed. See Philox.
+ double *block;     // Allocated storage.
+ double *genes;     // Aligned start of the gene matrix.
+ void Allocate(){
+  if (block) delete [] block;
+  block = genes = 0;
+  if (population*length == 0) return;
+  block = new double[population*length + 8];
+  genes = block;
+  while ((size_t)genes % 64 != 0) genes++;
+  for(int i=0; i<population; i++) strand[i].View(genes + i*length, length);
+ }
+private:
+ GenePool(const GenePool&);              // Not copyable.
+ GenePool& operator=(const GenePool&);
 public:
- GenePool() : strand(0), population(0), length(0) {}
- GenePool(int pop) : population(pop), length(0){
+ GenePool() : strand(0), population(0), length(0), seed(0), block(0), genes(0) {}
+ GenePool(int pop) : population(pop), length(0), seed(0), block(0), genes(0){
   strand = new Strand[population];
  }
- GenePool(int pop, int len) : population(pop){
+ GenePool(int pop, int len) : population(pop), length(len), seed(0), block(0), genes(0){
   strand = new Strand[population];
-  Length(len);
+  Allocate();
+ }
+ virtual ~GenePool() {
+  if (strand) delete [] strand;
+  if (block) delete [] block;
  }
- virtual ~GenePool() {if (strand) delete [] strand;}
  int Length() {return length;}
  void Length(int len){
   length = len;
-  if(strand)
-   for(int i=0; i<population; i++) strand[i].Length(length);
+  if(strand) Allocate();
  }
  int Population() {return population;}
  void Population(int pop){
   if (strand) delete [] strand;
   population = pop;
   strand = new Strand[population];
+  Allocate();
  }
+ double* Genes() {return genes;}
+ uint64_t Seed() {return seed;}
+ void Seed(uint64_t s) {seed = s;}
+ // Stream for strand i in generation gen. Generation 0 is used for initialization.
+ uint64_t Stream(uint64_t gen, int i) {return (gen << 32) | uint32_t(i);}
  void Init(double delta){
   if(strand && length>0)
-   for(int i=0; i<population; i++) strand[i].Init(delta);
+   for(int i=0; i<population; i++) {Philox r(seed, Stream(0, i)); strand[i].Init(r, delta);}
  }
  void Init(double delta, double offset){
   if(strand && length>0)
-   for(int i=0; i<population; i++) strand[i].Init(delta, offset);
+   for(int i=0; i<population; i++) {Philox r(seed, Stream(0, i)); strand[i].Init(r, delta, offset);}
  }
  void Init(Strand& s, double delta){
   if(strand && length>0)
-   for(int i=0; i<population; i++) strand[i].Init(s, delta);
+   for(int i=0; i<population; i++) {Philox r(seed, Stream(0, i)); strand[i].Init(r, s, delta);}
  }
  void Init(double v[], double delta){
   if(strand && length>0)
-   for(int i=0; i<population; i++) strand[i].Init(v, delta);
+   for(int i=0; i<population; i++) {Philox r(seed, Stream(0, i)); strand[i].Init(r, v, delta);}
  }
  void Init(double v0[], double vdel[]){
-  strand[0].Init(v0, 0.0);
+  Philox r0(seed, Stream(0, 0));
+  strand[0].Init(r0, v0, 0.0);
   if(strand && length>0){
-   for(int i=1; i<population; i++) strand[i].Init(v0, vdel);
+   for(int i=1; i<population; i++) {Philox r(seed, Stream(0, i)); strand[i].Init(r, v0, vdel);}
   }
  }
 };
 
 
+// Cache of merit function values.
+//
+// Late in a run many trial strands are the same, or nearly the same, since crossover
+// keeps whole parent genes. The cache keys on the genes quantized with tolerance
+// tol (tol = 0 => exact match) and holds at most max_entries values with the least
+// recently used entry dropped first. The cache can be saved to and loaded from a file
+// so a restarted run can reuse earlier evaluations. The end_flag returned by the
+// merit function is stored with the cost so a hit terminates the run as the original
+// evaluation did.
+// The cache is only valid as long as the merit function does not change.
+// Lookup and Insert are thread safe.
+
+class MeritCache{
+ typedef vector<int64_t> Key;
+ struct Entry {Key key; double cost; int end_flag;};
+ mutex lock;
+ int length;
+ double tol;
+ size_t max_entries;
+ list<Entry> lru;                               // Most recently used first.
+ map<Key, list<Entry>::iterator> index;
+ Key key;                                       // Scratch.
+ long hits, misses;
+ void Quantize(const double* gene){
+  key.resize(length);
+  for(int i=0; i<length; i++){
+   if (tol > 0) key[i] = (int64_t)floor(gene[i] / tol + 0.5);
+   else memcpy(&key[i], &gene[i], sizeof(double));
+  }
+ }
+ void Add(const Key& k, double cost, int end_flag){
+  Entry e;
+  e.key = k;
+  e.cost = cost;
+  e.end_flag = end_flag;
+  lru.push_front(e);
+  index[k] = lru.begin();
+  if (lru.size() > max_entries) {
+   index.erase(lru.back().key);
+   lru.pop_back();
+  }
+ }
+public:
+ MeritCache(int len, double tolerance = 0, size_t max_n = 100000)
+   : length(len), tol(tolerance), max_entries(max_n > 0 ? max_n : 1), hits(0), misses(0) {}
+ int Length() {return length;}
+ long Hits() {return hits;}
+ long Misses() {return misses;}
+ size_t Size() {return lru.size();}
+ void Clear() {lru.clear(); index.clear(); hits = misses = 0;}
+ bool Lookup(const double* gene, double& cost, int& end_flag);
+ void Insert(const double* gene, double cost, int end_flag);
+ bool Save(const char* file);
+ bool Load(const char* file);
+};
+
+
+// Pool of worker processes for merit evaluation.
+//
+// For merit functions that are not thread safe (for example, ones that call Bmad
+// Fortran code using global or saved variables).
+// Forking a process that has other threads running is unsafe (a lock held by another
+// thread stays locked in the child) so the caller is forked only once, when the pool is
+// made, to start a single threaded "fork server". The pool must therefore be made
+// before the caller starts any threads of its own. The fork server forks the workers,
+// including any restarted ones, so each has a copy of the caller's state (lattice,
+// etc.) at the time the pool was made. An optional init function is called in each
+// worker after it is forked.
+// Trial genes and costs are exchanged through shared memory. Each worker has a
+// Unix socket, passed from the fork server to the caller, on which it gets the slot
+// to evaluate and replies when done. A worker that dies or takes longer than timeout
+// seconds is killed and restarted and its trial is retried (at most max_retry times,
+// after which the trial gets a cost of HUGE_VAL).
+// Not available on Windows.
+
+typedef void (*WorkerInitFunc) (int&);
+
+class ProcessPool{
+ int n_workers, length;
+ EvalFunc f;
+ WorkerInitFunc init;
+ double* shm;               // Per worker: length genes, cost, end_flag.
+ size_t shm_size;
+ vector<int> pid, sock;
+ int server_pid, server_sock;
+ bool Spawn(int w);
+ void Serve();
+ void Work(int w);
+ ProcessPool(const ProcessPool&);              // Not copyable.
+ ProcessPool& operator=(const ProcessPool&);
+public:
+ int max_retry;
+ double timeout;            // Seconds for one evaluation. 0 => No limit.
+ long n_restart;            // Number of workers restarted.
+ ProcessPool(int n_proc, int len, EvalFunc func, WorkerInitFunc init_func = 0, double time_limit = 0);
+ ~ProcessPool();
+ int Workers() {return n_workers;}
+ int Length() {return length;}
+ void Evaluate(const double* genes, int n, double* costs, int& end_flag, int* flags = 0);
+};
+
+
 class Opti : public GenePool{
 protected:
  int generations;
  Strand trial;
  EvalFunc f;
+ BatchEvalFunc fb;
+ bool synchronous;     // Evaluate a whole generation at once?
+ int n_threads;        // For synchronous mode without fb. 0 => OpenMP default.
+ GenePool trials;      // Trial strands for synchronous mode.
+ vector<double> batch_cost;          // Cost buffer for fb.
+ vector<double> batch_genes;         // Genes not in the cache for fb.
+ vector<int> batch_miss;             // Strand indexes of batch_genes.
+ vector<int> batch_flag;             // end_flag of each of batch_genes.
+ vector<unsigned char> cross;        // Crossover mask.
+ double flex_cr;
+ GenePool flight;                    // In flight trials for asynchronous mode.
+ vector<int> flight_target;          // Target strand of each in flight trial. -1 => free slot.
+ vector<char> flight_init;           // In flight trial is an initial strand?
+ vector<char> known;                 // Strand cost known?
+ vector<char> targeted;              // Strand has a trial in flight?
+ long n_asked, n_told;               // n_told does not count initial strands.
+ int n_in_flight, n_known, next_target;
+ bool async_done;
+ bool async;                         // In OptimizeAsync? Checkpoints are then marked synchronous.
+ mutex async_mutex;                  // Guards Ask and Tell in OptimizeAsync.
+ condition_variable async_cond;      // Signaled by Tell in OptimizeAsync.
+ MeritCache* cache;                  // Owned. 0 => No cache.
+ ProcessPool* procs;                 // Not owned.
+ double Eval(double* gene, int& end_flag);
+ void EvalBatch(const double* genes, int n, double* costs, int& end_flag, int* flags = 0);
+ int start_gen;                      // First generation. > 1 after Resume.
+ string ckpt_file;                   // Checkpoint file. "" => No checkpointing.
+ int ckpt_every;                     // Generations between checkpoints.
+ vector<char> ckpt_buf;              // Snapshot being written.
+ thread ckpt_thread;                 // Checkpoint writer.
+ void Checkpoint(int gen, bool force = false);
+ virtual void Snapshot(vector<char>& buf, int gen);
  virtual int Better(int) = 0;
  virtual int Better(int, int) = 0;
+ virtual int BetterCost(double, double) = 0;
+ void Evaluate(GenePool& pool, int& end_flag);
+ void Setup();
+ void MakeTrial(int i, uint64_t gen, double* t);
+ Strand& OptimizeSync();
  virtual int Best(){
      int index, theMin;
      for(index=1,theMin=0; index<population; index++)
@@ -188,10 +579,34 @@ protected:
  }
 public:
  Opti(int gen, int pop, int len, EvalFunc func)
-   : GenePool(pop, len), generations(gen), trial(len) { f = func; }
+   : GenePool(pop, len), generations(gen), trial(len), fb(0),
+     synchronous(false), n_threads(0), flex_cr(0), n_asked(0), n_told(0), n_in_flight(0),
+     n_known(0), next_target(0), async_done(false), async(false), cache(0), procs(0), start_gen(1), ckpt_every(0) { f = func; }
+ virtual ~Opti() {
+  if (ckpt_thread.joinable()) ckpt_thread.join();
+  delete cache;
+ }
+ void SetCache(double tol, size_t max_entries){
+  delete cache;
+  cache = new MeritCache(length, tol, max_entries);
+ }
+ MeritCache* Cache() {return cache;}
+ void SetProcessPool(ProcessPool* p) {procs = p;}
+ void SetCheckpoint(const char* file, int every) {ckpt_file = file; ckpt_every = every;}
+ bool Resume(const char* file);
  void Setf(EvalFunc func) {f = func;}
+ void SetBatch(BatchEvalFunc func) {fb = func; synchronous = true;}
+ void Synchronous(bool sync, int threads = 0) {synchronous = sync; n_threads = threads;}
+ bool IsSynchronous() {return synchronous;}
  virtual Strand& Optimize();
  virtual Strand& Optimize(int numgen){generations = numgen; return Optimize();}
+ Strand& BestStrand() {return strand[Best()];}
+ // Asynchronous steady state mode.
+ void AsyncStart(int max_in_flight);
+ int Ask(double* genes);
+ void Tell(int ticket, double cost, int end_flag = 0);
+ int InFlight() {return n_in_flight;}
+ Strand& OptimizeAsync(int n_thr, int max_in_flight);
 };
 
 
@@ -205,6 +620,9 @@ public:
  virtual int Better(int ind1, int ind2){
    	return strand[ind1].cost < strand[ind2].cost;
  }
+ virtual int BetterCost(double cost1, double cost2){
+   	return cost1 < cost2;
+ }
 };
 
 
@@ -218,6 +636,104 @@ public:
  virtual int Better(int ind1, int ind2){
    	return strand[ind1].cost > strand[ind2].cost;
  }
+ virtual int BetterCost(double cost1, double cost2){
+   	return cost1 > cost2;
+ }
+};
+
+// Success-history based adaptive differential evolution (SHADE).
+// Tanabe and Fukunaga, "Success-History Based Parameter Adaptation for
+// Differential Evolution", IEEE CEC 2013.
+//
+// Each trial strand gets its own crossover rate CR and scale factor F, sampled
+// around values held in a history memory. Values that produce improvements
+// are used to update the memory. Mutation is current-to-pbest/1:
+//   v = x_i + F * (x_pbest - x_i) + F * (x_r1 - x_r2)
+// where x_pbest is picked from the best p fraction of the population and x_r2
+// may come from an archive of recently replaced parents.
+// Minimizes. Generations are synchronous so trials are evaluated with Evaluate
+// (batch function or thread pool) like Opti in synchronous mode.
+
+class AdaptiveOpti : public Opti{
+protected:
+ int h_size;                // History memory size.
+ int k_mem;                 // Next memory slot to update.
+ vector<double> m_cr, m_f;  // History memory.
+ vector<double> cr, sf;     // CR and F for each trial.
+ vector<double> archive;    // Archived parents. n_archive x length.
+ int n_archive;
+ vector<int> order;         // Strand indices sorted by cost.
+ virtual int Better(int index){
+   	return trial.cost < strand[index].cost;
+ }
+ virtual int Better(int ind1, int ind2){
+   	return strand[ind1].cost < strand[ind2].cost;
+ }
+ virtual int BetterCost(double cost1, double cost2){
+   	return cost1 < cost2;
+ }
+ void MakeAdaptiveTrial(int i, uint64_t gen, double* t);
+ void UpdateMemory(uint64_t gen);
+ virtual void Snapshot(vector<char>& buf, int gen);
+public:
+ AdaptiveOpti(int gen, int pop, int len, EvalFunc func, int h = 0)
+   : Opti(gen, pop, len, func), h_size(h > 0 ? h : pop), k_mem(0), n_archive(0) {}
+ bool Resume(const char* file);
+ virtual Strand& Optimize();
+};
+
+// Covariance matrix adaptation evolution strategy (CMA-ES) with optional
+// IPOP restarts (the population is doubled on each restart).
+// Hansen, "The CMA Evolution Strategy: A Tutorial", arXiv:1604.00772.
+// Auger and Hansen, "A Restart CMA Evolution Strategy With Increasing Population Size", CEC 2005.
+//
+// Minimizes. The population (lambda) sampled each generation is held in the
+// GenePool and evaluated with Evaluate so the batch function, thread pool and
+// merit cache of Opti all work. The total number of merit evaluations is limited
+// to generations * (initial lambda).
+
+class CmaesOpti : public Opti{
+protected:
+ int n_restart;             // Maximum number of IPOP restarts.
+ Strand best;               // Best strand found.
+ vector<double> x0, sig0;   // Initial mean and coordinate sigmas.
+ // Run state. Saved in checkpoints.
+ int lambda0, lambda;       // Initial and current population.
+ int restart;               // Current restart.
+ int g;                     // Generation in the current run.
+ long n_eval;               // Merit evaluations so far.
+ uint64_t gen;              // Generations so far over all restarts. Used for the random streams.
+ double sigma;
+ vector<double> xmean, ps, pc;
+ vector<double> C, B, D;    // Covariance = B diag(D^2) B^T. Matrices are row major n x n.
+ vector<double> history;    // Best cost of recent generations.
+ bool resumed;              // State set by Resume?
+ // Scratch.
+ vector<double> xold, ywt;
+ vector<double> Y;          // Sampled steps. lambda x n.
+ vector<double> Yw;         // Columns for the covariance update (column major n x (mu+1)).
+ vector<double> weights;
+ vector<int> order;
+ virtual int Better(int index){
+   	return trial.cost < strand[index].cost;
+ }
+ virtual int Better(int ind1, int ind2){
+   	return strand[ind1].cost < strand[ind2].cost;
+ }
+ virtual int BetterCost(double cost1, double cost2){
+   	return cost1 < cost2;
+ }
+ void Eigen();
+ bool Run(long max_eval, int& end_flag);
+ virtual void Snapshot(vector<char>& buf, int gen);
+public:
+ CmaesOpti(int gen, int pop, int len, EvalFunc func, int restarts = 0)
+   : Opti(gen, pop, len, func), n_restart(restarts), best(len), lambda0(0), lambda(0),
+     restart(0), g(0), n_eval(0), gen(0), sigma(1), resumed(false) {best.cost = HUGE_VAL;}
+ using GenePool::Init;
+ void Init(double v0[], double vdel[]);
+ bool Resume(const char* file);
+ virtual Strand& Optimize();
 };
 
 double MiniVec(double solution[], const int& gen, const int& pop, 
@@ -226,6 +742,17 @@ double MiniVec(double solution[], const int& gen, const int& pop,
 double MiniOff(double solution[], const int& gen, const int& pop,
 	const int& len, EvalFunc func, const double& offset,
 	const double& delta);
+extern "C" double opti_shade_(double solution[], const int& gen, const int& pop,
+	const int& len, EvalFunc func, double v0[], double vdel[], const int& n_threads);
+extern "C" double opti_shade_resume_(double solution[], const int& gen, const int& pop,
+	const int& len, EvalFunc func, const char* file, const int& n_threads);
+extern "C" double opti_async_(double solution[], const int& gen, const int& pop,
+	const int& len, EvalFunc func, double v0[], double vdel[], const int& n_threads);
+extern "C" double opti_cmaes_(double solution[], const int& gen, const int& pop,
+	const int& len, EvalFunc func, double v0[], double vdel[], const int& n_threads,
+	const int& n_restart);
+extern "C" double opti_cmaes_resume_(double solution[], const int& gen, const int& len,
+	EvalFunc func, const char* file, const int& n_threads, const int& n_restart);
 extern "C" double minidel(double solution[], const int& gen, const int& pop,
 	const int& len, EvalFunc func, double v0[], double vdel[]);
 double MaxiVec(double solution[], const int& gen, const int& pop, 
@@ -246,102 +773,1711 @@ extern "C" void ERR_EXIT();
 extern "C" void err_exit_();
 #endif
 
-Strand& Opti::Optimize(){
- int a, b, c, j, end_flag;
- const double CR = 0.8, frac = 1.4;
- double rfrac, flex_cr;
+// Seed used by the C entry points. Set with opti_set_seed_.
 
- flex_cr = CR * 10.0/length;
- if ( 0.1 > flex_cr ) flex_cr = 0.1;
- if ( CR < flex_cr ) flex_cr = CR;
+static uint64_t opti_seed = 0;
+
+extern "C" void opti_set_seed_(const int& seed){
+ opti_seed = uint64_t(uint32_t(seed));
+}
 
- for(int i=0; i<population; i++) strand[i].cost = f(strand[i].gene, end_flag);
+// Merit cache settings used by the C entry points. Set with opti_cache_setup_.
+// Each run makes its own cache (owned by the optimizer) with these settings.
 
- int numgen = generations;
- while(numgen--){
-  for(int i=0; i<population; i++){
-   do {a = RandInt(population);} while(a==i);
-   do {b = RandInt(population);} while(b==i || b==a);
-   do {c = RandInt(population);} while(c==i || c==b || c==a);
-   j = RandInt(length);
-   rfrac = frac * UniRand();
-   for(int k=1; k<=length; k++){
-     if(UniRand() < flex_cr || k == length){
-      trial.gene[j] = strand[a].gene[j] +
-	rfrac * (strand[b].gene[j] - strand[c].gene[j]);
-     }
-     else trial.gene[j] = strand[a].gene[j];
-     j = (j+1)%length;
+static double opti_cache_tol = 0;
+static int opti_cache_max = 0;
+static string opti_cache_file;
+static long opti_cache_hits = 0, opti_cache_misses = 0, opti_cache_size = 0;   // Last run.
+
+extern "C" void opti_cache_setup_(const int& enable, const double& tol, const int& max_entries,
+	const char* file){
+ opti_cache_tol = tol;
+ opti_cache_max = (enable == 0) ? 0 : max(1, max_entries);
+ opti_cache_file = file ? file : "";
+ opti_cache_hits = opti_cache_misses = opti_cache_size = 0;
+}
+
+extern "C" void opti_cache_stats_(long& hits, long& misses, long& n_entries){
+ hits = opti_cache_hits;
+ misses = opti_cache_misses;
+ n_entries = opti_cache_size;
+}
+
+static void OptiCacheAttach(Opti& opt){
+ if (opti_cache_max == 0) return;
+ opt.SetCache(opti_cache_tol, opti_cache_max);
+ if (opti_cache_file != "") opt.Cache()->Load(opti_cache_file.c_str());
+}
+
+static void OptiCacheSave(Opti& opt){
+ MeritCache* cache = opt.Cache();
+ if (!cache) return;
+ opti_cache_hits = cache->Hits();
+ opti_cache_misses = cache->Misses();
+ opti_cache_size = long(cache->Size());
+ if (opti_cache_file == "") return;
+ if (!cache->Save(opti_cache_file.c_str()))
+  cout << "ERROR IN OPTI: CANNOT WRITE MERIT CACHE FILE: " << opti_cache_file << endl;
+}
+
+
+// Checkpointing used by the C entry points. Set up with opti_checkpoint_setup_.
+
+static string opti_ckpt_file;
+static int opti_ckpt_every = 0;
+
+extern "C" void opti_checkpoint_setup_(const char* file, const int& every){
+ opti_ckpt_file = file ? file : "";
+ opti_ckpt_every = every;
+}
+
+// Process pool used by the C entry points. Set up with opti_procs_setup_.
+// The pool is made at the start of each run so the workers get the current state of the caller.
+
+static int opti_n_procs = 0;
+static WorkerInitFunc opti_procs_init = 0;
+static double opti_procs_time_limit = 0;
+
+extern "C" void opti_procs_setup_(const int& n_procs, WorkerInitFunc init){
+ opti_n_procs = n_procs;
+ opti_procs_init = init;
+}
+
+extern "C" void opti_procs_timeout_(const double& timeout){
+ opti_procs_time_limit = max(0.0, timeout);
+}
+
+static ProcessPool* OptiProcsAttach(Opti& opt, int len, EvalFunc func){
+ if (opti_n_procs < 1) return 0;
+ ProcessPool* pp = new ProcessPool(opti_n_procs, len, func, opti_procs_init, opti_procs_time_limit);
+ opt.SetProcessPool(pp);
+ return pp;
+}
+
+static void OptiErrExit(){
+#if defined(CESR_WINCVF)
+ ERR_EXIT(); 
+#else
+ err_exit_();
+#endif
+}
+
+//--------------------------------------------------------------------
+// MeritCache methods
+
+bool MeritCache::Lookup(const double* gene, double& cost, int& end_flag){
+ lock_guard<mutex> guard(lock);
+ Quantize(gene);
+ map<Key, list<Entry>::iterator>::iterator it = index.find(key);
+ if (it == index.end()) {
+  misses++;
+  return false;
+ }
+ lru.splice(lru.begin(), lru, it->second);
+ cost = it->second->cost;
+ end_flag = it->second->end_flag;
+ hits++;
+ return true;
+}
+
+
+void MeritCache::Insert(const double* gene, double cost, int end_flag){
+ lock_guard<mutex> guard(lock);
+ Quantize(gene);
+ map<Key, list<Entry>::iterator>::iterator it = index.find(key);
+ if (it != index.end()) {
+  it->second->cost = cost;
+  it->second->end_flag = end_flag;
+  lru.splice(lru.begin(), lru, it->second);
+ } else {
+  Add(key, cost, end_flag);
+ }
+}
+
+
+// File format: "OPTICACH", int32 length, double tol, int64 n_entries, then for each
+// entry (least recently used first): length int64 keys, a double cost and an int32 end_flag.
+
+bool MeritCache::Save(const char* file){
+ string tmp = string(file) + ".tmp";
+ FILE* fp = fopen(tmp.c_str(), "wb");
+ if (!fp) return false;
+
+ int32_t len = length;
+ int64_t n = lru.size();
+ bool ok = fwrite("OPTICACH", 1, 8, fp) == 8 && fwrite(&len, sizeof(len), 1, fp) == 1 &&
+           fwrite(&tol, sizeof(tol), 1, fp) == 1 && fwrite(&n, sizeof(n), 1, fp) == 1;
+ for(list<Entry>::reverse_iterator it = lru.rbegin(); ok && it != lru.rend(); ++it){
+  int32_t flag = it->end_flag;
+  ok = fwrite(&it->key[0], sizeof(int64_t), length, fp) == size_t(length) &&
+       fwrite(&it->cost, sizeof(double), 1, fp) == 1 && fwrite(&flag, sizeof(flag), 1, fp) == 1;
+ }
+ if (fclose(fp) != 0) ok = false;
+ if (ok) ok = (rename(tmp.c_str(), file) == 0);
+ if (!ok) remove(tmp.c_str());
+ return ok;
+}
+
+
+// Returns false if the file does not exist or was made with a different length or tolerance.
+
+bool MeritCache::Load(const char* file){
+ FILE* fp = fopen(file, "rb");
+ if (!fp) return false;
+
+ char magic[8];
+ int32_t len;
+ double t;
+ int64_t n;
+ bool ok = fread(magic, 1, 8, fp) == 8 && memcmp(magic, "OPTICACH", 8) == 0 &&
+           fread(&len, sizeof(len), 1, fp) == 1 && fread(&t, sizeof(t), 1, fp) == 1 &&
+           fread(&n, sizeof(n), 1, fp) == 1 && len == length && t == tol;
+
+ Key k(length);
+ for(int64_t i=0; ok && i<n; i++){
+  double cost;
+  int32_t flag;
+  ok = fread(&k[0], sizeof(int64_t), length, fp) == size_t(length) &&
+       fread(&cost, sizeof(double), 1, fp) == 1 && fread(&flag, sizeof(flag), 1, fp) == 1;
+  if (!ok) break;
+  map<Key, list<Entry>::iterator>::iterator it = index.find(k);
+  if (it != index.end()) {
+   it->second->cost = cost;
+   it->second->end_flag = flag;
+   lru.splice(lru.begin(), lru, it->second);
+  } else {
+   Add(k, cost, flag);
+  }
+ }
+
+ fclose(fp);
+ return ok;
+}
+
+
+//--------------------------------------------------------------------
+// Merit evaluation through the cache, if there is one.
+
+double Opti::Eval(double* gene, int& end_flag){
+ if (!cache) return f(gene, end_flag);
+
+ double cost;
+ if (cache->Lookup(gene, cost, end_flag)) return cost;
+
+ cost = f(gene, end_flag);
+ cache->Insert(gene, cost, end_flag);
+ return cost;
+}
+
+
+//--------------------------------------------------------------------
+// ProcessPool methods
+
+// Seconds from a monotonic clock.
+
+static double OptiTime(){
+ return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if !defined(_WIN32)
+
+ProcessPool::ProcessPool(int n_proc, int len, EvalFunc func, WorkerInitFunc init_func, double time_limit)
+  : n_workers(n_proc > 0 ? n_proc : 1), length(len), f(func), init(init_func), shm(0),
+    server_pid(-1), server_sock(-1), max_retry(2), timeout(time_limit), n_restart(0) {
+
+ shm_size = size_t(n_workers) * (length + 2) * sizeof(double);
+ void* p = mmap(0, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+ if (p == MAP_FAILED) {
+  cout << "ERROR IN PROCESSPOOL: CANNOT MAP SHARED MEMORY." << endl;
+  n_workers = 0;
+  return;
+ }
+ shm = (double*)p;
+ pid.assign(n_workers, -1);
+ sock.assign(n_workers, -1);
+
+ // Start the fork server.
+
+ int sv[2];
+ if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+  cout << "ERROR IN PROCESSPOOL: CANNOT CREATE SOCKET." << endl;
+  n_workers = 0;
+  return;
+ }
+
+ cout.flush();
+ fflush(0);
+ int ps = fork();
+ if (ps < 0) {
+  cout << "ERROR IN PROCESSPOOL: CANNOT FORK." << endl;
+  close(sv[0]);
+  close(sv[1]);
+  n_workers = 0;
+  return;
+ }
+
+ if (ps == 0) {                  // Fork server
+  close(sv[0]);
+  server_sock = sv[1];
+  Serve();
+  _exit(0);
+ }
+
+ close(sv[1]);
+ server_sock = sv[0];
+ server_pid = ps;
+ for(int w=0; w<n_workers; w++) Spawn(w);
+}
+
+
+ProcessPool::~ProcessPool(){
+ for(int w=0; w<n_workers; w++){
+  if (sock[w] >= 0) {
+   int job = -1;
+   send(sock[w], &job, sizeof(job), MSG_NOSIGNAL);
+   close(sock[w]);
+  }
+ }
+ if (server_sock >= 0) close(server_sock);     // The fork server waits for the workers and exits.
+ if (server_pid > 0) waitpid(server_pid, 0, 0);
+ if (shm) munmap(shm, shm_size);
+}
+
+
+// Fork server loop. Gets a worker index from the caller, forks the worker and sends
+// back the pid and the caller's end of the worker socket. Exits when the caller
+// closes server_sock. Never returns.
+
+void ProcessPool::Serve(){
+ while (true) {
+  int w;
+  if (recv(server_sock, &w, sizeof(w), MSG_WAITALL) != sizeof(w)) break;
+  while (waitpid(-1, 0, WNOHANG) > 0) {}       // Reap dead workers.
+
+  int sv[2], p = -1;
+  bool ok = (w >= 0 && w < n_workers && socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+  if (ok) {
+   p = fork();
+   if (p == 0) {                 // Worker
+    close(sv[0]);
+    close(server_sock);
+    sock[w] = sv[1];
+    Work(w);
+    _exit(0);
    }
-   end_flag = 0;
-   trial.cost = f(trial.gene, end_flag);
-   if (Better(i)) strand[i] = trial;
-   if (end_flag == 1) return strand[Best()];
+   close(sv[1]);
+   if (p < 0) {close(sv[0]); ok = false;}
+  }
+
+  // Reply: pid (-1 on failure) with the socket attached.
+
+  struct iovec iov = {&p, sizeof(p)};
+  char ctrl[CMSG_SPACE(sizeof(int))];
+  memset(ctrl, 0, sizeof(ctrl));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  if (ok) {
+   msg.msg_control = ctrl;
+   msg.msg_controllen = sizeof(ctrl);
+   struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+   cm->cmsg_level = SOL_SOCKET;
+   cm->cmsg_type = SCM_RIGHTS;
+   cm->cmsg_len = CMSG_LEN(sizeof(int));
+   memcpy(CMSG_DATA(cm), &sv[0], sizeof(int));
   }
+  bool sent = sendmsg(server_sock, &msg, MSG_NOSIGNAL) == sizeof(p);
+  if (ok) close(sv[0]);
+  if (!sent) break;
  }
- return strand[Best()];
+
+ while (wait(0) > 0) {}
+ _exit(0);
 }
 
 
+// (Re)start worker w through the fork server.
 
-double MiniOff(double solution[], const int& gen, const int& pop,
-	const int& len, EvalFunc func, const double& offset,
-	const double& delta){
+bool ProcessPool::Spawn(int w){
+ if (sock[w] >= 0) close(sock[w]);
+ if (pid[w] > 0) kill(pid[w], SIGKILL);
+ sock[w] = -1;
+ pid[w] = -1;
+ if (server_sock < 0) return false;
 
- Mini xxx(gen, pop, len, func);
- xxx.Init(offset, delta);
- Strand sol = xxx.Optimize();
- for(int index=0; index<len; index++) solution[index] = sol(index);
- return sol.Cost();
+ int p = -1, fd = -1;
+ char ctrl[CMSG_SPACE(sizeof(int))];
+ struct iovec iov = {&p, sizeof(p)};
+ struct msghdr msg;
+ memset(&msg, 0, sizeof(msg));
+ msg.msg_iov = &iov;
+ msg.msg_iovlen = 1;
+ msg.msg_control = ctrl;
+ msg.msg_controllen = sizeof(ctrl);
+
+ if (send(server_sock, &w, sizeof(w), MSG_NOSIGNAL) != sizeof(w) ||
+     recvmsg(server_sock, &msg, MSG_WAITALL) != sizeof(p)) {
+  cout << "ERROR IN PROCESSPOOL: FORK SERVER NOT RESPONDING." << endl;
+  close(server_sock);
+  server_sock = -1;
+  return false;
+ }
+
+ struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+ if (cm && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) memcpy(&fd, CMSG_DATA(cm), sizeof(int));
+ if (p < 0 || fd < 0) {
+  if (fd >= 0) close(fd);
+  cout << "ERROR IN PROCESSPOOL: CANNOT FORK." << endl;
+  return false;
+ }
+
+ sock[w] = fd;
+ pid[w] = p;
+ return true;
 }
 
 
-double MiniVec(double solution[], const int& gen, const int& pop, 
-	const int& len, EvalFunc func, double v0[], 
-	const double& delta){
+// Worker loop. Never returns.
 
- Mini xxx(gen, pop, len, func);
- xxx.Init(v0, delta);
- Strand sol = xxx.Optimize();
- for(int index=0; index<len; index++) solution[index] = sol(index);
- return sol.Cost();
+void ProcessPool::Work(int w){
+ if (init) init(w);
+ double* slot = shm + size_t(w) * (length + 2);
+ while (true) {
+  int job;
+  if (recv(sock[w], &job, sizeof(job), MSG_WAITALL) != sizeof(job) || job < 0) _exit(0);
+  int end_flag = 0;
+  slot[length] = f(slot, end_flag);
+  slot[length+1] = end_flag;
+  char c = 1;
+  if (send(sock[w], &c, 1, MSG_NOSIGNAL) != 1) _exit(0);
+ }
 }
 
-#if defined(CESR_WINCVF)
-extern "C" double OPTI(double solution[], const int& gen, const int& pop, 
-	const int& len, EvalFunc func, double v0[], 
-	double vdel[]){
-#else
-extern "C" double opti_(double solution[], const int& gen, const int& pop, 
-	const int& len, EvalFunc func, double v0[], 
-	double vdel[]){
 
-#endif
+// If flags is not null, it is set to the end_flag of each trial.
 
- if (pop < 4) {
-   cout << "ERROR IN OPTI: POPULATION MUST BE AT LEAST 4!\n";
+void ProcessPool::Evaluate(const double* genes, int n, double* costs, int& end_flag, int* flags){
+ end_flag = 0;
+ if (flags) for(int i=0; i<n; i++) flags[i] = 0;
+ if (n_workers == 0) {
+  for(int i=0; i<n; i++) costs[i] = HUGE_VAL;
+  return;
+ }
+
+ vector<int> busy(n_workers, -1);      // Trial being evaluated by each worker.
+ vector<double> t_start(n_workers);     // Time the trial was handed out.
+ vector<int> tries(n, 0);
+ vector<int> todo;                      // Trials still to hand out. Taken from the back.
+ for(int i=n-1; i>=0; i--) todo.push_back(i);
+ int n_busy = 0;
+ vector<pollfd> fds(n_workers);
+
+ while (todo.size() > 0 || n_busy > 0) {
+
+  // Hand out trials to idle workers.
+
+  for(int w=0; w<n_workers && todo.size() > 0; w++){
+   if (busy[w] >= 0) continue;
+   int i = todo.back();
+   double* slot = shm + size_t(w) * (length + 2);
+   memcpy(slot, genes + size_t(i) * length, length * sizeof(double));
+   int job = i;
+   if (sock[w] < 0 || send(sock[w], &job, sizeof(job), MSG_NOSIGNAL) != sizeof(job)) {
+    n_restart++;
+    if (!Spawn(w)) continue;
+    if (send(sock[w], &job, sizeof(job), MSG_NOSIGNAL) != sizeof(job)) continue;
+   }
+   todo.pop_back();
+   busy[w] = i;
+   t_start[w] = OptiTime();
+   n_busy++;
+  }
+
+  if (n_busy == 0) {
+   cout << "ERROR IN PROCESSPOOL: NO WORKERS AVAILABLE." << endl;
+   for(size_t k=0; k<todo.size(); k++) costs[todo[k]] = HUGE_VAL;
+   return;
+  }
+
+  // Wait for replies or for the first busy worker to time out.
+
+  int wait_ms = -1;
+  double now = OptiTime();
+  for(int w=0; w<n_workers; w++){
+   fds[w].fd = (busy[w] >= 0) ? sock[w] : -1;
+   fds[w].events = POLLIN;
+   fds[w].revents = 0;
+   if (busy[w] >= 0 && timeout > 0) {
+    int ms = max(0, int(ceil(1000 * (t_start[w] + timeout - now))));
+    if (wait_ms < 0 || ms < wait_ms) wait_ms = ms;
+   }
+  }
+  if (poll(&fds[0], n_workers, wait_ms) < 0) continue;
+  now = OptiTime();
+
+  for(int w=0; w<n_workers; w++){
+   if (busy[w] < 0) continue;
+   bool timed_out = (fds[w].revents == 0 && timeout > 0 && now - t_start[w] >= timeout);
+   if (fds[w].revents == 0 && !timed_out) continue;
+   int i = busy[w];
+   busy[w] = -1;
+   n_busy--;
+
+   char c;
+   if (!timed_out && recv(sock[w], &c, 1, 0) == 1) {
+    double* slot = shm + size_t(w) * (length + 2);
+    costs[i] = slot[length];
+    if (slot[length+1] == 1) end_flag = 1;
+    if (flags) flags[i] = int(slot[length+1]);
+    continue;
+   }
+
+   // Worker died or timed out. Restart it and retry the trial.
+
+   if (timed_out) cout << "WARNING IN PROCESSPOOL: MERIT EVALUATION TIMED OUT. RESTARTING WORKER." << endl;
+   n_restart++;
+   Spawn(w);
+   if (++tries[i] <= max_retry) {
+    todo.push_back(i);
+   } else {
+    cout << "ERROR IN PROCESSPOOL: MERIT EVALUATION FAILED " << tries[i] << " TIMES." << endl;
+    costs[i] = HUGE_VAL;
+   }
+  }
+ }
+}
 
-#if defined(CESR_WINCVF)
-   ERR_EXIT(); 
 #else
-   err_exit_();
+
+ProcessPool::ProcessPool(int n_proc, int len, EvalFunc func, WorkerInitFunc init_func, double time_limit)
+  : n_workers(0), length(len), f(func), init(init_func), shm(0), server_pid(-1), server_sock(-1),
+    max_retry(0), timeout(time_limit), n_restart(0) {
+ cout << "ERROR IN PROCESSPOOL: NOT AVAILABLE ON THIS PLATFORM." << endl;
+}
+ProcessPool::~ProcessPool(){}
+bool ProcessPool::Spawn(int w) {return false;}
+void ProcessPool::Serve() {}
+void ProcessPool::Work(int w) {}
+void ProcessPool::Evaluate(const double* genes, int n, double* costs, int& end_flag, int* flags){
+ end_flag = 0;
+ for(int i=0; i<n; i++) costs[i] = HUGE_VAL;
+ if (flags) for(int i=0; i<n; i++) flags[i] = 0;
+}
+
 #endif
- }
 
- Mini xxx(gen, pop, len, func);
- xxx.Init(v0, vdel);
- Strand sol = xxx.Optimize();
+
+// Setup before a run. The crossover probability is scaled with the number of genes.
+
+void Opti::Setup(){
+ const double CR = 0.8;
+ flex_cr = CR * 10.0/length;
+ if ( 0.1 > flex_cr ) flex_cr = 0.1;
+ if ( CR < flex_cr ) flex_cr = CR;
+ cross.resize(population*length);
+}
+
+
+// Make trial strand t for strand i:
+//   t = a + rfrac * (b - c)   for genes picked by the crossover mask
+//   t = a                     otherwise
+// The random numbers are drawn first so that the row operation vectorizes.
+// Each (gen, i) pair has its own random stream so trials can be made in any order.
+
+void Opti::MakeTrial(int i, uint64_t gen, double* t){
+ const double frac = 1.4;
+ int a, b, c, j;
+ Philox r(seed, Stream(gen, i));
+ unsigned char *m = &cross[i*length];
+
+ do {a = r.Int(population);} while(a==i);
+ do {b = r.Int(population);} while(b==i || b==a);
+ do {c = r.Int(population);} while(c==i || c==b || c==a);
+ j = r.Int(length);
+ double rfrac = frac * r.Uniform();
+ for(int k=1; k<=length; k++){
+  m[j] = (r.Uniform() < flex_cr || k == length);
+  j = (j+1)%length;
+ }
+
+ const double *ga = strand[a].gene, *gb = strand[b].gene, *gc = strand[c].gene;
+ OMP_PRAGMA(omp simd)
+ for(int k=0; k<length; k++) t[k] = m[k] ? ga[k] + rfrac * (gb[k] - gc[k]) : ga[k];
+}
+
+
+Strand& Opti::Optimize(){
+ if (synchronous) return OptimizeSync();
+
+ int end_flag;
+ Setup();
+
+ if (start_gen == 1) {
+  for(int i=0; i<population; i++) strand[i].cost = Eval(strand[i].gene, end_flag);
+ }
+
+ for(int gen=start_gen; gen<=generations; gen++){
+  for(int i=0; i<population; i++){
+   MakeTrial(i, gen, trial.gene);
+   end_flag = 0;
+   trial.cost = Eval(trial.gene, end_flag);
+   if (Better(i)) strand[i] = trial;
+   if (end_flag == 1) return strand[Best()];
+  }
+  Checkpoint(gen, gen == generations);
+ }
+ return strand[Best()];
+}
+
+
+// Evaluate n strands with the process pool or batch function.
+// If flags is not null, it is set to the end_flag of each strand. The batch function
+// only returns one end_flag so flags is then all 0.
+
+void Opti::EvalBatch(const double* genes, int n, double* costs, int& end_flag, int* flags){
+ if (procs) {
+  procs->Evaluate(genes, n, costs, end_flag, flags);
+ } else {
+  fb(genes, n, length, costs, end_flag);
+  if (flags) for(int i=0; i<n; i++) flags[i] = 0;
+ }
+}
+
+
+// Evaluate all strands of pool. end_flag is set to 1 if any merit evaluation set it.
+
+void Opti::Evaluate(GenePool& pool, int& end_flag){
+ int n = pool.Population();
+ end_flag = 0;
+
+ if ((fb || procs) && !cache) {
+  batch_cost.resize(n);
+  EvalBatch(pool.Genes(), n, &batch_cost[0], end_flag);
+  for(int i=0; i<n; i++) pool.strand[i].cost = batch_cost[i];
+  return;
+ }
+
+ // With a cache only the strands not in the cache are evaluated.
+
+ if (fb || procs) {
+  batch_miss.clear();
+  batch_genes.resize(n*length);
+  int hit_flag = 0;
+  for(int i=0; i<n; i++){
+   int ef = 0;
+   if (cache->Lookup(pool.strand[i].gene, pool.strand[i].cost, ef)) {
+    if (ef == 1) hit_flag = 1;
+    continue;
+   }
+   for(int k=0; k<length; k++) batch_genes[batch_miss.size()*length+k] = pool.strand[i].gene[k];
+   batch_miss.push_back(i);
+  }
+  int n_miss = batch_miss.size();
+  if (n_miss > 0) {
+   batch_cost.resize(n_miss);
+   batch_flag.resize(n_miss);
+   EvalBatch(&batch_genes[0], n_miss, &batch_cost[0], end_flag, &batch_flag[0]);
+   for(int m=0; m<n_miss; m++){
+    int i = batch_miss[m];
+    pool.strand[i].cost = batch_cost[m];
+    cache->Insert(pool.strand[i].gene, batch_cost[m], batch_flag[m]);
+   }
+  }
+  if (hit_flag == 1) end_flag = 1;
+  return;
+ }
+
+ int flag = 0;
+#ifdef _OPENMP
+ int nt = (n_threads > 0) ? n_threads : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(nt) reduction(max:flag)
+#endif
+ for(int i=0; i<n; i++){
+  int ef = 0;
+  pool.strand[i].cost = Eval(pool.strand[i].gene, ef);
+  if (ef == 1) flag = 1;
+ }
+ end_flag = flag;
+}
+
+
+// Synchronous generation: Build all trials, evaluate them together, then select.
+// The trial construction is the same as in Optimize except that parents are not
+// replaced until the whole generation has been evaluated.
+
+Strand& Opti::OptimizeSync(){
+ int end_flag;
+ Setup();
+
+ if (trials.Population() != population) trials.Population(population);
+ if (trials.Length() != length) trials.Length(length);
+
+ if (start_gen == 1) {
+  Evaluate(*this, end_flag);
+  if (end_flag == 1) return strand[Best()];
+ }
+
+ for(int gen=start_gen; gen<=generations; gen++){
+  OMP_PRAGMA(omp parallel for)
+  for(int i=0; i<population; i++) MakeTrial(i, gen, trials.strand[i].gene);
+
+  Evaluate(trials, end_flag);
+
+  for(int i=0; i<population; i++){
+   if (BetterCost(trials.strand[i].cost, strand[i].cost)) strand[i] = trials.strand[i];
+  }
+  if (end_flag == 1) return strand[Best()];
+  Checkpoint(gen, gen == generations);
+ }
+ return strand[Best()];
+}
+
+
+
+// Checkpointing.
+//
+// A checkpoint holds everything needed to continue a run bit for bit: the strands,
+// their costs, the seed and the last completed generation (the random streams
+// only depend upon seed, generation and strand index). The snapshot is taken at the
+// end of a generation and written to file.tmp by a background thread which then
+// renames it to file so a crash during the write leaves the old checkpoint intact.
+//
+// File format: "OPTICKPT", int32 population, int32 length, int32 synchronous,
+// uint64 seed, int64 generation, then for each strand: cost and length genes.
+
+static void OptiWriteFile(string file, const vector<char>* buf){
+ string tmp = file + ".tmp";
+ FILE* fp = fopen(tmp.c_str(), "wb");
+ bool ok = (fp != 0);
+ if (ok) ok = fwrite(&(*buf)[0], 1, buf->size(), fp) == buf->size();
+ if (fp && fclose(fp) != 0) ok = false;
+ if (ok) ok = (rename(tmp.c_str(), file.c_str()) == 0);
+ if (!ok) {
+  remove(tmp.c_str());
+  cout << "ERROR IN OPTI: CANNOT WRITE CHECKPOINT FILE: " << file << endl;
+ }
+}
+
+
+template <class T> static void OptiPut(vector<char>& buf, const T& x){
+ const char* p = (const char*)&x;
+ buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+
+template <class T> static void OptiPut(vector<char>& buf, const vector<T>& x){
+ OptiPut(buf, int64_t(x.size()));
+ const char* p = (const char*)(x.size() ? &x[0] : 0);
+ buf.insert(buf.end(), p, p + x.size()*sizeof(T));
+}
+
+
+template <class T> static bool OptiGet(FILE* fp, T& x){
+ return fread(&x, sizeof(T), 1, fp) == 1;
+}
+
+
+template <class T> static bool OptiGet(FILE* fp, vector<T>& x){
+ int64_t n;
+ if (!OptiGet(fp, n) || n < 0 || n > (int64_t(1) << 40)) return false;
+ x.resize(n);
+ return n == 0 || fread(&x[0], sizeof(T), n, fp) == size_t(n);
+}
+
+
+void Opti::Checkpoint(int gen, bool force){
+ if (ckpt_file == "" || ckpt_every < 1) return;
+ if (!force && gen % ckpt_every != 0) return;
+ if (ckpt_thread.joinable()) ckpt_thread.join();
+
+ ckpt_buf.clear();
+ Snapshot(ckpt_buf, gen);
+ ckpt_thread = thread(OptiWriteFile, ckpt_file, &ckpt_buf);
+}
+
+
+void Opti::Snapshot(vector<char>& buf, int gen){
+ buf.insert(buf.end(), "OPTICKPT", "OPTICKPT" + 8);
+ OptiPut(buf, int32_t(population));
+ OptiPut(buf, int32_t(length));
+ OptiPut(buf, int32_t(synchronous || async));
+ OptiPut(buf, seed);
+ OptiPut(buf, int64_t(gen));
+ for(int i=0; i<population; i++){
+  OptiPut(buf, strand[i].cost);
+  const char* p = (const char*)strand[i].gene;
+  buf.insert(buf.end(), p, p + length*sizeof(double));
+ }
+}
+
+
+// Restore the state from a checkpoint file. The next Optimize call continues from
+// the generation after the one saved. Returns false if the file cannot be read or
+// does not match the population and length.
+
+bool Opti::Resume(const char* file){
+ FILE* fp = fopen(file, "rb");
+ if (!fp) return false;
+
+ char magic[8];
+ int32_t pop, len, sync;
+ uint64_t s;
+ int64_t gen;
+ bool ok = fread(magic, 1, 8, fp) == 8 && memcmp(magic, "OPTICKPT", 8) == 0 &&
+           fread(&pop, sizeof(pop), 1, fp) == 1 && fread(&len, sizeof(len), 1, fp) == 1 &&
+           fread(&sync, sizeof(sync), 1, fp) == 1 && fread(&s, sizeof(s), 1, fp) == 1 &&
+           fread(&gen, sizeof(gen), 1, fp) == 1 && pop == population && len == length;
+
+ for(int i=0; ok && i<population; i++){
+  ok = fread(&strand[i].cost, sizeof(double), 1, fp) == 1 &&
+       fread(strand[i].gene, sizeof(double), length, fp) == size_t(length);
+ }
+ fclose(fp);
+ if (!ok) return false;
+
+ seed = s;
+ synchronous = (sync != 0);
+ start_gen = int(gen) + 1;
+ return true;
+}
+
+
+// Asynchronous steady state mode.
+//
+// Trials are handed out with Ask and their costs returned with Tell in any order.
+// A trial replaces its target strand as soon as it is told, if it is better, so
+// fast evaluations are never held up by slow ones. The first population asks
+// hand out the initial strands. Trial targets cycle over the strands whose cost
+// is known and that do not already have a trial in flight, so each in flight trial
+// has its own target, crossover mask row and random stream. At most max_in_flight
+// (<= population) trials are outstanding at any time.
+// Since the result depends upon the order of completion, this mode is not
+// reproducible from run to run.
+
+void Opti::AsyncStart(int max_in_flight){
+ Setup();
+ if (max_in_flight < 1) max_in_flight = 1;
+ if (max_in_flight > population) max_in_flight = population;
+ if (flight.Population() != max_in_flight) flight.Population(max_in_flight);
+ if (flight.Length() != length) flight.Length(length);
+ flight_target.assign(max_in_flight, -1);
+ flight_init.assign(max_in_flight, 0);
+ known.assign(population, 0);
+ targeted.assign(population, 0);
+ n_asked = 0;
+ n_told = 0;
+ n_in_flight = 0;
+ n_known = 0;
+ next_target = 0;
+ async_done = false;
+}
+
+
+// Returns a ticket >= 0 and the trial genes, or:
+//   -1  No trial available now. Try again after the next Tell.
+//   -2  Finished. No more trials will be handed out.
+
+int Opti::Ask(double* genes){
+ if (async_done || n_asked >= (long)population * (generations + 1)) return -2;
+ if (n_in_flight == flight.Population()) return -1;
+
+ int target;
+ bool init = (n_asked < population);
+ if (init) {
+  target = int(n_asked);
+ } else {
+  int k;
+  for(k=0; k<population && (!known[next_target] || targeted[next_target]); k++)
+   next_target = (next_target+1)%population;
+  if (k == population) return -1;
+  target = next_target;
+  next_target = (next_target+1)%population;
+ }
+
+ int ticket = 0;
+ while (flight_target[ticket] >= 0) ticket++;
+ flight_target[ticket] = target;
+ flight_init[ticket] = init;
+ targeted[target] = 1;
+ n_in_flight++;
+
+ double* g = flight.strand[ticket].gene;
+ if (init) {
+  for(int k=0; k<length; k++) g[k] = strand[target].gene[k];
+ } else {
+  MakeTrial(target, n_asked + 1, g);      // Unique random stream for each ask.
+ }
+ n_asked++;
+
+ for(int k=0; k<length; k++) genes[k] = g[k];
+ return ticket;
+}
+
+
+void Opti::Tell(int ticket, double cost, int end_flag){
+ if (ticket < 0 || ticket >= flight.Population() || flight_target[ticket] < 0) {
+  cout << "ERROR IN OPTI::TELL: INVALID TICKET: " << ticket << endl;
+  return;
+ }
+
+ int target = flight_target[ticket];
+ if (flight_init[ticket]) {
+  strand[target].cost = cost;
+  known[target] = 1;
+  n_known++;
+ } else {
+  if (BetterCost(cost, strand[target].cost)) {
+   strand[target] = flight.strand[ticket];
+   strand[target].cost = cost;
+  }
+  n_told++;
+ }
+
+ flight_target[ticket] = -1;
+ targeted[target] = 0;
+ n_in_flight--;
+ if (end_flag == 1) async_done = true;
+
+ // Every population trials count as a generation for checkpointing.
+
+ if (n_known == population && n_told > 0 && n_told % population == 0) Checkpoint(int(n_told / population));
+}
+
+
+// Run asynchronously with n_thr threads each evaluating f.
+// Each thread returns its result and asks for the next trial in one step. If no trial
+// is available (all strands with known cost have a trial in flight) the thread waits
+// until another thread returns a result.
+
+Strand& Opti::OptimizeAsync(int n_thr, int max_in_flight){
+ int nt = 1;
+#ifdef _OPENMP
+ nt = (n_thr > 0) ? n_thr : omp_get_max_threads();
+#endif
+ if (nt > population) nt = population;   // So every thread starts with an initial strand.
+ AsyncStart(max(nt, max_in_flight));
+ async = true;
+
+ OMP_PRAGMA(omp parallel num_threads(nt))
+ {
+  vector<double> g(length);
+  int ticket = -1, end_flag = 0;
+  double cost = 0;
+  while (true) {
+   {
+    unique_lock<mutex> lock(async_mutex);
+    if (ticket >= 0) {
+     Tell(ticket, cost, end_flag);
+     async_cond.notify_all();
+    }
+    while ((ticket = Ask(&g[0])) == -1) async_cond.wait(lock);
+   }
+   if (ticket == -2) break;
+   end_flag = 0;
+   cost = Eval(&g[0], end_flag);
+  }
+ }
+
+ if (n_known == population) Checkpoint(int(n_told / population), true);
+ async = false;
+ return strand[Best()];
+}
+
+
+// Make SHADE trial strand t for strand i.
+
+void AdaptiveOpti::MakeAdaptiveTrial(int i, uint64_t gen, double* t){
+ const double pi = 3.14159265358979323846;
+ Philox r(seed, Stream(gen, i));
+ int h = r.Int(h_size);
+
+ // CR ~ Normal(m_cr, 0.1) in [0, 1]. A memory value < 0 is the "terminal" value: CR = 0.
+ if (m_cr[h] < 0) {
+  cr[i] = 0;
+ } else {
+  double u1 = r.Uniform(), u2 = r.Uniform();
+  cr[i] = m_cr[h] + 0.1 * sqrt(-2.0 * log(1.0 - u1)) * cos(2.0 * pi * u2);
+  cr[i] = min(1.0, max(0.0, cr[i]));
+ }
+
+ // F ~ Cauchy(m_f, 0.1). Regenerated if <= 0, truncated to 1.
+ do {sf[i] = m_f[h] + 0.1 * tan(pi * (r.Uniform() - 0.5));} while (sf[i] <= 0);
+ if (sf[i] > 1) sf[i] = 1;
+
+ // pbest from the best p*population strands with p in [2/population, 0.2].
+ double p_min = 2.0 / population;
+ double p = p_min + r.Uniform() * max(0.0, 0.2 - p_min);
+ int n_best = max(2, int(p * population + 0.5));
+ int pbest = order[r.Int(n_best)];
+
+ int r1, r2;
+ do {r1 = r.Int(population);} while(r1==i);
+ do {r2 = r.Int(population + n_archive);} while(r2==i || r2==r1);
+
+ const double *gi = strand[i].gene, *gp = strand[pbest].gene, *g1 = strand[r1].gene;
+ const double *g2 = (r2 < population) ? strand[r2].gene : &archive[(r2-population)*length];
+ unsigned char *m = &cross[i*length];
+ int j = r.Int(length);
+ for(int k=0; k<length; k++) m[k] = (r.Uniform() < cr[i] || k == j);
+
+ double f = sf[i];
+ OMP_PRAGMA(omp simd)
+ for(int k=0; k<length; k++) t[k] = m[k] ? gi[k] + f * (gp[k] - gi[k]) + f * (g1[k] - g2[k]) : gi[k];
+}
+
+
+Strand& AdaptiveOpti::Optimize(){
+ int end_flag;
+ Setup();
+
+ cr.resize(population);
+ sf.resize(population);
+ order.resize(population);
+
+ if (trials.Population() != population) trials.Population(population);
+ if (trials.Length() != length) trials.Length(length);
+
+ if (start_gen == 1) {
+  m_cr.assign(h_size, 0.5);
+  m_f.assign(h_size, 0.5);
+  k_mem = 0;
+  archive.resize(population*length);
+  n_archive = 0;
+  Evaluate(*this, end_flag);
+  if (end_flag == 1) return strand[Best()];
+ }
+
+ vector<double> s_cr, s_f, s_df;
+
+ for(int gen=start_gen; gen<=generations; gen++){
+  for(int i=0; i<population; i++) order[i] = i;
+  for(int i=1; i<population; i++){     // Insertion sort. Stable so the result is reproducible.
+   int o = order[i], k = i;
+   for(; k > 0 && strand[o].cost < strand[order[k-1]].cost; k--) order[k] = order[k-1];
+   order[k] = o;
+  }
+
+  OMP_PRAGMA(omp parallel for)
+  for(int i=0; i<population; i++) MakeAdaptiveTrial(i, gen, trials.strand[i].gene);
+
+  Evaluate(trials, end_flag);
+
+  // Selection. Replaced parents go to the archive. When the archive is full a random entry is overwritten.
+
+  Philox r(seed, Stream(gen, population));
+  s_cr.clear(); s_f.clear(); s_df.clear();
+
+  for(int i=0; i<population; i++){
+   Strand& t = trials.strand[i];
+   if (!(t.cost <= strand[i].cost)) continue;     // A NaN trial never replaces its parent.
+   if (t.cost < strand[i].cost) {
+    int ia = (n_archive < population) ? n_archive++ : r.Int(population);
+    for(int k=0; k<length; k++) archive[ia*length+k] = strand[i].gene[k];
+    s_cr.push_back(cr[i]);
+    s_f.push_back(sf[i]);
+    s_df.push_back(strand[i].cost - t.cost);
+   }
+   strand[i] = t;
+  }
+
+  // Memory update with weighted (Lehmer for F) means.
+
+  if (s_df.size() > 0) {
+   double w_sum = 0, cr_sum = 0, f_sum = 0, f2_sum = 0;
+   for(size_t k=0; k<s_df.size(); k++) w_sum += s_df[k];
+   for(size_t k=0; k<s_df.size(); k++){
+    double w = (w_sum > 0) ? s_df[k] / w_sum : 1.0 / s_df.size();
+    cr_sum += w * s_cr[k];
+    f_sum  += w * s_f[k];
+    f2_sum += w * s_f[k] * s_f[k];
+   }
+   m_cr[k_mem] = (m_cr[k_mem] < 0 || cr_sum == 0) ? -1 : cr_sum;
+   m_f[k_mem] = f2_sum / f_sum;
+   k_mem = (k_mem + 1) % h_size;
+  }
+
+  if (end_flag == 1) return strand[Best()];
+  Checkpoint(gen, gen == generations);
+ }
+ return strand[Best()];
+}
+
+
+// SHADE checkpoint. Written at the end of a generation. Besides the strands it holds the
+// history memory and the archive which, with the seed, are all that the next generation
+// depends upon.
+// File format: "OPTISHAD", int32 population, int32 length, int32 h_size, uint64 seed,
+// int64 generation, int32 k_mem, int32 n_archive, then the vectors (each an int64 size
+// followed by the doubles) m_cr, m_f and archive, then for each strand: cost and length genes.
+
+void AdaptiveOpti::Snapshot(vector<char>& buf, int gen){
+ buf.insert(buf.end(), "OPTISHAD", "OPTISHAD" + 8);
+ OptiPut(buf, int32_t(population));
+ OptiPut(buf, int32_t(length));
+ OptiPut(buf, int32_t(h_size));
+ OptiPut(buf, seed);
+ OptiPut(buf, int64_t(gen));
+ OptiPut(buf, int32_t(k_mem));
+ OptiPut(buf, int32_t(n_archive));
+ OptiPut(buf, m_cr);
+ OptiPut(buf, m_f);
+ OptiPut(buf, archive);
+ for(int i=0; i<population; i++){
+  OptiPut(buf, strand[i].cost);
+  const char* p = (const char*)strand[i].gene;
+  buf.insert(buf.end(), p, p + length*sizeof(double));
+ }
+}
+
+
+// Restore the state from a SHADE checkpoint file. The next Optimize call continues from
+// the generation after the one saved. Returns false if the file cannot be read or
+// does not match the population, length and memory size.
+
+bool AdaptiveOpti::Resume(const char* file){
+ FILE* fp = fopen(file, "rb");
+ if (!fp) return false;
+
+ char magic[8];
+ int32_t pop, len, h, k, n_arc;
+ uint64_t s;
+ int64_t gen;
+ bool ok = fread(magic, 1, 8, fp) == 8 && memcmp(magic, "OPTISHAD", 8) == 0 &&
+           OptiGet(fp, pop) && OptiGet(fp, len) && OptiGet(fp, h) && OptiGet(fp, s) &&
+           OptiGet(fp, gen) && OptiGet(fp, k) && OptiGet(fp, n_arc) &&
+           pop == population && len == length && h == h_size &&
+           OptiGet(fp, m_cr) && OptiGet(fp, m_f) && OptiGet(fp, archive);
+
+ ok = ok && k >= 0 && k < h_size && n_arc >= 0 && n_arc <= population &&
+      m_cr.size() == size_t(h_size) && m_f.size() == size_t(h_size) &&
+      archive.size() == size_t(population) * length;
+
+ for(int i=0; ok && i<population; i++){
+  ok = fread(&strand[i].cost, sizeof(double), 1, fp) == 1 &&
+       fread(strand[i].gene, sizeof(double), length, fp) == size_t(length);
+ }
+ fclose(fp);
+ if (!ok) return false;
+
+ seed = s;
+ k_mem = k;
+ n_archive = n_arc;
+ start_gen = int(gen) + 1;
+ return true;
+}
+
+
+
+//--------------------------------------------------------------------
+// CMA-ES
+
+// BLAS symmetric rank k update: C = alpha A A^T + beta C (column major).
+
+extern "C" void dsyrk_(const char* uplo, const char* trans, const int* n, const int* k,
+	const double* alpha, const double* a, const int* lda, const double* beta, double* c,
+	const int* ldc, size_t uplo_len, size_t trans_len);
+
+void CmaesOpti::Init(double v0[], double vdel[]){
+ x0.assign(v0, v0 + length);
+ sig0.assign(vdel, vdel + length);
+ for(int i=0; i<length; i++) if (sig0[i] <= 0) sig0[i] = 1;
+}
+
+
+// Eigendecomposition C = B diag(D^2) B^T by cyclic Jacobi rotations.
+
+void CmaesOpti::Eigen(){
+ int n = length;
+ vector<double> A(C);
+ B.assign(n*n, 0);
+ for(int i=0; i<n; i++) B[i*n+i] = 1;
+
+ for(int sweep=0; sweep<50; sweep++){
+  double off = 0, diag = 0;
+  for(int i=0; i<n; i++){
+   diag += A[i*n+i] * A[i*n+i];
+   for(int j=i+1; j<n; j++) off += A[i*n+j] * A[i*n+j];
+  }
+  if (off <= 1e-30 * diag) break;
+
+  for(int p=0; p<n; p++){
+   for(int q=p+1; q<n; q++){
+    double apq = A[p*n+q];
+    if (apq == 0) continue;
+    double theta = (A[q*n+q] - A[p*n+p]) / (2 * apq);
+    double t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta*theta + 1));
+    double c = 1 / sqrt(t*t + 1), s = t * c;
+    for(int k=0; k<n; k++){
+     double akp = A[k*n+p], akq = A[k*n+q];
+     A[k*n+p] = c * akp - s * akq;
+     A[k*n+q] = s * akp + c * akq;
+    }
+    for(int k=0; k<n; k++){
+     double apk = A[p*n+k], aqk = A[q*n+k];
+     A[p*n+k] = c * apk - s * aqk;
+     A[q*n+k] = s * apk + c * aqk;
+    }
+    for(int k=0; k<n; k++){
+     double bkp = B[k*n+p], bkq = B[k*n+q];
+     B[k*n+p] = c * bkp - s * bkq;
+     B[k*n+q] = s * bkp + c * bkq;
+    }
+   }
+  }
+ }
+
+ for(int i=0; i<n; i++) D[i] = sqrt(max(A[i*n+i], 1e-300));
+}
+
+
+// One CMA-ES run with population lambda starting from xmean with step sizes sig0, or
+// continuing from the state restored by Resume. Returns true if the run stopped
+// because it converged or stagnated (so a restart makes sense).
+
+bool CmaesOpti::Run(long max_eval, int& end_flag){
+ const double pi = 3.14159265358979323846;
+ int n = length;
+ int mu = lambda / 2;
+
+ weights.resize(mu);
+ double w_sum = 0, w2_sum = 0;
+ for(int k=0; k<mu; k++) {weights[k] = log(mu + 0.5) - log(k + 1.0); w_sum += weights[k];}
+ for(int k=0; k<mu; k++) {weights[k] /= w_sum; w2_sum += weights[k] * weights[k];}
+ double mueff = 1 / w2_sum;
+
+ double cc = (4 + mueff/n) / (n + 4 + 2*mueff/n);
+ double cs = (mueff + 2) / (n + mueff + 5);
+ double c1 = 2 / ((n + 1.3) * (n + 1.3) + mueff);
+ double cmu = min(1 - c1, 2 * (mueff - 2 + 1/mueff) / ((n + 2) * (n + 2) + mueff));
+ double damps = 1 + 2 * max(0.0, sqrt((mueff - 1) / (n + 1)) - 1) + cs;
+ double chi_n = sqrt(double(n)) * (1 - 1.0/(4*n) + 1.0/(21.0*n*n));
+ int eigen_every = max(1, int(lambda / (c1 + cmu) / n / 10));
+
+ if (population != lambda) Population(lambda);
+
+ // Initial state: sigma = 1 and C = diag(sig0^2).
+
+ if (!resumed) {
+  sigma = 1;
+  ps.assign(n, 0);
+  pc.assign(n, 0);
+  C.assign(n*n, 0);
+  B.assign(n*n, 0);
+  D.assign(sig0.begin(), sig0.end());
+  for(int i=0; i<n; i++) {C[i*n+i] = sig0[i] * sig0[i]; B[i*n+i] = 1;}
+  history.clear();
+  g = 0;
+ }
+ resumed = false;
+ Y.resize(lambda*n);
+ Yw.resize((mu+1)*n);
+ ywt.resize(n);
+ order.resize(lambda);
+
+ size_t n_hist = 10 + size_t(30.0 * n / lambda);
+ double max_sig0 = *max_element(sig0.begin(), sig0.end());
+
+ for(; ; g++){
+  if (n_eval + lambda > max_eval) return false;
+  gen++;
+
+  // Sample: y = B D z, x = xmean + sigma y.
+
+  OMP_PRAGMA(omp parallel for)
+  for(int k=0; k<lambda; k++){
+   Philox r(seed, Stream(gen, k));
+   vector<double> z(n);
+   for(int i=0; i<n; i+=2){
+    double rho = sqrt(-2 * log(1 - r.Uniform())), phi = 2 * pi * r.Uniform();
+    z[i] = D[i] * rho * cos(phi);
+    if (i+1 < n) z[i+1] = D[i+1] * rho * sin(phi);
+   }
+   double *y = &Y[k*n], *x = strand[k].gene;
+   for(int i=0; i<n; i++){
+    double s = 0;
+    for(int j=0; j<n; j++) s += B[i*n+j] * z[j];
+    y[i] = s;
+    x[i] = xmean[i] + sigma * s;
+   }
+  }
+
+  Evaluate(*this, end_flag);
+  n_eval += lambda;
+
+  for(int k=0; k<lambda; k++) order[k] = k;
+  for(int k=1; k<lambda; k++){
+   int o = order[k], j = k;
+   for(; j > 0 && strand[o].cost < strand[order[j-1]].cost; j--) order[j] = order[j-1];
+   order[j] = o;
+  }
+  if (strand[order[0]].cost < best.cost) best = strand[order[0]];
+  if (end_flag == 1) return false;
+
+  // Mean and evolution paths.
+
+  xold = xmean;
+  for(int i=0; i<n; i++){
+   double s = 0;
+   for(int k=0; k<mu; k++) s += weights[k] * Y[order[k]*n+i];
+   ywt[i] = s;
+   xmean[i] = xold[i] + sigma * s;
+  }
+
+  vector<double> tmp(n);             // C^-1/2 ywt = B D^-1 B^T ywt
+  for(int j=0; j<n; j++){
+   double s = 0;
+   for(int i=0; i<n; i++) s += B[i*n+j] * ywt[i];
+   tmp[j] = s / D[j];
+  }
+  double ps_norm2 = 0, f_cs = sqrt(cs * (2 - cs) * mueff);
+  for(int i=0; i<n; i++){
+   double s = 0;
+   for(int j=0; j<n; j++) s += B[i*n+j] * tmp[j];
+   ps[i] = (1 - cs) * ps[i] + f_cs * s;
+   ps_norm2 += ps[i] * ps[i];
+  }
+  double ps_norm = sqrt(ps_norm2);
+  bool hsig = ps_norm / sqrt(1 - pow(1 - cs, 2.0 * (g + 1))) / chi_n < 1.4 + 2.0 / (n + 1);
+
+  double f_cc = hsig ? sqrt(cc * (2 - cc) * mueff) : 0;
+  for(int i=0; i<n; i++) pc[i] = (1 - cc) * pc[i] + f_cc * ywt[i];
+
+  // Covariance: C = a C + c1 pc pc^T + cmu sum_k w_k y_k y_k^T. The rank one and
+  // rank mu updates are done together with one dsyrk call using the columns
+  // sqrt(c1) pc and sqrt(cmu w_k) y_k. dsyrk only updates one triangle (the lower
+  // one for row major C) which is then copied to the other.
+
+  double a = 1 - c1 - cmu + (hsig ? 0 : c1 * cc * (2 - cc));
+  double f1 = sqrt(c1), one = 1;
+  for(int i=0; i<n; i++) Yw[i] = f1 * pc[i];
+  for(int k=0; k<mu; k++){
+   const double* y = &Y[order[k]*n];
+   double* yw = &Yw[(k+1)*n];
+   double f = sqrt(cmu * weights[k]);
+   for(int i=0; i<n; i++) yw[i] = f * y[i];
+  }
+  int n_col = mu + 1;
+  dsyrk_("U", "N", &n, &n_col, &one, &Yw[0], &n, &a, &C[0], &n, 1, 1);
+  for(int i=0; i<n; i++)
+   for(int j=i+1; j<n; j++) C[i*n+j] = C[j*n+i];
+
+  sigma *= exp((cs / damps) * (ps_norm / chi_n - 1));
+
+  if (g % eigen_every == 0) Eigen();
+
+  // Stopping criteria (Hansen's TolX, TolFun, TolHistFun and ConditionCov).
+
+  double d_max = *max_element(D.begin(), D.end()), d_min = *min_element(D.begin(), D.end());
+  history.push_back(strand[order[0]].cost);
+  if (history.size() > n_hist) history.erase(history.begin());
+
+  if (sigma * d_max < 1e-12 * max_sig0) return true;
+  if (d_max > 1e7 * d_min) return true;
+  if (!isfinite(sigma) || !isfinite(xmean[0])) return true;
+  double f_range = fabs(strand[order[lambda-1]].cost - strand[order[0]].cost);
+  if (history.size() == n_hist) {
+   double h_min = *min_element(history.begin(), history.end());
+   double h_max = *max_element(history.begin(), history.end());
+   if (max(f_range, h_max - h_min) < 1e-12 * max(1.0, fabs(h_min))) return true;
+  }
+
+  // The checkpoint is forced if the evaluation budget is used up.
+
+  Checkpoint(int(gen), n_eval + lambda > max_eval);
+ }
+}
+
+
+Strand& CmaesOpti::Optimize(){
+ int end_flag = 0;
+
+ if (!resumed) {
+  int lambda_min = 4 + int(3 * log(double(length)));
+  lambda0 = max(population, lambda_min);
+  lambda = lambda0;
+  restart = 0;
+  n_eval = 0;
+  gen = 0;
+  if (x0.size() == 0) {
+   x0.assign(length, 0);
+   sig0.assign(length, 1);
+  }
+  xmean = x0;
+ }
+ long max_eval = long(generations) * lambda0;
+
+ for(; ; restart++){
+  bool converged = Run(max_eval, end_flag);
+  if (!converged || end_flag == 1 || restart >= n_restart) break;
+
+  // IPOP: Double the population and start again from a random point.
+
+  lambda *= 2;
+  Philox r(seed, Stream(gen, 0x7fffffff));
+  for(int i=0; i<length; i++) xmean[i] = x0[i] + 2 * sig0[i] * (r.Uniform() - 0.5);
+ }
+
+ return best;
+}
+
+
+// CMA-ES checkpoint. Written at the end of a generation. Holds the full state for the
+// next generation (g + 1) so a resumed run is the same as an uninterrupted one.
+// File format: "OPTICMAE", int32 length, uint64 seed, int32 lambda0, lambda, restart, g + 1,
+// int64 n_eval, uint64 gen, double sigma, best cost, then the vectors (each an int64 size
+// followed by the doubles) best genes, x0, sig0, xmean, ps, pc, C, B, D and history.
+
+void CmaesOpti::Snapshot(vector<char>& buf, int){
+ buf.insert(buf.end(), "OPTICMAE", "OPTICMAE" + 8);
+ OptiPut(buf, int32_t(length));
+ OptiPut(buf, seed);
+ OptiPut(buf, int32_t(lambda0));
+ OptiPut(buf, int32_t(lambda));
+ OptiPut(buf, int32_t(restart));
+ OptiPut(buf, int32_t(g + 1));
+ OptiPut(buf, int64_t(n_eval));
+ OptiPut(buf, gen);
+ OptiPut(buf, sigma);
+ OptiPut(buf, best.cost);
+ OptiPut(buf, vector<double>(best.gene, best.gene + length));
+ OptiPut(buf, x0);
+ OptiPut(buf, sig0);
+ OptiPut(buf, xmean);
+ OptiPut(buf, ps);
+ OptiPut(buf, pc);
+ OptiPut(buf, C);
+ OptiPut(buf, B);
+ OptiPut(buf, D);
+ OptiPut(buf, history);
+}
+
+
+// Restore the state from a CMA-ES checkpoint file. The next Optimize call continues
+// the run. Returns false if the file cannot be read or does not match the length.
+
+bool CmaesOpti::Resume(const char* file){
+ FILE* fp = fopen(file, "rb");
+ if (!fp) return false;
+
+ char magic[8];
+ int32_t len, lam0, lam, rs, gg;
+ int64_t ne;
+ vector<double> best_gene;
+ size_t n = length, n2 = size_t(length) * length;
+ bool ok = fread(magic, 1, 8, fp) == 8 && memcmp(magic, "OPTICMAE", 8) == 0 &&
+           OptiGet(fp, len) && len == length && OptiGet(fp, seed) &&
+           OptiGet(fp, lam0) && OptiGet(fp, lam) && OptiGet(fp, rs) && OptiGet(fp, gg) &&
+           OptiGet(fp, ne) && OptiGet(fp, gen) && OptiGet(fp, sigma) && OptiGet(fp, best.cost) &&
+           OptiGet(fp, best_gene) && OptiGet(fp, x0) && OptiGet(fp, sig0) &&
+           OptiGet(fp, xmean) && OptiGet(fp, ps) && OptiGet(fp, pc) &&
+           OptiGet(fp, C) && OptiGet(fp, B) && OptiGet(fp, D) && OptiGet(fp, history);
+ fclose(fp);
+
+ ok = ok && lam0 > 0 && lam >= lam0 && best_gene.size() == n && x0.size() == n &&
+      sig0.size() == n && xmean.size() == n && ps.size() == n && pc.size() == n &&
+      C.size() == n2 && B.size() == n2 && D.size() == n;
+ if (!ok) return false;
+
+ for(int i=0; i<length; i++) best.gene[i] = best_gene[i];
+ lambda0 = lam0;
+ lambda = lam;
+ restart = rs;
+ g = gg;
+ n_eval = ne;
+ resumed = true;
+ return true;
+}
+
+
+double MiniOff(double solution[], const int& gen, const int& pop,
+	const int& len, EvalFunc func, const double& offset,
+	const double& delta){
+
+ Mini xxx(gen, pop, len, func);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ xxx.Init(offset, delta);
+ Strand& sol = xxx.Optimize();
+ OptiCacheSave(xxx);
  for(int index=0; index<len; index++) solution[index] = sol(index);
  return sol.Cost();
 }
 
 
+double MiniVec(double solution[], const int& gen, const int& pop, 
+	const int& len, EvalFunc func, double v0[], 
+	const double& delta){
+
+ Mini xxx(gen, pop, len, func);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ xxx.Init(v0, delta);
+ Strand& sol = xxx.Optimize();
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+#if defined(CESR_WINCVF)
+extern "C" double OPTI(double solution[], const int& gen, const int& pop, 
+	const int& len, EvalFunc func, double v0[], 
+	double vdel[]){
+#else
+extern "C" double opti_(double solution[], const int& gen, const int& pop, 
+	const int& len, EvalFunc func, double v0[], 
+	double vdel[]){
+
+#endif
+
+ if (pop < 4) {
+   cout << "ERROR IN OPTI: POPULATION MUST BE AT LEAST 4!\n";
+   OptiErrExit();
+ }
+
+ Mini xxx(gen, pop, len, func);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ xxx.Init(v0, vdel);
+ Strand& sol = xxx.Optimize();
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+
+extern "C" double opti_resume_(double solution[], const int& gen, const int& pop, 
+	const int& len, EvalFunc func, const char* file, const int& n_threads){
+
+ Mini xxx(gen, pop, len, func);
+ OptiCacheAttach(xxx);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ if (!xxx.Resume(file)) {
+   cout << "ERROR IN OPTI_RESUME: CANNOT READ CHECKPOINT FILE: " << file << endl;
+   OptiErrExit();
+   return 0;
+ }
+ xxx.Synchronous(xxx.IsSynchronous(), n_threads);
+ ProcessPool* pp = OptiProcsAttach(xxx, len, func);
+ Strand& sol = xxx.Optimize();
+ delete pp;
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+
+extern "C" double opti_batch_(double solution[], const int& gen, const int& pop, 
+	const int& len, BatchEvalFunc func, double v0[], double vdel[]){
+
+ if (pop < 4) {
+   cout << "ERROR IN OPTI_BATCH: POPULATION MUST BE AT LEAST 4!\n";
+   OptiErrExit();
+ }
+
+ Mini xxx(gen, pop, len, 0);
+ xxx.SetBatch(func);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ xxx.Init(v0, vdel);
+ Strand& sol = xxx.Optimize();
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+
+extern "C" double opti_parallel_(double solution[], const int& gen, const int& pop, 
+	const int& len, EvalFunc func, double v0[], double vdel[], const int& n_threads){
+
+ if (pop < 4) {
+   cout << "ERROR IN OPTI_PARALLEL: POPULATION MUST BE AT LEAST 4!\n";
+   OptiErrExit();
+ }
+
+ Mini xxx(gen, pop, len, func);
+ xxx.Synchronous(true, n_threads);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ ProcessPool* pp = OptiProcsAttach(xxx, len, func);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ xxx.Init(v0, vdel);
+ Strand& sol = xxx.Optimize();
+ delete pp;
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+
+extern "C" double opti_shade_(double solution[], const int& gen, const int& pop, 
+	const int& len, EvalFunc func, double v0[], double vdel[], const int& n_threads){
+
+ if (pop < 4) {
+   cout << "ERROR IN OPTI_SHADE: POPULATION MUST BE AT LEAST 4!\n";
+   OptiErrExit();
+ }
+
+ AdaptiveOpti xxx(gen, pop, len, func);
+ xxx.Synchronous(true, n_threads);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ ProcessPool* pp = OptiProcsAttach(xxx, len, func);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ xxx.Init(v0, vdel);
+ Strand& sol = xxx.Optimize();
+ delete pp;
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+
+extern "C" double opti_shade_resume_(double solution[], const int& gen, const int& pop, 
+	const int& len, EvalFunc func, const char* file, const int& n_threads){
+
+ AdaptiveOpti xxx(gen, pop, len, func);
+ if (!xxx.Resume(file)) {
+   cout << "ERROR IN OPTI_SHADE_RESUME: CANNOT READ CHECKPOINT FILE: " << file << endl;
+   OptiErrExit();
+   return 0;
+ }
+ xxx.Synchronous(true, n_threads);
+ OptiCacheAttach(xxx);
+ ProcessPool* pp = OptiProcsAttach(xxx, len, func);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ Strand& sol = xxx.Optimize();
+ delete pp;
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+
+extern "C" double opti_cmaes_(double solution[], const int& gen, const int& pop, 
+	const int& len, EvalFunc func, double v0[], double vdel[], const int& n_threads,
+	const int& n_restart){
+
+ if (gen < 1 || len < 1 || pop < 0) {
+   cout << "ERROR IN OPTI_CMAES: GEN AND N_VARS MUST BE POSITIVE AND POP MUST NOT BE NEGATIVE!\n";
+   OptiErrExit();
+   return 0;
+ }
+
+ for(int index=0; index<len; index++){
+  if (!(vdel[index] > 0) || !isfinite(vdel[index])) {
+   cout << "ERROR IN OPTI_CMAES: V_DEL MUST BE POSITIVE!\n";
+   OptiErrExit();
+   return 0;
+  }
+ }
+
+ CmaesOpti xxx(gen, pop, len, func, n_restart);
+ xxx.Synchronous(true, n_threads);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ ProcessPool* pp = OptiProcsAttach(xxx, len, func);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ xxx.Init(v0, vdel);
+ Strand& sol = xxx.Optimize();
+ delete pp;
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+
+extern "C" double opti_cmaes_resume_(double solution[], const int& gen, const int& len,
+	EvalFunc func, const char* file, const int& n_threads, const int& n_restart){
+
+ CmaesOpti xxx(gen, 0, len, func, n_restart);
+ if (!xxx.Resume(file)) {
+   cout << "ERROR IN OPTI_CMAES_RESUME: CANNOT READ CHECKPOINT FILE: " << file << endl;
+   OptiErrExit();
+   return 0;
+ }
+ xxx.Synchronous(true, n_threads);
+ OptiCacheAttach(xxx);
+ ProcessPool* pp = OptiProcsAttach(xxx, len, func);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ Strand& sol = xxx.Optimize();
+ delete pp;
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+
+extern "C" double opti_async_(double solution[], const int& gen, const int& pop, 
+	const int& len, EvalFunc func, double v0[], double vdel[], const int& n_threads){
+
+ if (pop < 4) {
+   cout << "ERROR IN OPTI_ASYNC: POPULATION MUST BE AT LEAST 4!\n";
+   OptiErrExit();
+ }
+
+ Mini xxx(gen, pop, len, func);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
+ xxx.Init(v0, vdel);
+ Strand& sol = xxx.OptimizeAsync(n_threads, 0);
+ OptiCacheSave(xxx);
+ for(int index=0; index<len; index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+
+// Completion driven interface for external workers. See Opti::Ask and Opti::Tell.
+
+extern "C" void* opti_async_create_(const int& gen, const int& pop, const int& len,
+	double v0[], double vdel[], const int& max_in_flight){
+
+ if (pop < 4) {
+   cout << "ERROR IN OPTI_ASYNC_CREATE: POPULATION MUST BE AT LEAST 4!\n";
+   OptiErrExit();
+ }
+
+ Mini* xxx = new Mini(gen, pop, len, 0);
+ xxx->Seed(opti_seed);
+ xxx->Init(v0, vdel);
+ xxx->AsyncStart(max_in_flight);
+ return xxx;
+}
+
+extern "C" int opti_async_ask_(void* opt, double genes[]){
+ return ((Opti*)opt)->Ask(genes);
+}
+
+extern "C" void opti_async_tell_(void* opt, const int& ticket, const double& cost, const int& end_flag){
+ ((Opti*)opt)->Tell(ticket, cost, end_flag);
+}
+
+extern "C" double opti_async_best_(void* opt, double solution[]){
+ Strand& sol = ((Opti*)opt)->BestStrand();
+ for(int index=0; index<sol.Length(); index++) solution[index] = sol(index);
+ return sol.Cost();
+}
+
+extern "C" void opti_async_destroy_(void* opt){
+ delete (Opti*)opt;
+}
+
+
 double MaxiVec(double solution[], const int& gen, const int& pop, 
 	const int& len, EvalFunc func, double v0[], const double& delta){
 
  Maxi xxx(gen, pop, len, func);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
  xxx.Init(v0, delta);
- Strand sol = xxx.Optimize();
+ Strand& sol = xxx.Optimize();
+ OptiCacheSave(xxx);
  for(int index=0; index<len; index++) solution[index] = sol(index);
  return sol.Cost();
 }
@@ -351,8 +2487,12 @@ double MaxiDel(double solution[], const int& gen, const int& pop,
 	const int& len, EvalFunc func, double v0[], double vdel[]){
 
  Maxi xxx(gen, pop, len, func);
+ xxx.Seed(opti_seed);
+ OptiCacheAttach(xxx);
+ xxx.SetCheckpoint(opti_ckpt_file.c_str(), opti_ckpt_every);
  xxx.Init(v0, vdel);
- Strand sol = xxx.Optimize();
+ Strand& sol = xxx.Optimize();
+ OptiCacheSave(xxx);
  for(int index=0; index<len; index++) solution[index] = sol(index);
  return sol.Cost();
 }
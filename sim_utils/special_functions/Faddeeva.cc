@@ -1896,6 +1896,501 @@ extern "C" void faddeeva_w(double x, double y, double *wx, double *wy, double er
   *wx = creal(fw); *wy = cimag(fw);
 }
 
+/////////////////////////////////////////////////////////////////////////
+// Batched w(z) for arrays of arguments, e.g. the Bassetti-Erskine kick for
+// every particle of a bunch.  -- Added for Bmad.
+//
+// The points are first sorted by algorithm region.  Points in the
+// continued-fraction region and in the Alg. 916 (Zaghloul & Ali) region
+// are then evaluated in blocks of W_BATCH_BLOCK points.  Within a block,
+// every point uses the same number of terms (the maximum needed by any point
+// in the block) so that the inner loops have no data dependent branches and
+// vectorize.  Using more terms than needed only makes the continued fraction
+// or the sums converge further, so the accuracy is not degraded.
+//
+// Points on the real or imaginary axis, points with x + |y| > 4000,
+// x >= 10 near the real axis, Inf/NaN, and all points when relerr > DBL_EPSILON
+// are done with the scalar FADDEEVA(w).
+
+#ifdef __cplusplus
+
+#include <vector>
+
+#ifdef _OPENMP
+#define OMP_PRAGMA(directive) _Pragma(#directive)
+#else
+#define OMP_PRAGMA(directive)
+#endif
+
+#define W_BATCH_BLOCK 8
+
+enum {W_BATCH_CF = 0, W_BATCH_ALG916 = 1, W_BATCH_SCALAR = 2};
+
+static inline int w_batch_region(double xr, double y)
+{
+  const double x = fabs(xr), ya = fabs(y);
+  if (xr == 0 || y == 0 || isnan(x) || isnan(ya) || isinf(x) || isinf(ya))
+    return W_BATCH_SCALAR;
+  // Same region test as in FADDEEVA(w)
+  if (ya > 7 || (x > 6 && (ya > 0.1 || (x > 8 && ya > 1e-10) || x > 28)))
+    return (x + ya > 4000) ? W_BATCH_SCALAR : W_BATCH_CF;
+  if (x < 10) return W_BATCH_ALG916;
+  return W_BATCH_SCALAR;
+}
+
+// Continued fraction for m <= W_BATCH_BLOCK points.
+
+static void w_batch_cf(const double *xr, const double *y,
+                       double *out_re, double *out_im, int m)
+{
+  const double ispi = 0.56418958354775628694807945156; // 1 / sqrt(pi)
+  const double c0=3.9, c1=11.398, c2=0.08254, c3=0.1421, c4=0.2023; // fit
+  double xs[W_BATCH_BLOCK], ya[W_BATCH_BLOCK];
+  double wr[W_BATCH_BLOCK], wi[W_BATCH_BLOCK];
+  double nu_max = 0;
+
+  for (int i = 0; i < m; ++i) {
+    ya[i] = fabs(y[i]);
+    xs[i] = y[i] < 0 ? -xr[i] : xr[i]; // compute for -z if y < 0
+    double nu = floor(c0 + c1 / (c2*fabs(xr[i]) + c3*ya[i] + c4));
+    if (nu > nu_max) nu_max = nu;
+    wr[i] = xs[i];
+    wi[i] = ya[i];
+  }
+
+  for (double nu = 0.5 * (nu_max - 1); nu > 0.4; nu -= 0.5) {
+    OMP_PRAGMA(omp simd)
+    for (int i = 0; i < m; ++i) { // w <- z - nu/w:
+      double denom = nu / (wr[i]*wr[i] + wi[i]*wi[i]);
+      wr[i] = xs[i] - wr[i] * denom;
+      wi[i] = ya[i] + wi[i] * denom;
+    }
+  }
+
+  for (int i = 0; i < m; ++i) { // w(z) = i/sqrt(pi) / w:
+    double denom = ispi / (wr[i]*wr[i] + wi[i]*wi[i]);
+    double re = denom*wi[i], im = denom*wr[i];
+    if (y[i] < 0) { // w(z) = 2.0*exp(-z*z) - w(-z)
+      double e = 2*exp((ya[i]-xs[i])*(xs[i]+ya[i]));
+      double t = 2*xs[i]*y[i];
+      re = e*cos(t) - re;
+      im = e*sin(t) - im;
+    }
+    out_re[i] = re;
+    out_im[i] = im;
+  }
+}
+
+// Alg. 916 for m <= W_BATCH_BLOCK points with |x| < 10 and relerr = DBL_EPSILON.
+
+static void w_batch_alg916(const double *xr, const double *y,
+                           double *out_re, double *out_im, int m)
+{
+  const double a = 0.518321480430085929872; // pi / sqrt(-log(eps*0.5))
+  const double c = 0.329973702884629072537; // (2/pi) * a;
+  const double a2 = 0.268657157075235951582; // a^2
+  double x[W_BATCH_BLOCK], expx2[W_BATCH_BLOCK], erfcxy[W_BATCH_BLOCK];
+  double exp2ax[W_BATCH_BLOCK], expm2ax[W_BATCH_BLOCK];
+  double prod2ax[W_BATCH_BLOCK], prodm2ax[W_BATCH_BLOCK];
+  double sum1[W_BATCH_BLOCK], sum2[W_BATCH_BLOCK], sum3[W_BATCH_BLOCK];
+  double sum54[W_BATCH_BLOCK]; // sum5 - sum4
+  double x_max = 0;
+
+  for (int i = 0; i < m; ++i) {
+    x[i] = fabs(xr[i]);
+    if (x[i] > x_max) x_max = x[i];
+    erfcxy[i] = y[i] > -6 ? FADDEEVA_RE(erfcx)(y[i]) : 0;
+  }
+
+  OMP_PRAGMA(omp simd)
+  for (int i = 0; i < m; ++i) {
+    expx2[i] = exp(-x[i]*x[i]);
+    exp2ax[i] = exp((2*a)*x[i]);
+    expm2ax[i] = 1 / exp2ax[i];
+    prod2ax[i] = prodm2ax[i] = 1;
+    sum1[i] = sum2[i] = sum3[i] = sum54[i] = 0;
+  }
+
+  // The n-th term of the slowest converging sum (sum5) is ~ exp(-(a*n - x)^2)
+  // so terms beyond a*n = x + 6.5 are below relerr.
+
+  int n_max = int(ceil((x_max + 6.5) / a));
+  if (n_max > 50) n_max = 50; // expa2n2[50] = 0
+
+  for (int n = 1; n <= n_max; ++n) {
+    const double e = expa2n2[n-1], an = a*n, an2 = a2*(n*n);
+    OMP_PRAGMA(omp simd)
+    for (int i = 0; i < m; ++i) {
+      const double coef = e * expx2[i] / (an2 + y[i]*y[i]);
+      prod2ax[i] *= exp2ax[i];
+      prodm2ax[i] *= expm2ax[i];
+      sum1[i] += coef;
+      sum2[i] += coef * prodm2ax[i];
+      sum3[i] += coef * prod2ax[i];
+      // For small x compute sum5 - sum4 together to avoid cancellation.
+      sum54[i] += x[i] < 5e-4 ? coef * (2*an) * sinh_taylor((2*an)*x[i])
+                              : coef * an * (prod2ax[i] - prodm2ax[i]);
+    }
+  }
+
+  for (int i = 0; i < m; ++i) {
+    const double expx2erfcxy = // avoid spurious overflow for large negative y
+      y[i] > -6 ? expx2[i]*erfcxy[i] : 2*exp(y[i]*y[i]-x[i]*x[i]);
+    double re, im;
+    if (y[i] > 5) { // imaginary terms cancel
+      const double sinxy = sin(x[i]*y[i]);
+      re = (expx2erfcxy - c*y[i]*sum1[i]) * cos(2*x[i]*y[i])
+        + (c*x[i]*expx2[i]) * sinxy * sinc(x[i]*y[i], sinxy);
+      im = 0;
+    }
+    else {
+      const double xs = xr[i];
+      const double sinxy = sin(xs*y[i]);
+      const double sin2xy = sin(2*xs*y[i]), cos2xy = cos(2*xs*y[i]);
+      const double coef1 = expx2erfcxy - c*y[i]*sum1[i];
+      const double coef2 = c*xs*expx2[i];
+      re = coef1 * cos2xy + coef2 * sinxy * sinc(xs*y[i], sinxy);
+      im = coef2 * sinc(2*xs*y[i], sin2xy) - coef1 * sin2xy;
+    }
+    out_re[i] = re + (0.5*c)*y[i]*(sum2[i]+sum3[i]);
+    out_im[i] = im + (0.5*c)*copysign(sum54[i], xr[i]);
+  }
+}
+
+void Faddeeva::w_batch(const double *re, const double *im,
+                       double *out_re, double *out_im, size_t n, double relerr)
+{
+  if (relerr > DBL_EPSILON) {
+    for (size_t i = 0; i < n; ++i) {
+      cmplx fw = FADDEEVA(w)(C(re[i], im[i]), relerr);
+      out_re[i] = creal(fw); out_im[i] = cimag(fw);
+    }
+    return;
+  }
+
+  std::vector<size_t> group[3];
+  for (size_t i = 0; i < n; ++i) group[w_batch_region(re[i], im[i])].push_back(i);
+
+  for (size_t i = 0; i < group[W_BATCH_SCALAR].size(); ++i) {
+    size_t ix = group[W_BATCH_SCALAR][i];
+    cmplx fw = FADDEEVA(w)(C(re[ix], im[ix]), 0);
+    out_re[ix] = creal(fw); out_im[ix] = cimag(fw);
+  }
+
+  for (int g = W_BATCH_CF; g <= W_BATCH_ALG916; ++g) {
+    const std::vector<size_t> &ix = group[g];
+    double xr[W_BATCH_BLOCK], y[W_BATCH_BLOCK], wr[W_BATCH_BLOCK], wi[W_BATCH_BLOCK];
+    for (size_t i0 = 0; i0 < ix.size(); i0 += W_BATCH_BLOCK) {
+      int m = ix.size() - i0 < W_BATCH_BLOCK ? int(ix.size() - i0) : W_BATCH_BLOCK;
+      for (int i = 0; i < m; ++i) { xr[i] = re[ix[i0+i]]; y[i] = im[ix[i0+i]]; }
+      if (g == W_BATCH_CF)
+        w_batch_cf(xr, y, wr, wi, m);
+      else
+        w_batch_alg916(xr, y, wr, wi, m);
+      for (int i = 0; i < m; ++i) { out_re[ix[i0+i]] = wr[i]; out_im[ix[i0+i]] = wi[i]; }
+    }
+  }
+}
+
+// Fortran interface to w_batch.
+
+extern "C" void faddeeva_w_batch(const double *x, const double *y, double *wx, double *wy,
+                                 size_t n, double errmax) {
+  Faddeeva::w_batch(x, y, wx, wy, n, errmax);
+}
+
+#endif // __cplusplus
+
+/////////////////////////////////////////////////////////////////////////
+// Table driven fast mode for w(z).  -- Added for Bmad.
+//
+// For tracking (e.g. the beam-beam kick) a relative error of ~1e-10 is
+// usually acceptable.  w_fast uses a table of Taylor series patches covering
+// 0 <= |x| < W_TABLE_XY_MAX, 0 <= y < W_TABLE_XY_MAX (the region where
+// beam-beam arguments live).  Outside of this region, and for any cell where
+// the requested accuracy could not be reached, FADDEEVA(w) is used.
+//
+// The table cells are W_TABLE_H on a side.  The Taylor coefficients about the
+// cell center are computed from samples of w on a circle of radius 2*W_TABLE_H
+// via a discrete Cauchy integral.  For each cell, the number of terms used is
+// the smallest number for which the error on a W_TABLE_CHECK^2 grid of points
+// spanning the cell (including the cell edges) is below relerr/2.  This is an
+// estimate, not a bound: the truncation error is smooth and largest at the cell
+// corners, which are on the check grid, and the factor 2 is a safety margin,
+// but points between the check points are not tested.  The TEST_FADDEEVA
+// program checks w_fast against w on a dense grid.
+//
+// Symmetry w(-x+iy) = conj(w(x+iy)) is used for x < 0.
+//
+// The table is built once per process (at the first w_fast call or by
+// w_table_build) and can be saved to/loaded from a binary file.
+//
+// w_fast may be called from several threads.  The table pointer is atomic and
+// a table that is replaced by w_table_build or w_table_load is not freed,
+// since w_fast calls in other threads may still be using it.  Tables are only
+// replaced by explicit setup calls, so the memory kept is small.
+
+#ifdef __cplusplus
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <atomic>
+#include <mutex>
+#ifdef _WIN32
+#  include <process.h>
+#  define W_TABLE_GETPID _getpid
+#else
+#  include <unistd.h>
+#  define W_TABLE_GETPID getpid
+#endif
+
+#define W_TABLE_H      0.25
+#define W_TABLE_XY_MAX 8.0
+#define W_TABLE_NCOEF  25   // Maximum number of Taylor terms
+#define W_TABLE_NSAMP  32   // Samples on the circle for the Cauchy integral
+#define W_TABLE_CHECK  6
+
+static const char w_table_magic[16] = "FADDEEVA_TABLE1";
+
+struct w_table_struct {
+  double relerr, h, xy_max;
+  int n_cell, n_coef;           // n_cell = number of cells along x and along y
+  std::vector<int> n_terms;     // per cell: number of terms used. 0 => use FADDEEVA(w)
+  std::vector<double> coef;     // per cell: n_coef (re, im) pairs
+};
+
+static w_table_struct *w_table_make(double relerr);
+
+static std::atomic<const w_table_struct *> w_table(0);
+static std::mutex w_table_mutex;                         // Serializes w_table_install
+static std::vector<const w_table_struct *> w_table_old;  // Replaced tables. See above.
+static std::once_flag w_table_once;
+
+static void w_table_install(const w_table_struct *t)
+{
+  std::lock_guard<std::mutex> lock(w_table_mutex);
+  const w_table_struct *old = w_table.exchange(t);
+  if (old) w_table_old.push_back(old);
+}
+
+// The table, built with the default relerr at the first call if there is none.
+
+static const w_table_struct *w_table_get()
+{
+  const w_table_struct *t = w_table.load(std::memory_order_acquire);
+  if (t) return t;
+  std::call_once(w_table_once, [] {
+    w_table_struct *made = w_table_make(1e-10);
+    std::lock_guard<std::mutex> lock(w_table_mutex);
+    const w_table_struct *none = 0;
+    if (!w_table.compare_exchange_strong(none, made)) delete made;  // w_table_build was faster
+  });
+  return w_table.load(std::memory_order_acquire);
+}
+
+static w_table_struct *w_table_make(double relerr)
+{
+  const double pi = 3.14159265358979323846264338327950288419716939937510582;
+  w_table_struct *t = new w_table_struct;
+  t->relerr = relerr;
+  t->h = W_TABLE_H;
+  t->xy_max = W_TABLE_XY_MAX;
+  t->n_cell = int(W_TABLE_XY_MAX / W_TABLE_H + 0.5);
+  t->n_coef = W_TABLE_NCOEF;
+  const int nc = t->n_cell, ncoef = t->n_coef;
+  t->n_terms.assign(nc*nc, 0);
+  t->coef.assign(2*ncoef*nc*nc, 0);
+
+  OMP_PRAGMA(omp parallel for schedule(dynamic))
+  for (int ic = 0; ic < nc*nc; ++ic) {
+    const int ix = ic % nc, iy = ic / nc;
+    const cmplx z0 = C((ix + 0.5) * t->h, (iy + 0.5) * t->h);
+    const double R = 2 * t->h;
+    cmplx samp[W_TABLE_NSAMP], cf[W_TABLE_NCOEF];
+
+    for (int j = 0; j < W_TABLE_NSAMP; ++j)
+      samp[j] = FADDEEVA(w)(z0 + cpolar(R, 2*pi*j/W_TABLE_NSAMP), 0.);
+
+    // c_k = (1/(N R^k)) Sum_j w(z0 + R e^(i theta_j)) e^(-i k theta_j)
+    for (int k = 0; k < ncoef; ++k) {
+      cmplx s = 0.;
+      for (int j = 0; j < W_TABLE_NSAMP; ++j)
+        s += samp[j] * cpolar(1., -2*pi*double(k*j % W_TABLE_NSAMP)/W_TABLE_NSAMP);
+      cf[k] = s / (double(W_TABLE_NSAMP) * pow(R, k));
+    }
+
+    // Find the number of terms needed for all check points
+
+    int n_need = 1;
+    for (int i = 0; i < W_TABLE_CHECK && n_need > 0; ++i) {
+      for (int j = 0; j < W_TABLE_CHECK && n_need > 0; ++j) {
+        const cmplx dz = C((double(i)/(W_TABLE_CHECK-1) - 0.5) * t->h,
+                           (double(j)/(W_TABLE_CHECK-1) - 0.5) * t->h);
+        const cmplx w_exact = FADDEEVA(w)(z0 + dz, 0.);
+        const double w_abs = abs(w_exact);
+        cmplx sum = 0., dzk = 1.;
+        int n_ok = 0;
+        for (int k = 0; k < ncoef; ++k) {
+          sum += cf[k] * dzk;
+          dzk *= dz;
+          if (abs(sum - w_exact) < 0.5 * relerr * w_abs) {
+            if (n_ok == 0) n_ok = k + 1;
+          }
+          else
+            n_ok = 0;
+        }
+        if (n_ok == 0) n_need = 0;                // accuracy not reached
+        else if (n_ok > n_need) n_need = n_ok;
+      }
+    }
+
+    t->n_terms[ic] = n_need;
+    for (int k = 0; k < ncoef; ++k) {
+      t->coef[2*(ic*ncoef + k)]   = creal(cf[k]);
+      t->coef[2*(ic*ncoef + k)+1] = cimag(cf[k]);
+    }
+  }
+
+  return t;
+}
+
+bool Faddeeva::w_table_build(double relerr)
+{
+  if (relerr <= 0) relerr = 1e-10;
+  if (relerr < 1e-14) return false; // Not attainable. Use w instead.
+  w_table_install(w_table_make(relerr));
+  return true;
+}
+
+double Faddeeva::w_table_relerr()
+{
+  const w_table_struct *t = w_table.load(std::memory_order_acquire);
+  return t ? t->relerr : 0;
+}
+
+// The table is written to a temporary file which is then renamed, so that a
+// process reading the file (w_table_load) never sees a partly written table.
+
+bool Faddeeva::w_table_save(const char *file)
+{
+  const w_table_struct *t = w_table_get();
+  const std::string tmp = std::string(file) + ".tmp" + std::to_string(long(W_TABLE_GETPID()));
+  FILE *f = fopen(tmp.c_str(), "wb");
+  if (!f) return false;
+  const size_t nc2 = size_t(t->n_cell) * t->n_cell;
+  bool ok = fwrite(w_table_magic, 1, 16, f) == 16 &&
+            fwrite(&t->relerr, sizeof(double), 1, f) == 1 &&
+            fwrite(&t->h, sizeof(double), 1, f) == 1 &&
+            fwrite(&t->xy_max, sizeof(double), 1, f) == 1 &&
+            fwrite(&t->n_cell, sizeof(int), 1, f) == 1 &&
+            fwrite(&t->n_coef, sizeof(int), 1, f) == 1 &&
+            fwrite(&t->n_terms[0], sizeof(int), nc2, f) == nc2 &&
+            fwrite(&t->coef[0], sizeof(double), t->coef.size(), f) == t->coef.size();
+  ok = (fclose(f) == 0) && ok;
+  if (ok) {
+    ok = std::rename(tmp.c_str(), file) == 0;
+    if (!ok && std::remove(file) == 0) ok = std::rename(tmp.c_str(), file) == 0;  // Windows
+  }
+  if (!ok) std::remove(tmp.c_str());
+  return ok;
+}
+
+// The file must have been written by w_table_save on a machine with the same
+// byte order.  If relerr > 0, the table in the file must have been built
+// with a relerr at least as small.
+
+bool Faddeeva::w_table_load(const char *file, double relerr)
+{
+  FILE *f = fopen(file, "rb");
+  if (!f) return false;
+  char magic[16];
+  w_table_struct *t = new w_table_struct;
+  bool ok = fread(magic, 1, 16, f) == 16 && memcmp(magic, w_table_magic, 16) == 0 &&
+            fread(&t->relerr, sizeof(double), 1, f) == 1 &&
+            fread(&t->h, sizeof(double), 1, f) == 1 &&
+            fread(&t->xy_max, sizeof(double), 1, f) == 1 &&
+            fread(&t->n_cell, sizeof(int), 1, f) == 1 &&
+            fread(&t->n_coef, sizeof(int), 1, f) == 1;
+  ok = ok && t->n_cell > 0 && t->n_cell < 100000 && t->n_coef > 0 && t->n_coef <= 100 &&
+       fabs(t->n_cell * t->h - t->xy_max) < 1e-12 * t->xy_max;
+  ok = ok && (relerr <= 0 || t->relerr <= relerr);
+  if (ok) {
+    const size_t nc2 = size_t(t->n_cell) * t->n_cell;
+    t->n_terms.resize(nc2);
+    t->coef.resize(2 * nc2 * t->n_coef);
+    ok = fread(&t->n_terms[0], sizeof(int), nc2, f) == nc2 &&
+         fread(&t->coef[0], sizeof(double), t->coef.size(), f) == t->coef.size();
+    for (size_t i = 0; ok && i < nc2; ++i)
+      ok = t->n_terms[i] >= 0 && t->n_terms[i] <= t->n_coef;
+  }
+  fclose(f);
+
+  if (!ok) {
+    delete t;
+    return false;
+  }
+  w_table_install(t);
+  return true;
+}
+
+cmplx Faddeeva::w_fast(cmplx z)
+{
+  const w_table_struct *t = w_table_get();
+
+  const double x = creal(z), y = cimag(z), xa = fabs(x);
+  if (!(y >= 0 && xa < t->xy_max && y < t->xy_max))  // Also catches NaN
+    return FADDEEVA(w)(z, t->relerr);
+
+  const int ix = int(xa / t->h), iy = int(y / t->h);
+  const int ic = iy * t->n_cell + ix;
+  const int n = t->n_terms[ic];
+  if (n == 0) return FADDEEVA(w)(z, t->relerr);
+
+  // Horner evaluation in real arithmetic
+  const double dx = xa - (ix + 0.5) * t->h, dy = y - (iy + 0.5) * t->h;
+  const double *c = &t->coef[2 * size_t(ic) * t->n_coef];
+  double sr = c[2*(n-1)], si = c[2*(n-1)+1];
+  for (int k = n - 2; k >= 0; --k) {
+    const double tr = sr*dx - si*dy + c[2*k];
+    si = sr*dy + si*dx + c[2*k+1];
+    sr = tr;
+  }
+  return x < 0 ? C(sr, -si) : C(sr, si);
+}
+
+// Fortran interface. faddeeva_function uses faddeeva_w_default which uses
+// the table if enabled by faddeeva_table_setup.
+
+static std::atomic<bool> w_table_use(false);
+
+extern "C" int faddeeva_table_setup_c(int enable, double relerr, const char *file) {
+  w_table_use = false;
+  if (!enable) return 1;
+  if (relerr <= 0) relerr = 1e-10;
+  if (file && file[0]) {
+    if (!Faddeeva::w_table_load(file, relerr)) {
+      if (!Faddeeva::w_table_build(relerr)) return 0;
+      if (!Faddeeva::w_table_save(file)) return 0;
+    }
+  }
+  else if (!Faddeeva::w_table_build(relerr))
+    return 0;
+  w_table_use = true;
+  return 1;
+}
+
+extern "C" int faddeeva_table_enabled_c() {
+  return w_table_use ? 1 : 0;
+}
+
+extern "C" void faddeeva_w_default(double x, double y, double *wx, double *wy) {
+  cmplx fw = w_table_use ? Faddeeva::w_fast(C(x, y)) : FADDEEVA(w)(C(x, y), 0.);
+  *wx = creal(fw); *wy = cimag(fw);
+}
+
+#endif // __cplusplus
+
 /////////////////////////////////////////////////////////////////////////
 
 // Compile with -DTEST_FADDEEVA to compile a little test program
@@ -1903,6 +2398,8 @@ extern "C" void faddeeva_w(double x, double y, double *wx, double *wy, double er
 
 #ifdef __cplusplus
 #  include <cstdio>
+#  include <ctime>
+#  include <vector>
 #else
 #  include <stdio.h>
 #endif
@@ -2519,6 +3016,83 @@ int main(void) {
     };
     TST(Dawson, 1e-20);
   }
+#ifdef __cplusplus
+  {
+    printf("########## w_batch(z) tests ##########\n");
+    // Compare w_batch against w on a grid covering all of the algorithm
+    // regions (including both signs of x and y) and time both.
+    const int NX = 400, NY = 400, NREP = 5;
+    const size_t N = size_t(NX) * NY;
+    std::vector<double> re(N), im(N), wr(N), wi(N), sr(N), si(N);
+    for (int i = 0; i < NX; ++i)
+      for (int j = 0; j < NY; ++j) {
+        size_t k = size_t(i) * NY + j;
+        re[k] = -30 + 60 * (i + 0.5) / NX;
+        im[k] = -8 + 38 * (j + 0.5) / NY;
+        if (im[k] < 0) im[k] = -fabs(im[k]) * 0.25; // avoid overflow of w for large -y
+      }
+    std::clock_t t0 = std::clock();
+    for (int r = 0; r < NREP; ++r)
+      for (size_t k = 0; k < N; ++k) {
+        cmplx fw = FADDEEVA(w)(C(re[k], im[k]), 0.);
+        sr[k] = creal(fw); si[k] = cimag(fw);
+      }
+    std::clock_t t1 = std::clock();
+    for (int r = 0; r < NREP; ++r)
+      FADDEEVA(w_batch)(&re[0], &im[0], &wr[0], &wi[0], N, 0.);
+    std::clock_t t2 = std::clock();
+    double errmax = 0;
+    for (size_t k = 0; k < N; ++k) {
+      double err = fabs(C(wr[k], wi[k]) - C(sr[k], si[k])) / fabs(C(sr[k], si[k]));
+      if (err > errmax) errmax = err;
+    }
+    double ts = double(t1 - t0) / CLOCKS_PER_SEC, tb = double(t2 - t1) / CLOCKS_PER_SEC;
+    printf("scalar: %g Mpoints/s, batch: %g Mpoints/s, speedup = %g\n",
+           1e-6 * N * NREP / ts, 1e-6 * N * NREP / tb, ts / tb);
+    if (errmax > 1e-13) {
+      printf("FAILURE -- w_batch relative error %g too large!\n", errmax);
+      return 1;
+    }
+    printf("SUCCESS (max relative error vs. w = %g)\n", errmax);
+    if (errmax > errmax_all) errmax_all = errmax;
+  }
+#endif
+#ifdef __cplusplus
+  {
+    printf("########## w_fast(z) tests ###########\n");
+    // Compare the table driven w_fast against w in the first quadrant region
+    // used by the beam-beam kick (plus x < 0 and points outside the table).
+    const double rel = 1e-10;
+    const int NX = 500, NY = 500, NREP = 5;
+    const size_t N = size_t(NX) * NY;
+    std::vector<cmplx> z(N), ws(N), wf(N);
+    for (int i = 0; i < NX; ++i)
+      for (int j = 0; j < NY; ++j)
+        z[size_t(i) * NY + j] = C(-9 + 18 * (i + 0.5) / NX, 9 * (j + 0.5) / NY);
+    std::clock_t t0 = std::clock();
+    FADDEEVA(w_table_build)(rel);
+    std::clock_t t1 = std::clock();
+    for (int r = 0; r < NREP; ++r)
+      for (size_t k = 0; k < N; ++k) ws[k] = FADDEEVA(w)(z[k], 0.);
+    std::clock_t t2 = std::clock();
+    for (int r = 0; r < NREP; ++r)
+      for (size_t k = 0; k < N; ++k) wf[k] = FADDEEVA(w_fast)(z[k]);
+    std::clock_t t3 = std::clock();
+    double errmax = 0;
+    for (size_t k = 0; k < N; ++k) {
+      double err = fabs(wf[k] - ws[k]) / fabs(ws[k]);
+      if (err > errmax) errmax = err;
+    }
+    double ts = double(t2 - t1) / CLOCKS_PER_SEC, tf = double(t3 - t2) / CLOCKS_PER_SEC;
+    printf("table build: %g s, w: %g Mpoints/s, w_fast: %g Mpoints/s, speedup = %g\n",
+           double(t1 - t0) / CLOCKS_PER_SEC, 1e-6 * N * NREP / ts, 1e-6 * N * NREP / tf, ts / tf);
+    if (errmax > rel) {
+      printf("FAILURE -- w_fast relative error %g larger than %g!\n", errmax, rel);
+      return 1;
+    }
+    printf("SUCCESS (max relative error vs. w = %g)\n", errmax);
+  }
+#endif
   printf("#####################################\n");
   printf("SUCCESS (max relative error = %g)\n", errmax_all);
 }
@@ -28,6 +28,7 @@
 #define FADDEEVA_HH 1
 
 #include <complex>
+#include <cstddef>
 
 namespace Faddeeva {
 
@@ -35,6 +36,19 @@ namespace Faddeeva {
 extern std::complex<double> w(std::complex<double> z,double relerr=0);
 extern double w_im(double x); // special-case code for Im[w(x)] of real x
 
+// compute w(z) for n points z = re[i] + i*im[i] (batched; same accuracy as w)
+extern void w_batch(const double *re, const double *im,
+                    double *out_re, double *out_im, size_t n, double relerr=0);
+
+// table driven approximation of w(z) with relative error estimated to be below
+// w_table_relerr() (default 1e-10).  The table is built at the first w_fast call
+// if needed.  w_fast is thread safe, also while a table is built or loaded.
+extern std::complex<double> w_fast(std::complex<double> z);
+extern bool w_table_build(double relerr=1e-10);
+extern bool w_table_save(const char *file);
+extern bool w_table_load(const char *file, double relerr=0);
+extern double w_table_relerr();
+
 // Various functions that we can compute with the help of w(z)
 
 // compute erfcx(z) = exp(z^2) erfc(z)
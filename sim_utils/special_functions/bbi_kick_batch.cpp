@@ -0,0 +1,158 @@
+//+
+// Normalized Bassetti-Erskine beam-beam kick for n points.
+//
+// This is the kick calc of bbi_kick.f90 for the C++ Beambeam_engine and gives the same results.
+// See bbi_kick.f90 for the normalization and the formulas for the actual kick.
+//
+// Points are done in chunks so that the Faddeeva evaluations for a chunk can be batched with
+// Faddeeva::w_batch. Round beam points do not need w(z).
+//-
+
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include "Faddeeva.hh"
+#include "bbi_kick_batch.h"
+
+using namespace std;
+
+extern "C" int faddeeva_table_enabled_c();
+
+void bbi_kick_batch(const double* x, const double* y, const double* sig_x, const double* sig_y, long n,
+                    double* nk_x, double* nk_y, double* dnk_xx, double* dnk_xy, double* dnk_yx, double* dnk_yy,
+                    bool use_w_table) {
+  const double pi = 3.14159265358979323846264338327950288419716939937510582;
+  const double sqrt1pi = 1 / sqrt(pi);
+  const double emax = 30;
+
+  const int chunk = 64;
+  double zr[2*chunk], zi[2*chunk], wr[2*chunk], wi[2*chunk];
+  double u[chunk], v[chunk], sx[chunk], sy[chunk], rr[chunk], sig0[chunk], sig1[chunk];
+  long ix[chunk];
+  bool flip[chunk];
+
+  for (long i0 = 0; i0 < n; i0 += chunk) {
+    long i1 = min(i0 + chunk, n);
+    int m = 0;
+
+    for (long i = i0; i < i1; i++) {
+      double r = sig_y[i] / sig_x[i];
+      double x_norm = x[i] / sig_x[i], y_norm = y[i] / sig_y[i];
+
+      // Round beam case
+
+      if (r > 0.999 && r < 1.001) {
+        // nk = -[x_norm, y_norm] * scale(amp). d_scale = d(scale)/d(amp).
+        double amp = (x_norm * x_norm + y_norm * y_norm) / 2;
+        double scale, d_scale;
+        if (amp > emax) {
+          scale = 4 * pi / amp;
+          d_scale = -scale / amp;
+        } else if (amp < 1e-4) {
+          scale = 4 * pi;
+          d_scale = -2 * pi;
+        } else {
+          double e = exp(-amp);
+          scale = 4 * pi * ((1 - e) / amp);
+          d_scale = (4 * pi * e - scale) / amp;
+        }
+        nk_x[i] = -x_norm * scale;
+        nk_y[i] = -y_norm * scale;
+        dnk_xx[i] = -(scale + x_norm * x_norm * d_scale) / sig_x[i];
+        dnk_xy[i] = -x_norm * y_norm * d_scale / sig_y[i];
+        dnk_yx[i] = -x_norm * y_norm * d_scale / sig_x[i];
+        dnk_yy[i] = -(scale + y_norm * y_norm * d_scale) / sig_y[i];
+        continue;
+      }
+
+      // Equations have been developed assuming r < 1. If not true, switch x and y.
+
+      flip[m] = (r > 1);
+      if (flip[m]) {
+        r = 1 / r;
+        swap(x_norm, y_norm);
+        sig0[m] = sig_y[i];  sig1[m] = sig_x[i];
+      } else {
+        sig0[m] = sig_x[i];  sig1[m] = sig_y[i];
+      }
+
+      double denom = 1 / sqrt(2 * (1 - r * r));
+      ix[m] = i;
+      rr[m] = r;
+      u[m] = fabs(x_norm) * denom;
+      v[m] = fabs(y_norm) * denom;
+      sx[m] = (x_norm > 0) - (x_norm < 0);
+      sy[m] = (y_norm > 0) - (y_norm < 0);
+      m++;
+    }
+
+    if (m == 0) continue;
+
+    //                        -(1-R^2)(U^2+V^2)
+    // F(U,V,R) = W(U+iRV) - E                  W(RU+iV)
+
+    for (int j = 0; j < m; j++) {
+      zr[j] = u[j];            zi[j] = rr[j] * v[j];   // w1 argument
+      zr[m+j] = rr[j] * u[j];  zi[m+j] = v[j];         // w2 argument
+    }
+
+    if (use_w_table) {
+      for (int j = 0; j < 2*m; j++) {
+        complex<double> w = Faddeeva::w_fast(complex<double>(zr[j], zi[j]));
+        wr[j] = w.real();  wi[j] = w.imag();
+      }
+    } else {
+      Faddeeva::w_batch(zr, zi, wr, wi, 2*m);
+    }
+
+    for (int j = 0; j < m; j++) {
+      long i = ix[j];
+      double r = rr[j];
+      double denom = 1 / sqrt(2 * (1 - r * r));
+      double scale = 4 * sqrt(pi * pi * pi) * denom * (1 + r);
+      double w1[2] = {wr[j], wi[j]}, w2[2] = {wr[m+j], wi[m+j]};
+      double expon = exp(-(1 - r * r) * (u[j] * u[j] + v[j] * v[j]));
+      double f1 = w1[0] - expon * w2[0], f2 = w1[1] - expon * w2[1];
+      double nk1 = -scale * sx[j] * f2, nk2 = -scale * sy[j] * f1;
+
+      // Faddeeva derivatives (see faddeeva_function.f90):
+      //   dwx/dx = dwy/dy = dw_11,  dwx/dy = -dwy/dx = dw_12.
+
+      double dw1_11 = 2 * (zi[j] * w1[1] - zr[j] * w1[0]);
+      double dw2_11 = 2 * (zi[m+j] * w2[1] - zr[m+j] * w2[0]);
+      double dw1_12 = -2 * (sqrt1pi - zr[j] * w1[1] - zi[j] * w1[0]);
+      double dw2_12 = -2 * (sqrt1pi - zr[m+j] * w2[1] - zi[m+j] * w2[0]);
+      double g = 2 * (1 - r * r) * expon;
+
+      double d11 = -dw1_12 / sig0[j]     + expon * dw2_12 * r / sig0[j] + g * w2[1] * u[j] / sig0[j];
+      double d12 =  dw1_11 * r / sig1[j] - expon * dw2_11 / sig1[j]     + g * w2[1] * v[j] / sig1[j];
+      double d21 =  dw1_11 / sig0[j]     - expon * dw2_11 * r / sig0[j] + g * w2[0] * u[j] / sig0[j];
+      double d22 =  dw1_12 * r / sig1[j] - expon * dw2_12 / sig1[j]     + g * w2[0] * v[j] / sig1[j];
+
+      double c = -scale * denom;
+      d11 *= c;
+      d12 *= c * sx[j] * sy[j];
+      d21 *= c * sx[j] * sy[j];
+      d22 *= c;
+
+      if (flip[j]) {
+        nk_x[i] = nk2;     nk_y[i] = nk1;
+        dnk_xx[i] = d22;   dnk_xy[i] = d21;
+        dnk_yx[i] = d12;   dnk_yy[i] = d11;
+      } else {
+        nk_x[i] = nk1;     nk_y[i] = nk2;
+        dnk_xx[i] = d11;   dnk_xy[i] = d12;
+        dnk_yx[i] = d21;   dnk_yy[i] = d22;
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+// Single point interface with the arguments of bbi_kick.f90, which the interface test compares it with.
+// dnk is the Fortran dnk(2,2) array. The Faddeeva table is used if enabled by faddeeva_table_setup.
+
+extern "C" void bbi_kick_c(double x, double y, const double* sigma, double* nk, double* dnk) {
+  bbi_kick_batch(&x, &y, &sigma[0], &sigma[1], 1, &nk[0], &nk[1], &dnk[0], &dnk[2], &dnk[1], &dnk[3],
+                 faddeeva_table_enabled_c() != 0);
+}
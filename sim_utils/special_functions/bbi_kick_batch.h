@@ -0,0 +1,17 @@
+//+
+// Normalized Bassetti-Erskine beam-beam kick for n points. See bbi_kick_batch.cpp.
+//-
+
+#ifndef BBI_KICK_BATCH
+
+#include <cstddef>
+
+// Each point has its own strong beam sigmas. dnk_xy = d(nk_x)/dy, etc.
+// If use_w_table is set, the Faddeeva function is evaluated with Faddeeva::w_fast.
+
+void bbi_kick_batch(const double* x, const double* y, const double* sig_x, const double* sig_y, long n,
+                    double* nk_x, double* nk_y, double* dnk_xx, double* dnk_xy, double* dnk_yx, double* dnk_yy,
+                    bool use_w_table = false);
+
+#define BBI_KICK_BATCH
+#endif
@@ -0,0 +1,41 @@
+!+
+! Subroutine faddeeva_batch(z_re, z_im, w_re, w_im)
+!
+! Routine to calculate the Faddeeva function w(z) for an array of points.
+! This is faster than calling faddeeva_function for each point.
+! See faddeeva_function for more details.
+!
+! Input:
+!   z_re(:)     -- real(rp): Real part of the z values.
+!   z_im(:)     -- real(rp): Imaginary part of the z values. Must be the same size as z_re.
+!
+! Output:
+!   w_re(:)     -- real(rp): Real part of w(z). Must be the same size as z_re.
+!   w_im(:)     -- real(rp): Imaginary part of w(z).
+!-
+
+subroutine faddeeva_batch(z_re, z_im, w_re, w_im)
+
+use precision_def
+use, intrinsic :: iso_c_binding
+
+implicit none
+
+real(rp), contiguous :: z_re(:), z_im(:), w_re(:), w_im(:)
+real(c_double) :: errmax = 0    ! Maximum error
+
+interface
+  subroutine faddeeva_w_batch(x, y, wx, wy, n, errmax) bind(c)
+    import
+    real(c_double) :: x(*), y(*), wx(*), wy(*)
+    integer(c_size_t), value :: n
+    real(c_double), value :: errmax
+  end subroutine
+end interface
+
+!
+
+if (size(z_re) == 0) return
+call faddeeva_w_batch(z_re, z_im, w_re, w_im, int(size(z_re), c_size_t), errmax)
+
+end subroutine
@@ -8,6 +8,9 @@
 !
 ! The faddeeva function is also called the "complex error function" in the literature.
 !
+! By default the exact algorithm is used. A faster table driven approximation can be
+! used instead by calling faddeeva_table_setup.
+!
 ! Input:
 !   z(2)        -- real(rp): z = (x,y) vector to evaluate the Faddeeva function at.
 !
@@ -26,13 +29,12 @@ implicit none
 
 real(rp) z(2), w(2), dw(2,2)
 real(rp) :: sqrt1pi = 1 / sqrt(pi)
-real(c_double) :: errmax = 0    ! Maximum error
 real(c_double) x, y, wx, wy
 
 interface
-  subroutine faddeeva_w(x, y, wx, wy, errmax) bind(c)
+  subroutine faddeeva_w_default(x, y, wx, wy) bind(c)
     import
-    real(c_double), value :: x, y, errmax
+    real(c_double), value :: x, y
     real(c_double) :: wx, wy
   end subroutine
 end interface
@@ -40,7 +42,7 @@ end interface
 !
 
 x = z(1); y = z(2)
-call faddeeva_w(x, y, wx, wy, errmax)
+call faddeeva_w_default(x, y, wx, wy)
 w = [wx, wy]
 
 dw(1,:) = [2.0_rp * (z(2)*w(2) - z(1)*w(1)), -2.0_rp * (sqrt1pi - z(1)*w(2) - z(2)*w(1))]
@@ -0,0 +1,64 @@
+!+
+! Subroutine faddeeva_table_setup (enable, relerr, file_name, err_flag)
+!
+! Routine to switch faddeeva_function (and hence bbi_kick, etc.) between the exact
+! Faddeeva algorithm and a fast table driven approximation.
+!
+! The table covers 0 <= |x| < 8, 0 <= y < 8 and the exact algorithm is used outside of this region.
+! The table is built once per process. If file_name is present, the table is read from this
+! file. If the file does not exist, or was made with a larger relerr, the table is built and
+! written to the file.
+!
+! Input:
+!   enable      -- logical: If True use the table. If False use the exact algorithm (default at startup).
+!   relerr      -- real(rp), optional: Relative error of the table. Default is 1e-10. This is checked
+!                    on a grid of points in each table cell, so it is an estimate rather than a bound.
+!                    Must be at least 1e-14.
+!   file_name   -- character(*), optional: Table file.
+!
+! Output:
+!   err_flag    -- logical, optional: Set True if there is a problem. In this case the exact algorithm is used.
+!-
+
+subroutine faddeeva_table_setup (enable, relerr, file_name, err_flag)
+
+use precision_def
+use, intrinsic :: iso_c_binding
+
+implicit none
+
+logical enable
+logical, optional :: err_flag
+real(rp), optional :: relerr
+real(c_double) rel
+integer(c_int) ok
+character(*), optional :: file_name
+character(len=:), allocatable :: fname
+
+interface
+  function faddeeva_table_setup_c(enable, relerr, file) result(ok) bind(c)
+    import
+    integer(c_int), value :: enable
+    real(c_double), value :: relerr
+    character(kind=c_char) :: file(*)
+    integer(c_int) ok
+  end function
+end interface
+
+!
+
+rel = 0
+if (present(relerr)) rel = relerr
+
+fname = c_null_char
+if (present(file_name)) fname = trim(file_name) // c_null_char
+
+if (enable) then
+  ok = faddeeva_table_setup_c(1_c_int, rel, fname)
+else
+  ok = faddeeva_table_setup_c(0_c_int, rel, fname)
+endif
+
+if (present(err_flag)) err_flag = (ok == 0)
+
+end subroutine
@@ -243,6 +243,27 @@ ENDIF ()
 SET (BASE_C_FLAGS "-Df2cFortran -O0 -std=gnu99 ${CESR_FLAGS} ${PLOT_LIBRARY_FLAG} -D_POSIX -D_REENTRANT -Wall -fPIC -Wno-trigraphs -Wno-unused ${MPI_COMPILE_FLAGS}")
 SET (BASE_CXX_FLAGS "-O0 -Wno-deprecated ${CESR_FLAGS} ${PLOT_LIBRARY_FLAG} -D_POSIX -D_REENTRANT -Wall -fPIC -Wno-trigraphs -Wno-unused ${MPI_COMPILE_FLAGS}")
 
+#-----------------------------------
+# OpenMP for C / C++. The C/C++ code
+# wraps its OpenMP directives in
+# OMP_PRAGMA macros that are empty
+# unless _OPENMP is defined.
+#-----------------------------------
+
+IF (${ACC_ENABLE_OPENMP})
+  FIND_PACKAGE (OpenMP)
+  IF (OpenMP_C_FOUND)
+    SET (BASE_C_FLAGS "${BASE_C_FLAGS} ${OpenMP_C_FLAGS}")
+  ELSE ()
+    MESSAGE ("WARNING: OpenMP not found for the C compiler. C code will be built without OpenMP.")
+  ENDIF ()
+  IF (OpenMP_CXX_FOUND)
+    SET (BASE_CXX_FLAGS "${BASE_CXX_FLAGS} ${OpenMP_CXX_FLAGS}")
+  ELSE ()
+    MESSAGE ("WARNING: OpenMP not found for the C++ compiler. C++ code will be built without OpenMP.")
+  ENDIF ()
+ENDIF ()
+
 #-----------------------------------                                                                                
 # For non-Linux or non-ifort or 
 # non-64-bit builds, do not use
@@ -439,6 +460,7 @@ IF ($ENV{ACC_ENABLE_OPENMP})
     message("OpenMP gfortran Flag : -fopenmp")
     message("OpenMP Linker Libs   : ${OPENMP_LINK_LIBS}")
   ENDIF()
+  message("OpenMP C/C++ Flags   : ${OpenMP_C_FLAGS} / ${OpenMP_CXX_FLAGS}")
 ELSE ()
   message("OpenMP Support       : Not Enabled")
 ENDIF ()